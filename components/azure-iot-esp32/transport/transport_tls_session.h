@@ -0,0 +1,94 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file transport_tls_session.h
+ * @brief TLS session cache used to resume sessions across reconnects and deep sleep.
+ */
+
+#ifndef TRANSPORT_TLS_SESSION_H
+#define TRANSPORT_TLS_SESSION_H
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "mbedtls/ssl.h"
+
+/**
+ * @brief Number of hosts a session is kept for (DPS and IoT Hub).
+ */
+#ifndef TLS_SESSION_CACHE_SLOTS
+    #define TLS_SESSION_CACHE_SLOTS       ( 2 )
+#endif
+
+/**
+ * @brief Maximum size of a serialized session, including the ticket.
+ */
+#ifndef TLS_SESSION_CACHE_SLOT_SIZE
+    #define TLS_SESSION_CACHE_SLOT_SIZE   ( 1024 )
+#endif
+
+/**
+ * @brief Session cache counters. They survive deep sleep together with the cache.
+ */
+typedef struct TlsSessionCacheStats
+{
+    uint32_t ulHits;        /**< @brief Handshakes abbreviated with a cached session. */
+    uint32_t ulMisses;      /**< @brief Full handshakes, with or without a session offered. */
+    uint32_t ulStoreFails;  /**< @brief Sessions that could not be serialized into a slot. */
+} TlsSessionCacheStats_t;
+
+/**
+ * @brief Load the cached session for a host.
+ *
+ * @param[in] pcHostName Host the session was established with.
+ * @param[out] pxSession Initialized session to deserialize into.
+ *
+ * @return 0 when a session was loaded; otherwise, no session is available.
+ */
+int32_t TLS_Session_Load( const char * pcHostName,
+                          mbedtls_ssl_session * pxSession );
+
+/**
+ * @brief Save the session of an established connection.
+ *
+ * Called after a TLS 1.2 handshake and whenever a TLS 1.3 connection receives a ticket.
+ *
+ * @param[in] pcHostName Host the connection was established with.
+ * @param[in] pxSslContext Context with a session to export.
+ */
+void TLS_Session_Store( const char * pcHostName,
+                        const mbedtls_ssl_context * pxSslContext );
+
+/**
+ * @brief Run the handshake, account for a hit or miss and cache the resulting session.
+ *
+ * Only a handshake that skipped the server certificate counts as a hit. A failed handshake
+ * with an offered session drops it.
+ *
+ * @param[in] pcHostName Host being connected to.
+ * @param[in] pxSslContext Context set up for the handshake.
+ * @param[in] xSessionOffered Whether a cached session was set on the context.
+ *
+ * @return 0 on success; otherwise, the mbedTLS error of the handshake.
+ */
+int32_t TLS_Session_Handshake( const char * pcHostName,
+                               mbedtls_ssl_context * pxSslContext,
+                               BaseType_t xSessionOffered );
+
+/**
+ * @brief Drop the cached session for a host, e.g. after a failed resumption.
+ *
+ * @param[in] pcHostName Host to drop the session for.
+ */
+void TLS_Session_Invalidate( const char * pcHostName );
+
+/**
+ * @brief Get a copy of the session cache counters.
+ *
+ * @param[out] pxStats Counters.
+ */
+void TLS_Session_GetStats( TlsSessionCacheStats_t * pxStats );
+
+#endif /* TRANSPORT_TLS_SESSION_H */
@@ -32,7 +32,7 @@ typedef struct NetworkCredentials
      */
     BaseType_t xDisableSni;
 
-    const uint8_t * pucRootCa;     /**< @brief String representing a trusted server root certificate. */
+    const uint8_t * pucRootCa;     /**< @brief String representing a trusted server root certificate, NULL to use the chain from #TLS_Socket_LoadRootCaChain. */
     size_t xRootCaSize;            /**< @brief Size associated with #NetworkCredentials.pRootCa. */
     const uint8_t * pucClientCert; /**< @brief String representing the client certificate. */
     size_t xClientCertSize;        /**< @brief Size associated with #NetworkCredentials.pClientCert. */
@@ -55,6 +55,22 @@ typedef enum TlsTransportStatus
     eTLSTransportCAVerifyFailed      /**< Verification of TLS CA cert failed. */
 } TlsTransportStatus_t;
 
+/**
+ * @brief Parse DER encoded root CA certificates once into the chain shared by all connections.
+ *
+ * Connections whose credentials leave pucRootCa NULL verify the server against this chain.
+ * The certificates are referenced in place, so they must stay valid for the lifetime of the
+ * program. The chain is immutable once loaded; loading it again is a no-op.
+ *
+ * @param ppucCerts DER encoded certificates.
+ * @param pxCertSizes Size of each certificate.
+ * @param xCertCount Number of certificates.
+ * @return #eTLSTransportSuccess, #eTLSTransportInsufficientMemory or #eTLSTransportInvalidCredentials.
+ */
+TlsTransportStatus_t TLS_Socket_LoadRootCaChain( const uint8_t * const * ppucCerts,
+                                                 const size_t * pxCertSizes,
+                                                 size_t xCertCount );
+
 /**
  * @brief Connect to TLS endpoint
  *
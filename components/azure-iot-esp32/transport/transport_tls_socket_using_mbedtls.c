@@ -43,6 +43,7 @@ extern void vLoggingPrintf( const char * pcFormatString,
 
 /* TLS transport header. */
 #include "transport_tls_socket.h"
+#include "transport_tls_session.h"
 
 /* FreeRTOS Socket wrapper include. */
 #include "sockets_wrapper.h"
@@ -79,10 +80,21 @@ typedef struct MbedSSLContext
     mbedtls_pk_context privKey;              /**< @brief Client private key context. */
     mbedtls_entropy_context entropyContext;  /**< @brief Entropy context for random number generation. */
     mbedtls_ctr_drbg_context ctrDrgbContext; /**< @brief CTR DRBG context for random number generation. */
+    char cHostName[ 254 ];                   /**< @brief Session cache key for TLS 1.3 tickets received after the handshake. */
 } MbedSSLContext_t;
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Root CA chain shared by every connection, see #TLS_Socket_LoadRootCaChain.
+ */
+static mbedtls_x509_crt xSharedRootCa;
+
+/**
+ * @brief Set once #xSharedRootCa holds the parsed chain.
+ */
+static BaseType_t xSharedRootCaLoaded = pdFALSE;
+
 /**
  * @brief Represents string to be logged when mbedTLS returned error
  * does not contain a high-level code.
@@ -215,12 +227,16 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pxNetworkContext,
 /**
  * @brief Perform the TLS handshake on a TCP connection.
  *
+ * A session cached for the host is offered first, so the handshake can be abbreviated.
+ *
  * @param[in] pxNetworkContext Network context.
+ * @param[in] pcHostName Remote host name, used to look up a cached session.
  * @param[in] pxNetworkCredentials TLS setup parameters.
  *
  * @return #eTLSTransportSuccess, #eTLSTransportHandshakeFailed, or #eTLSTransportInternalError.
  */
 static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pxNetworkContext,
+                                          const char * pcHostName,
                                           const NetworkCredentials_t * pxNetworkCredentials );
 
 /**
@@ -365,9 +381,26 @@ static int32_t setCredentials( MbedSSLContext_t * pxSslContext,
     mbedtls_ssl_conf_cert_profile( &( pxSslContext->config ),
                                    &( pxSslContext->certProfile ) );
 
-    lMbedtlsError = setRootCa( pxSslContext,
-                               pxNetworkCredentials->pucRootCa,
-                               pxNetworkCredentials->xRootCaSize );
+    #if defined( MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED )
+        /* Have TLS_Socket_Recv() see TLS 1.3 tickets instead of mbed TLS dropping them. */
+        mbedtls_ssl_conf_tls13_enable_signal_new_session_tickets( &( pxSslContext->config ),
+                                                                  MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED );
+    #endif
+
+    if( pxNetworkCredentials->pucRootCa != NULL )
+    {
+        lMbedtlsError = setRootCa( pxSslContext,
+                                   pxNetworkCredentials->pucRootCa,
+                                   pxNetworkCredentials->xRootCaSize );
+    }
+    else
+    {
+        /* The shared chain is never modified after loading, so it is safe to reference from every config. */
+        mbedtls_ssl_conf_ca_chain( &( pxSslContext->config ),
+                                   &xSharedRootCa,
+                                   NULL );
+        lMbedtlsError = 0;
+    }
 
     if( ( pxNetworkCredentials->pucClientCert != NULL ) &&
         ( pxNetworkCredentials->pucPrivateKey != NULL ) )
@@ -470,7 +503,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pxNetworkContext,
     configASSERT( pxNetworkContext->pParams != NULL );
     configASSERT( pcHostName != NULL );
     configASSERT( pxNetworkCredentials != NULL );
-    configASSERT( pxNetworkCredentials->pucRootCa != NULL );
+    configASSERT( ( pxNetworkCredentials->pucRootCa != NULL ) || ( xSharedRootCaLoaded == pdTRUE ) );
 
     pxTlsTransportParams = ( TlsTransportParams_t * ) pxNetworkContext->pParams;
     configASSERT( pxTlsTransportParams->xSSLContext != NULL );
@@ -518,12 +551,15 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pxNetworkContext,
 /*-----------------------------------------------------------*/
 
 static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pxNetworkContext,
+                                          const char * pcHostName,
                                           const NetworkCredentials_t * pxNetworkCredentials )
 {
     TlsTransportParams_t * pxTlsTransportParams = NULL;
     TlsTransportStatus_t xRetVal = eTLSTransportSuccess;
     int32_t lMbedtlsError = 0;
     MbedSSLContext_t * pxSSLContext = NULL;
+    mbedtls_ssl_session xCachedSession;
+    BaseType_t xSessionOffered = pdFALSE;
 
     configASSERT( pxNetworkContext != NULL );
     configASSERT( pxNetworkContext->pParams != NULL );
@@ -562,14 +598,23 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pxNetworkContext,
                              NULL );
     }
 
+    mbedtls_ssl_session_init( &xCachedSession );
+
+    if( ( xRetVal == eTLSTransportSuccess ) &&
+        ( TLS_Session_Load( pcHostName, &xCachedSession ) == 0 ) )
+    {
+        /* Offer the cached session; the server falls back to a full handshake if it declines. */
+        xSessionOffered = ( mbedtls_ssl_set_session( &( pxSSLContext->context ), &xCachedSession ) == 0 ) ? pdTRUE : pdFALSE;
+    }
+
     if( xRetVal == eTLSTransportSuccess )
     {
-        /* Perform the TLS handshake. */
-        do
-        {
-            lMbedtlsError = mbedtls_ssl_handshake( &( pxSSLContext->context ) );
-        } while( ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
-                 ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) );
+        /* A DNS name is at most 253 characters, Sockets_Connect() already resolved this one. */
+        ( void ) strncpy( pxSSLContext->cHostName, pcHostName, sizeof( pxSSLContext->cHostName ) - 1U );
+        pxSSLContext->cHostName[ sizeof( pxSSLContext->cHostName ) - 1U ] = '\0';
+
+        /* Perform the TLS handshake, the session cache tells a resumption from a full handshake. */
+        lMbedtlsError = TLS_Session_Handshake( pcHostName, &( pxSSLContext->context ), xSessionOffered );
 
         if( lMbedtlsError != 0 )
         {
@@ -593,6 +638,8 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pxNetworkContext,
         }
     }
 
+    mbedtls_ssl_session_free( &xCachedSession );
+
     return xRetVal;
 }
 /*-----------------------------------------------------------*/
@@ -655,6 +702,54 @@ static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pxEntropyCont
 }
 /*-----------------------------------------------------------*/
 
+TlsTransportStatus_t TLS_Socket_LoadRootCaChain( const uint8_t * const * ppucCerts,
+                                                 const size_t * pxCertSizes,
+                                                 size_t xCertCount )
+{
+    TlsTransportStatus_t xRetVal = eTLSTransportSuccess;
+    int32_t lMbedtlsError = 0;
+
+    if( xSharedRootCaLoaded == pdTRUE )
+    {
+        return eTLSTransportSuccess;
+    }
+
+    if( ( ppucCerts == NULL ) || ( pxCertSizes == NULL ) || ( xCertCount == 0 ) )
+    {
+        return eTLSTransportInvalidParameter;
+    }
+
+    mbedtls_x509_crt_init( &xSharedRootCa );
+
+    for( size_t i = 0; ( i < xCertCount ) && ( xRetVal == eTLSTransportSuccess ); i++ )
+    {
+        /* Reference the DER data in place, it is expected to be in read-only storage. */
+        lMbedtlsError = mbedtls_x509_crt_parse_der_nocopy( &xSharedRootCa,
+                                                           ppucCerts[ i ],
+                                                           pxCertSizes[ i ] );
+
+        if( lMbedtlsError != 0 )
+        {
+            LogError( ( "Failed to parse root CA certificate %u: lMbedtlsError[%d]= %s : %s.",
+                        ( unsigned ) i, lMbedtlsError, mbedtlsHighLevelCodeOrDefault( lMbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( lMbedtlsError ) ) );
+            xRetVal = eTLSTransportInvalidCredentials;
+        }
+    }
+
+    if( xRetVal == eTLSTransportSuccess )
+    {
+        xSharedRootCaLoaded = pdTRUE;
+    }
+    else
+    {
+        mbedtls_x509_crt_free( &xSharedRootCa );
+    }
+
+    return xRetVal;
+}
+/*-----------------------------------------------------------*/
+
 TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pxNetworkContext,
                                          const char * pcHostName,
                                          uint16_t usPort,
@@ -681,9 +776,9 @@ TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pxNetworkContext,
                     pxNetworkCredentials ) );
         xRetVal = eTLSTransportInvalidParameter;
     }
-    else if( ( pxNetworkCredentials->pucRootCa == NULL ) )
+    else if( ( pxNetworkCredentials->pucRootCa == NULL ) && ( xSharedRootCaLoaded == pdFALSE ) )
     {
-        LogError( ( "pucRootCa cannot be NULL." ) );
+        LogError( ( "pucRootCa cannot be NULL without a shared root CA chain." ) );
         xRetVal = eTLSTransportInvalidParameter;
     }
     else if( ( pxSSLContext = pvPortMalloc( sizeof( MbedSSLContext_t ) ) ) == NULL )
@@ -736,7 +831,7 @@ TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pxNetworkContext,
         {
             LogError( ( "Failed to setup Mbedtls %d.", xRetVal ) );
         }
-        else if( ( xRetVal = tlsHandshake( pxNetworkContext, pxNetworkCredentials ) ) != eTLSTransportSuccess )
+        else if( ( xRetVal = tlsHandshake( pxNetworkContext, pcHostName, pxNetworkCredentials ) ) != eTLSTransportSuccess )
         {
             LogError( ( "Failed to do TLS handshake %d.", xRetVal ) );
         }
@@ -861,9 +956,15 @@ int32_t TLS_Socket_Recv( NetworkContext_t * pxNetworkContext,
                                                   pvBuffer,
                                                   xBytesToRecv );
 
-    if( ( lMbedtlsError == MBEDTLS_ERR_SSL_TIMEOUT ) ||
-        ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
-        ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) )
+    if( lMbedtlsError == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET )
+    {
+        /* A TLS 1.3 ticket, keep it to resume the next connection. */
+        TLS_Session_Store( pxSSLContext->cHostName, &( pxSSLContext->context ) );
+        lMbedtlsError = 0;
+    }
+    else if( ( lMbedtlsError == MBEDTLS_ERR_SSL_TIMEOUT ) ||
+             ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
+             ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) )
     {
         LogDebug( ( "Failed to read data. However, a read can be retried on this error. "
                     "mbedTLSError[%d]= %s : %s.", lMbedtlsError,
@@ -27,20 +27,31 @@
 
 /* Standard includes. */
 #include "errno.h"
+#include <string.h>
 
 /* FreeRTOS includes. */
 #include "freertos/FreeRTOS.h"
 
 /* TLS transport header. */
 #include "transport_tls_socket.h"
+#include "transport_tls_session.h"
 
 #include "esp_log.h"
 
 /* TLS includes. */
-#include "esp_transport_ssl.h"
+#include "esp_random.h"
+#include "esp_tls.h"
+#include "lwip/sockets.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+#include "psa/crypto.h"
 
 static const char *TAG = "tls_freertos";
 
+/* Longest DNS name. */
+#define TLS_HOST_NAME_MAX_LEN    ( 253 )
 
 /**
  * @brief Definition of the network context for the transport interface
@@ -48,12 +59,25 @@ static const char *TAG = "tls_freertos";
  */
 typedef struct EspTlsTransportParams
 {
-    esp_transport_handle_t xTransport;
-    esp_transport_list_handle_t xTransportList;
+    /* esp-tls only opens the TCP connection, the TLS session runs on a context owned here
+     * so a cached session can be offered through the public mbedTLS API. */
+    mbedtls_net_context xNet;
+    mbedtls_ssl_context xSsl;
+    mbedtls_ssl_config xSslConfig;
+    mbedtls_x509_crt xClientCert;
+    mbedtls_pk_context xClientKey;
     uint32_t ulReceiveTimeoutMs;
     uint32_t ulSendTimeoutMs;
+    BaseType_t xOwnsCaStore;
+    /* Session cache key for the tickets a TLS 1.3 server sends after the handshake. */
+    char cHostName[ TLS_HOST_NAME_MAX_LEN + 1 ];
 } EspTlsTransportParams_t;
 
+/**
+ * @brief Set once the shared root CA chain lives in the esp-tls global CA store.
+ */
+static BaseType_t xRootCaChainLoaded = pdFALSE;
+
 /* Each transport defines the same NetworkContext. The user then passes their respective transport */
 /* as pParams for the transport which is defined in the transport header file */
 /* (here it's TlsTransportParams_t) */
@@ -65,6 +89,174 @@ struct NetworkContext
 
 /*-----------------------------------------------------------*/
 
+static int prvRandom( void * pvCtx,
+                      unsigned char * pucBuf,
+                      size_t xLen )
+{
+    ( void ) pvCtx;
+
+    /* The hardware RNG is a true RNG while the radio is up, which it is during any handshake. */
+    esp_fill_random( pucBuf, xLen );
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitContexts( EspTlsTransportParams_t * pxEspTlsTransport )
+{
+    mbedtls_net_init( &pxEspTlsTransport->xNet );
+    mbedtls_ssl_init( &pxEspTlsTransport->xSsl );
+    mbedtls_ssl_config_init( &pxEspTlsTransport->xSslConfig );
+    mbedtls_x509_crt_init( &pxEspTlsTransport->xClientCert );
+    mbedtls_pk_init( &pxEspTlsTransport->xClientKey );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeContexts( EspTlsTransportParams_t * pxEspTlsTransport )
+{
+    /* Closes the socket as well. */
+    mbedtls_net_free( &pxEspTlsTransport->xNet );
+    mbedtls_ssl_free( &pxEspTlsTransport->xSsl );
+    mbedtls_ssl_config_free( &pxEspTlsTransport->xSslConfig );
+    mbedtls_x509_crt_free( &pxEspTlsTransport->xClientCert );
+    mbedtls_pk_free( &pxEspTlsTransport->xClientKey );
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t prvSetupSsl( EspTlsTransportParams_t * pxEspTlsTransport,
+                                         const char * pHostName,
+                                         const NetworkCredentials_t * pNetworkCredentials )
+{
+    mbedtls_ssl_config * pxConfig = &pxEspTlsTransport->xSslConfig;
+    int lMbedtlsError;
+
+#if CONFIG_MBEDTLS_SSL_PROTO_TLS1_3
+    /* TLS 1.3 in mbedTLS runs on PSA, which esp-tls would otherwise have initialized. Repeat calls are no-ops. */
+    if ( psa_crypto_init( ) != PSA_SUCCESS )
+    {
+        return eTLSTransportInternalError;
+    }
+#endif
+
+    if ( mbedtls_ssl_config_defaults( pxConfig, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT ) != 0 )
+    {
+        return eTLSTransportInternalError;
+    }
+
+    mbedtls_ssl_conf_authmode( pxConfig, MBEDTLS_SSL_VERIFY_REQUIRED );
+    mbedtls_ssl_conf_ca_chain( pxConfig, esp_tls_get_global_ca_store( ), NULL );
+    mbedtls_ssl_conf_rng( pxConfig, prvRandom, NULL );
+    mbedtls_ssl_conf_read_timeout( pxConfig, pxEspTlsTransport->ulReceiveTimeoutMs );
+
+#if CONFIG_MBEDTLS_CLIENT_SSL_SESSION_TICKETS
+    mbedtls_ssl_conf_session_tickets( pxConfig, MBEDTLS_SSL_SESSION_TICKETS_ENABLED );
+    #if defined( MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED )
+        /* Newer mbedTLS drops TLS 1.3 tickets silently unless asked to report them from mbedtls_ssl_read(). */
+        mbedtls_ssl_conf_tls13_enable_signal_new_session_tickets( pxConfig, MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED );
+    #endif
+#endif
+
+    if ( ( pNetworkCredentials->ppcAlpnProtos != NULL ) &&
+         ( mbedtls_ssl_conf_alpn_protocols( pxConfig, pNetworkCredentials->ppcAlpnProtos ) != 0 ) )
+    {
+        return eTLSTransportInvalidParameter;
+    }
+
+    if ( ( pNetworkCredentials->pucClientCert != NULL ) && ( pNetworkCredentials->pucPrivateKey != NULL ) )
+    {
+        lMbedtlsError = mbedtls_x509_crt_parse( &pxEspTlsTransport->xClientCert,
+                                                pNetworkCredentials->pucClientCert, pNetworkCredentials->xClientCertSize );
+
+        if ( lMbedtlsError == 0 )
+        {
+            lMbedtlsError = mbedtls_pk_parse_key( &pxEspTlsTransport->xClientKey,
+                                                  pNetworkCredentials->pucPrivateKey, pNetworkCredentials->xPrivateKeySize,
+                                                  NULL, 0, prvRandom, NULL );
+        }
+
+        if ( lMbedtlsError == 0 )
+        {
+            lMbedtlsError = mbedtls_ssl_conf_own_cert( pxConfig, &pxEspTlsTransport->xClientCert, &pxEspTlsTransport->xClientKey );
+        }
+
+        if ( lMbedtlsError != 0 )
+        {
+            ESP_LOGE( TAG, "Failed to load the client credentials: -0x%04x", ( unsigned ) -lMbedtlsError );
+            return eTLSTransportInvalidCredentials;
+        }
+    }
+
+    if ( mbedtls_ssl_setup( &pxEspTlsTransport->xSsl, pxConfig ) != 0 )
+    {
+        return eTLSTransportInsufficientMemory;
+    }
+
+    /* NULL opts out of the host name check explicitly, like esp-tls skip_common_name. */
+    if ( mbedtls_ssl_set_hostname( &pxEspTlsTransport->xSsl, pNetworkCredentials->xDisableSni ? NULL : pHostName ) != 0 )
+    {
+        return eTLSTransportInternalError;
+    }
+
+    mbedtls_ssl_set_bio( &pxEspTlsTransport->xSsl, &pxEspTlsTransport->xNet, mbedtls_net_send, NULL, mbedtls_net_recv_timeout );
+
+    return eTLSTransportSuccess;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseCaStore( EspTlsTransportParams_t * pxEspTlsTransport )
+{
+    /* The shared chain outlives connections, only a per-connection PEM store is released. */
+    if ( pxEspTlsTransport->xOwnsCaStore )
+    {
+        esp_tls_free_global_ca_store( );
+        pxEspTlsTransport->xOwnsCaStore = pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_Socket_LoadRootCaChain( const uint8_t * const * ppucCerts,
+                                                 const size_t * pxCertSizes,
+                                                 size_t xCertCount )
+{
+    mbedtls_x509_crt * pxChain;
+    int lMbedtlsError;
+
+    if ( xRootCaChainLoaded )
+    {
+        return eTLSTransportSuccess;
+    }
+
+    if ( ( ppucCerts == NULL ) || ( pxCertSizes == NULL ) || ( xCertCount == 0 ) )
+    {
+        return eTLSTransportInvalidParameter;
+    }
+
+    if ( ( esp_tls_init_global_ca_store( ) != ESP_OK ) ||
+         ( ( pxChain = esp_tls_get_global_ca_store( ) ) == NULL ) )
+    {
+        ESP_LOGE( TAG, "Failed to allocate CA store" );
+        return eTLSTransportInsufficientMemory;
+    }
+
+    for ( size_t i = 0; i < xCertCount; i++ )
+    {
+        /* The certificates are in flash, reference them instead of copying to the heap. */
+        lMbedtlsError = mbedtls_x509_crt_parse_der_nocopy( pxChain, ppucCerts[ i ], pxCertSizes[ i ] );
+
+        if ( lMbedtlsError != 0 )
+        {
+            ESP_LOGE( TAG, "Failed to parse root CA %u: -0x%04x", ( unsigned ) i, ( unsigned ) -lMbedtlsError );
+            esp_tls_free_global_ca_store( );
+            return eTLSTransportInvalidCredentials;
+        }
+    }
+
+    ESP_LOGI( TAG, "Root CA chain loaded: %u certificates", ( unsigned ) xCertCount );
+    xRootCaChainLoaded = pdTRUE;
+
+    return eTLSTransportSuccess;
+}
+/*-----------------------------------------------------------*/
+
 TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pNetworkContext,
                                          const char * pHostName,
                                          uint16_t usPort,
@@ -73,6 +265,11 @@ TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pNetworkContext,
                                          uint32_t ulSendTimeoutMs )
 {
     TlsTransportStatus_t xReturnStatus = eTLSTransportSuccess;
+    esp_tls_cfg_t xTcpConfig = { 0 };
+    esp_tls_last_error_t xTcpError = { 0 };
+    mbedtls_ssl_session xCachedSession;
+    BaseType_t xSessionOffered = pdFALSE;
+    int lMbedtlsError;
 
     if( ( pNetworkContext == NULL ) ||
         ( pHostName == NULL ) ||
@@ -94,11 +291,28 @@ TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pNetworkContext,
         return eTLSTransportInvalidParameter;
     }
 
+    if ( strlen( pHostName ) > TLS_HOST_NAME_MAX_LEN )
+    {
+        ESP_LOGE( TAG, "Host name too long: %s", pHostName );
+        return eTLSTransportInvalidParameter;
+    }
+
+    /* Both trust sources live in the single esp-tls global CA store, only one can be used. */
+    if ( ( pNetworkCredentials->pucRootCa != NULL ) == ( xRootCaChainLoaded == pdTRUE ) )
+    {
+        ESP_LOGE( TAG, "Set either pucRootCa or the shared root CA chain, pucRootCa=%p, shared chain=%d.",
+                  pNetworkCredentials->pucRootCa, ( int ) xRootCaChainLoaded );
+        return eTLSTransportInvalidCredentials;
+    }
+
     EspTlsTransportParams_t * pxEspTlsTransport;
 
     if ( pxTlsParams->xSSLContext != NULL )
     {
+        /* Reconnecting on a context that was not disconnected, drop the stale connection. */
         pxEspTlsTransport = pxTlsParams->xSSLContext;
+        prvFreeContexts( pxEspTlsTransport );
+        prvReleaseCaStore( pxEspTlsTransport );
     }
     else
     {
@@ -109,67 +323,73 @@ TlsTransportStatus_t TLS_Socket_Connect( NetworkContext_t * pNetworkContext,
             return eTLSTransportInsufficientMemory;
         }
 
-        // Create a transport list into which we put the transport.
-        pxEspTlsTransport->xTransportList = esp_transport_list_init();
-        pxEspTlsTransport->xTransport = esp_transport_ssl_init( );
-        pxEspTlsTransport->ulReceiveTimeoutMs = ulReceiveTimeoutMs;
-        pxEspTlsTransport->ulSendTimeoutMs = ulSendTimeoutMs;
+        pxEspTlsTransport->xOwnsCaStore = pdFALSE;
+        pxTlsParams->xSSLContext = (void*)pxEspTlsTransport;
+    }
 
-        esp_transport_ssl_enable_global_ca_store(pxEspTlsTransport->xTransport);
+    prvInitContexts( pxEspTlsTransport );
+    pxEspTlsTransport->ulReceiveTimeoutMs = ulReceiveTimeoutMs;
+    pxEspTlsTransport->ulSendTimeoutMs = ulSendTimeoutMs;
+    strcpy( pxEspTlsTransport->cHostName, pHostName );
 
-        esp_transport_list_add(pxEspTlsTransport->xTransportList, pxEspTlsTransport->xTransport, "_ssl");
+    if ( pNetworkCredentials->pucRootCa )
+    {
+        ESP_LOGI( TAG, "Setting CA store");
+        esp_tls_set_global_ca_store( ( const unsigned char * ) pNetworkCredentials->pucRootCa, pNetworkCredentials->xRootCaSize );
+        pxEspTlsTransport->xOwnsCaStore = pdTRUE;
+    }
 
-        pxTlsParams->xSSLContext = (void*)pxEspTlsTransport;
+    xReturnStatus = prvSetupSsl( pxEspTlsTransport, pHostName, pNetworkCredentials );
 
-        if ( pNetworkCredentials->ppcAlpnProtos )
-        {
-            esp_transport_ssl_set_alpn_protocol( pxEspTlsTransport->xTransport, pNetworkCredentials->ppcAlpnProtos );
-        }
+    mbedtls_ssl_session_init( &xCachedSession );
 
-        if ( pNetworkCredentials->xDisableSni )
-        {
-            esp_transport_ssl_skip_common_name_check( pxEspTlsTransport->xTransport );
-        }
+    if ( ( xReturnStatus == eTLSTransportSuccess ) &&
+         ( TLS_Session_Load( pHostName, &xCachedSession ) == 0 ) &&
+         ( mbedtls_ssl_set_session( &pxEspTlsTransport->xSsl, &xCachedSession ) == 0 ) )
+    {
+        ESP_LOGI( TAG, "Offering cached TLS session for %s", pHostName );
+        xSessionOffered = pdTRUE;
+    }
 
-        if ( pNetworkCredentials->pucRootCa )
-        {
-            ESP_LOGI( TAG, "Setting CA store");
-            esp_tls_set_global_ca_store( ( const unsigned char * ) pNetworkCredentials->pucRootCa, pNetworkCredentials->xRootCaSize );
-        }
+    if ( xReturnStatus == eTLSTransportSuccess )
+    {
+        xTcpConfig.timeout_ms = ulReceiveTimeoutMs;
 
-        if ( pNetworkCredentials->pucClientCert )
+        if ( esp_tls_plain_tcp_connect( pHostName, strlen( pHostName ), usPort, &xTcpConfig, &xTcpError, &pxEspTlsTransport->xNet.fd ) != ESP_OK )
         {
-            esp_transport_ssl_set_client_cert_data_der( pxEspTlsTransport->xTransport, ( const char *) pNetworkCredentials->pucClientCert, pNetworkCredentials->xClientCertSize );
+            ESP_LOGE( TAG, "Failed opening the TCP connection to %s:%u", pHostName, usPort );
+            xReturnStatus = eTLSTransportConnectFailure;
         }
+    }
+
+    if ( xReturnStatus == eTLSTransportSuccess )
+    {
+        struct timeval xSendTimeout = {
+            .tv_sec = ulSendTimeoutMs / 1000,
+            .tv_usec = ( ulSendTimeoutMs % 1000 ) * 1000,
+        };
+
+        /* Reads time out through mbedtls_net_recv_timeout, sends through the socket. */
+        setsockopt( pxEspTlsTransport->xNet.fd, SOL_SOCKET, SO_SNDTIMEO, &xSendTimeout, sizeof( xSendTimeout ) );
 
-        if ( pNetworkCredentials->pucPrivateKey )
+        lMbedtlsError = TLS_Session_Handshake( pHostName, &pxEspTlsTransport->xSsl, xSessionOffered );
+
+        if ( lMbedtlsError != 0 )
         {
-            esp_transport_ssl_set_client_key_data_der( pxEspTlsTransport->xTransport, (const char *) pNetworkCredentials->pucPrivateKey, pNetworkCredentials->xPrivateKeySize );
+            ESP_LOGE( TAG, "TLS handshake with %s failed: -0x%04x", pHostName, ( unsigned ) -lMbedtlsError );
+            xReturnStatus = ( lMbedtlsError == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED ) ? eTLSTransportCAVerifyFailed : eTLSTransportHandshakeFailed;
         }
-
     }
 
-    if ( esp_transport_connect( pxEspTlsTransport->xTransport, pHostName, usPort, ulReceiveTimeoutMs ) < 0 )
-    {
-        ESP_LOGE( TAG, "Failed establishing TLS connection (esp_transport_connect failed)" );
-        xReturnStatus = eTLSTransportConnectFailure;
-    }
-    else
-    {
-        xReturnStatus = eTLSTransportSuccess;
-    }
+    mbedtls_ssl_session_free( &xCachedSession );
 
     /* Clean up on failure. */
     if( xReturnStatus != eTLSTransportSuccess )
     {
-        if( pxEspTlsTransport != NULL )
-        {
-            esp_transport_close( pxEspTlsTransport->xTransport );
-            esp_tls_free_global_ca_store( );
-            esp_transport_list_destroy(pxEspTlsTransport->xTransportList);
-            vPortFree(pxEspTlsTransport);
-            pxTlsParams->xSSLContext = NULL;
-        }
+        prvFreeContexts( pxEspTlsTransport );
+        prvReleaseCaStore( pxEspTlsTransport );
+        vPortFree(pxEspTlsTransport);
+        pxTlsParams->xSSLContext = NULL;
     }
     else
     {
@@ -192,7 +412,7 @@ void TLS_Socket_Disconnect( NetworkContext_t * pNetworkContext )
 
     TlsTransportParams_t * pxTlsParams = (TlsTransportParams_t*)pNetworkContext->pParams;
 
-    if (( pxTlsParams == NULL ))
+    if (( pxTlsParams == NULL ) || ( pxTlsParams->xSSLContext == NULL ))
     {
         ESP_LOGE( TAG, "Invalid input parameter(s): Arguments cannot be NULL." );
         return;
@@ -200,14 +420,14 @@ void TLS_Socket_Disconnect( NetworkContext_t * pNetworkContext )
 
     EspTlsTransportParams_t * pxEspTlsTransport = (EspTlsTransportParams_t *)pxTlsParams->xSSLContext;
 
-    /* Attempting to terminate TLS connection. */
-    esp_transport_close( pxEspTlsTransport->xTransport );
+    /* Attempting to terminate TLS connection, best effort on a socket that may be gone. */
+    mbedtls_ssl_close_notify( &pxEspTlsTransport->xSsl );
+    prvFreeContexts( pxEspTlsTransport );
 
     /* Clear CA store. */
-    esp_tls_free_global_ca_store( );
+    prvReleaseCaStore( pxEspTlsTransport );
 
     /* Free TLS contexts. */
-    esp_transport_list_destroy(pxEspTlsTransport->xTransportList);
     vPortFree(pxEspTlsTransport);
     pxTlsParams->xSSLContext = NULL;
 }
@@ -238,10 +458,26 @@ int32_t TLS_Socket_Recv( NetworkContext_t * pNetworkContext,
 
     EspTlsTransportParams_t * pxEspTlsTransport = (EspTlsTransportParams_t *)pxTlsParams->xSSLContext;
 
-    tlsStatus = esp_transport_read( pxEspTlsTransport->xTransport, pBuffer, xBytesToRecv, pxEspTlsTransport->ulReceiveTimeoutMs);
-    if ( tlsStatus < 0 )
+    tlsStatus = mbedtls_ssl_read( &pxEspTlsTransport->xSsl, pBuffer, xBytesToRecv );
+
+    /* A TLS 1.3 ticket is the session to resume next time, no application data came with it. */
+    if ( tlsStatus == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET )
+    {
+        TLS_Session_Store( pxEspTlsTransport->cHostName, &pxEspTlsTransport->xSsl );
+        return 0;
+    }
+
+    /* Nothing arrived within the receive timeout, the caller retries. */
+    if ( ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
+         ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
+         ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) )
     {
-        ESP_LOGE( TAG, "Reading failed, errno= %d", errno );
+        return 0;
+    }
+
+    if ( tlsStatus <= 0 )
+    {
+        ESP_LOGE( TAG, "Reading failed, status= %d, errno= %d", ( int ) tlsStatus, errno );
         return ESP_FAIL;
     }
 
@@ -274,13 +510,20 @@ int32_t TLS_Socket_Send( NetworkContext_t * pNetworkContext,
 
     EspTlsTransportParams_t * pxEspTlsTransport = (EspTlsTransportParams_t *)pxTlsParams->xSSLContext;
 
-    tlsStatus = esp_transport_write( pxEspTlsTransport->xTransport, pBuffer, xBytesToSend, pxEspTlsTransport->ulSendTimeoutMs );
+    tlsStatus = mbedtls_ssl_write( &pxEspTlsTransport->xSsl, pBuffer, xBytesToSend );
+
+    if ( ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
+         ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) )
+    {
+        return 0;
+    }
+
     if ( tlsStatus < 0 )
     {
-        ESP_LOGE( TAG, "Writing failed, errno= %d", errno );
+        ESP_LOGE( TAG, "Writing failed, status= %d, errno= %d", ( int ) tlsStatus, errno );
         return ESP_FAIL;
     }
 
     return tlsStatus;
 }
-/*-----------------------------------------------------------*/
\ No newline at end of file
+/*-----------------------------------------------------------*/
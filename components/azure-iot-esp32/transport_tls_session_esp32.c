@@ -0,0 +1,253 @@
+/* Copyright (c) Microsoft Corporation.
+ * Licensed under the MIT License. */
+
+/**
+ * @file transport_tls_session_esp32.c
+ * @brief TLS session cache kept in RTC slow memory so it survives deep sleep.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "freertos/FreeRTOS.h"
+
+#include "esp_attr.h"
+#include "esp_log.h"
+
+#include "transport_tls_session.h"
+
+static const char *TAG = "tls_session";
+
+#define TLS_SESSION_CACHE_MAGIC    ( 0x544C5331UL )
+
+/**
+ * @brief One serialized session, keyed by a hash of the host name.
+ */
+typedef struct TlsSessionSlot
+{
+    uint32_t ulHostHash;
+    uint32_t ulLength;
+    uint32_t ulAge;
+    uint8_t ucData[ TLS_SESSION_CACHE_SLOT_SIZE ];
+} TlsSessionSlot_t;
+
+typedef struct TlsSessionCache
+{
+    uint32_t ulMagic;
+    uint32_t ulClock;
+    TlsSessionCacheStats_t xStats;
+    TlsSessionSlot_t xSlots[ TLS_SESSION_CACHE_SLOTS ];
+} TlsSessionCache_t;
+
+/* Zeroed on power-on, retained across deep sleep. */
+static RTC_DATA_ATTR TlsSessionCache_t xSessionCache;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHashHostName( const char * pcHostName )
+{
+    uint32_t ulHash = 2166136261UL;
+
+    while( *pcHostName != '\0' )
+    {
+        ulHash = ( ulHash ^ ( uint8_t ) *pcHostName++ ) * 16777619UL;
+    }
+
+    /* 0 marks an empty slot. */
+    return ( ulHash == 0 ) ? 1 : ulHash;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCacheInit( void )
+{
+    if( xSessionCache.ulMagic != TLS_SESSION_CACHE_MAGIC )
+    {
+        memset( &xSessionCache, 0, sizeof( xSessionCache ) );
+        xSessionCache.ulMagic = TLS_SESSION_CACHE_MAGIC;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TlsSessionSlot_t * prvFindSlot( uint32_t ulHostHash )
+{
+    for( size_t i = 0; i < TLS_SESSION_CACHE_SLOTS; i++ )
+    {
+        if( xSessionCache.xSlots[ i ].ulHostHash == ulHostHash )
+        {
+            return &xSessionCache.xSlots[ i ];
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static TlsSessionSlot_t * prvVictimSlot( void )
+{
+    TlsSessionSlot_t * pxVictim = &xSessionCache.xSlots[ 0 ];
+
+    for( size_t i = 0; i < TLS_SESSION_CACHE_SLOTS; i++ )
+    {
+        if( xSessionCache.xSlots[ i ].ulHostHash == 0 )
+        {
+            return &xSessionCache.xSlots[ i ];
+        }
+
+        if( xSessionCache.xSlots[ i ].ulAge < pxVictim->ulAge )
+        {
+            pxVictim = &xSessionCache.xSlots[ i ];
+        }
+    }
+
+    return pxVictim;
+}
+/*-----------------------------------------------------------*/
+
+
+int32_t TLS_Session_Load( const char * pcHostName,
+                          mbedtls_ssl_session * pxSession )
+{
+    TlsSessionSlot_t * pxSlot;
+    int32_t lMbedtlsError;
+
+    prvCacheInit();
+
+    if( ( pxSlot = prvFindSlot( prvHashHostName( pcHostName ) ) ) == NULL )
+    {
+        return -1;
+    }
+
+    lMbedtlsError = mbedtls_ssl_session_load( pxSession, pxSlot->ucData, pxSlot->ulLength );
+
+    if( lMbedtlsError != 0 )
+    {
+        /* Usually a session saved by a different mbedTLS build. */
+        ESP_LOGW( TAG, "Dropping unusable session for %s: %d", pcHostName, lMbedtlsError );
+        memset( pxSlot, 0, sizeof( *pxSlot ) );
+    }
+
+    return lMbedtlsError;
+}
+/*-----------------------------------------------------------*/
+
+void TLS_Session_Store( const char * pcHostName,
+                        const mbedtls_ssl_context * pxSslContext )
+{
+    mbedtls_ssl_session xSession;
+    TlsSessionSlot_t * pxSlot;
+    uint32_t ulHostHash = prvHashHostName( pcHostName );
+    size_t xLength = 0;
+    int32_t lMbedtlsError;
+
+    prvCacheInit();
+    mbedtls_ssl_session_init( &xSession );
+
+    lMbedtlsError = mbedtls_ssl_get_session( pxSslContext, &xSession );
+
+    if( ( pxSlot = prvFindSlot( ulHostHash ) ) == NULL )
+    {
+        pxSlot = prvVictimSlot();
+    }
+
+    if( lMbedtlsError == 0 )
+    {
+        lMbedtlsError = mbedtls_ssl_session_save( &xSession, pxSlot->ucData, sizeof( pxSlot->ucData ), &xLength );
+    }
+
+    if( lMbedtlsError == 0 )
+    {
+        pxSlot->ulHostHash = ulHostHash;
+        pxSlot->ulLength = ( uint32_t ) xLength;
+        pxSlot->ulAge = ++xSessionCache.ulClock;
+    }
+    else
+    {
+        ESP_LOGW( TAG, "Failed to save session for %s: %d (needs %u bytes)", pcHostName, lMbedtlsError, ( unsigned ) xLength );
+        memset( pxSlot, 0, sizeof( *pxSlot ) );
+        xSessionCache.xStats.ulStoreFails++;
+    }
+
+    mbedtls_ssl_session_free( &xSession );
+}
+/*-----------------------------------------------------------*/
+
+int32_t TLS_Session_Handshake( const char * pcHostName,
+                               mbedtls_ssl_context * pxSslContext,
+                               BaseType_t xSessionOffered )
+{
+    /* Both a TLS 1.2 ID or ticket resumption and a TLS 1.3 PSK key exchange skip the server
+     * certificate. An echoed session ID proves nothing, TLS 1.3 middlebox compatibility mode
+     * echoes a random one on every handshake. */
+    BaseType_t xResumed = xSessionOffered;
+    int32_t lMbedtlsError;
+
+    prvCacheInit();
+
+    do
+    {
+        lMbedtlsError = mbedtls_ssl_handshake_step( pxSslContext );
+
+        if( pxSslContext->MBEDTLS_PRIVATE( state ) == MBEDTLS_SSL_SERVER_CERTIFICATE )
+        {
+            xResumed = pdFALSE;
+        }
+    } while( ( ( lMbedtlsError == 0 ) ||
+               ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
+               ( lMbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) ) &&
+             !mbedtls_ssl_is_handshake_over( pxSslContext ) );
+
+    if( lMbedtlsError != 0 )
+    {
+        /* Do not offer the same session again if it is what made the handshake fail. */
+        if( xSessionOffered )
+        {
+            TLS_Session_Invalidate( pcHostName );
+        }
+
+        return lMbedtlsError;
+    }
+
+    if( xResumed )
+    {
+        xSessionCache.xStats.ulHits++;
+    }
+    else
+    {
+        xSessionCache.xStats.ulMisses++;
+    }
+
+    ESP_LOGI( TAG, "Session cache hits: %lu, misses: %lu",
+              ( unsigned long ) xSessionCache.xStats.ulHits,
+              ( unsigned long ) xSessionCache.xStats.ulMisses );
+
+    /* A TLS 1.3 server sends its ticket after the handshake, TLS_Session_Store() runs when the
+     * read path gets it. Exporting the session now would overwrite the cached ticket. */
+    if( mbedtls_ssl_get_version_number( pxSslContext ) != MBEDTLS_SSL_VERSION_TLS1_3 )
+    {
+        TLS_Session_Store( pcHostName, pxSslContext );
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void TLS_Session_Invalidate( const char * pcHostName )
+{
+    TlsSessionSlot_t * pxSlot;
+
+    prvCacheInit();
+
+    if( ( pxSlot = prvFindSlot( prvHashHostName( pcHostName ) ) ) != NULL )
+    {
+        memset( pxSlot, 0, sizeof( *pxSlot ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void TLS_Session_GetStats( TlsSessionCacheStats_t * pxStats )
+{
+    prvCacheInit();
+    *pxStats = xSessionCache.xStats;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fake_devices.h"
+#include "sim_door.h"
+
+using namespace std;
+
+#define BENCH_DEFAULT_SESSIONS  ( 10000 )
+#define BENCH_KEY_INTERVAL_MS   ( 250 )
+#define BENCH_PASSWORD          "1234"
+#define BENCH_ENROLLED_FINGER   ( 1 )
+#define BENCH_UNKNOWN_FINGER    ( 77 )
+
+enum class Scenario : uint8_t
+{
+    PinUnlock,
+    PinMismatch,
+    FingerprintUnlock,
+    FingerprintUnknown,
+    FastMismatchLockdown,
+    PasswordChange,
+    Enrollment,
+    Count,
+};
+
+/* Indexed by Scenario */
+static const char* SCENARIO_NAMES[] = {
+    "pin_unlock", "pin_mismatch", "fp_unlock", "fp_unknown", "fast_lockdown", "password_change", "enrollment",
+};
+
+typedef struct ScenarioStats_s
+{
+    size_t failed = 0;
+    vector<int64_t> wall_ns;
+    vector<int64_t> motor_latency_us;
+} ScenarioStats_t;
+
+/* One fresh lock per session, devices included */
+class Session
+{
+public:
+    Session() : sensor(clock), audio(actuator_clock), motor(actuator_clock), reader(&sensor), door(clock, actuator_clock, keypad, reader, audio, motor)
+    {
+        sensor.enroll(BENCH_ENROLLED_FINGER);
+        door.set_password(BENCH_PASSWORD);
+    }
+
+    void type(const string& keys, int64_t interval_ms = BENCH_KEY_INTERVAL_MS)
+    {
+        for (char key: keys)
+        {
+            door.advance_to(clock.now_us() + interval_ms * 1000);
+            keypad.press(key);
+            door.on_key_activity();
+            keypad.press('\0');
+        }
+    }
+
+    void touch(uint16_t finger_id)
+    {
+        sensor.place_finger(finger_id);
+        door.on_finger_touched();
+        sensor.remove_finger();
+    }
+
+    void wait_ms(int64_t ms) { door.advance_to(clock.now_us() + ms * 1000); }
+
+    SimClock clock;
+    SimClock actuator_clock;
+    FakeEf01Sensor sensor;
+    ScriptedKeypad keypad;
+    RecordingAudioSink audio;
+    SimDoorMotor motor;
+    FingerprintReader reader;
+    SimDoor door;
+};
+
+/* Returns false when the lock ended up somewhere it should not have */
+static bool run_scenario(Scenario scenario, Session& s, int64_t* motor_latency_us)
+{
+    switch (scenario)
+    {
+        case Scenario::PinUnlock:
+            s.type(BENCH_PASSWORD "*");
+            *motor_latency_us = s.door.get_last_motor_latency_us();
+
+            if (!s.motor.is_open() || s.door.get_state() != DoorState::Unlocked)
+                return false;
+
+            /* Auto-close counts from the end of the motor run and the "opened" clip */
+            s.wait_ms(DEFAULT_AUTO_CLOSE_TIME_S * 1000 + 3000);
+            return !s.motor.is_open() && s.door.get_state() == DoorState::Locked;
+
+        case Scenario::PinMismatch:
+            s.type("9999*");
+            return !s.motor.is_open() && s.audio.get_play_cnt(AudioName::RepeatAgain) == 1;
+
+        case Scenario::FingerprintUnlock:
+            s.touch(BENCH_ENROLLED_FINGER);
+            *motor_latency_us = s.door.get_last_motor_latency_us();
+
+            if (!s.motor.is_open())
+                return false;
+
+            s.type("*");
+            return !s.motor.is_open() && s.door.get_state() == DoorState::Locked;
+
+        case Scenario::FingerprintUnknown:
+            s.touch(BENCH_UNKNOWN_FINGER);
+            return !s.motor.is_open() && s.door.get_state() == DoorState::Locked;
+
+        case Scenario::FastMismatchLockdown:
+            /* Back to back wrong entries just over the key debounce */
+            s.type("1*2*3*", KEY_DEBOUNCE_MS + 10);
+
+            if (s.door.get_state() != DoorState::Lockdown)
+                return false;
+
+            s.type(BENCH_PASSWORD "*");
+
+            if (s.motor.is_open())
+                return false;
+
+            s.wait_ms(DEFAULT_LOCKDOWN_TIME_S * 1000);
+            return s.door.get_state() == DoorState::Locked;
+
+        case Scenario::PasswordChange:
+            s.type(BENCH_PASSWORD "#" "5678#" "5678#");
+
+            if (s.door.get_state() != DoorState::Locked)
+                return false;
+
+            s.type("5678*");
+            *motor_latency_us = s.door.get_last_motor_latency_us();
+            return s.motor.is_open();
+
+        case Scenario::Enrollment:
+            s.sensor.place_finger(BENCH_UNKNOWN_FINGER);
+            s.door.on_button(LockButton::Enroll);
+            s.sensor.remove_finger();
+
+            if (s.door.get_state() != DoorState::Locked || s.audio.get_play_cnt(AudioName::Enrolled) != 1)
+                return false;
+
+            s.touch(BENCH_UNKNOWN_FINGER);
+            return s.motor.is_open();
+
+        default:
+            return false;
+    }
+}
+
+static int64_t percentile(vector<int64_t>& values, int pct)
+{
+    if (values.empty())
+        return 0;
+
+    sort(values.begin(), values.end());
+    return values[min(values.size() - 1, values.size() * pct / 100)];
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_sessions = argc > 1 ? strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_SESSIONS;
+    uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, static_cast<int>(Scenario::Count) - 1);
+    ScenarioStats_t stats[static_cast<size_t>(Scenario::Count)];
+    size_t failed = 0;
+
+    auto bench_start = chrono::steady_clock::now();
+
+    for (size_t i = 0; i < num_sessions; ++i)
+    {
+        Scenario scenario = static_cast<Scenario>(pick(rng));
+        ScenarioStats_t& stat = stats[static_cast<size_t>(scenario)];
+        int64_t motor_latency_us = -1;
+
+        auto start = chrono::steady_clock::now();
+        Session session;
+        bool ok = run_scenario(scenario, session, &motor_latency_us);
+        auto elapsed = chrono::steady_clock::now() - start;
+
+        stat.wall_ns.push_back(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+
+        if (motor_latency_us >= 0)
+            stat.motor_latency_us.push_back(motor_latency_us);
+
+        if (!ok || session.sensor.get_bad_packet_cnt() > 0)
+        {
+            ++stat.failed;
+            ++failed;
+        }
+    }
+
+    double total_s = chrono::duration<double>(chrono::steady_clock::now() - bench_start).count();
+
+    printf("%-16s %7s %6s %12s %12s %14s %14s\n", "scenario", "n", "fail", "wall p50 us", "wall p99 us", "motor p50 ms", "motor p99 ms");
+
+    for (size_t i = 0; i < static_cast<size_t>(Scenario::Count); ++i)
+    {
+        ScenarioStats_t& stat = stats[i];
+
+        printf("%-16s %7zu %6zu %12.2f %12.2f %14.1f %14.1f\n", SCENARIO_NAMES[i], stat.wall_ns.size(), stat.failed,
+               percentile(stat.wall_ns, 50) / 1000.0, percentile(stat.wall_ns, 99) / 1000.0,
+               percentile(stat.motor_latency_us, 50) / 1000.0, percentile(stat.motor_latency_us, 99) / 1000.0);
+    }
+
+    printf("%zu sessions in %.3f s, %.0f sessions/s, %zu failed\n", num_sessions, total_s, num_sessions / total_s, failed);
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "door_fsm.h"
+
+using namespace std;
+
+/*
+ * Replays an input trace straight into DoorFsm, without devices or timing, to measure the cost of a step:
+ *   ./build_host/bench_fsm [trace.txt | -] [repeat] [seed]
+ * A trace file has one DoorInput name per line, '#' starts a comment. Without one (or with '-') a seeded
+ * random trace is generated. Every pass must end in the same state with the same command stream.
+ */
+
+#define BENCH_FSM_DEFAULT_REPEAT    ( 1000 )
+#define BENCH_FSM_GENERATED_STEPS   ( 10000 )
+#define BENCH_FSM_MAX_MISMATCH      ( 3 )
+
+/* Indexed by DoorInput */
+static const char* INPUT_NAMES[] = {
+    "door_button", "enroll_button", "close_key", "password_ok", "password_mismatch", "password_mismatch_limit",
+    "change_requested", "new_password_entered", "password_confirmed", "fingerprint_ok", "fingerprint_mismatch",
+    "fingerprint_mismatch_limit", "enroll_ok", "enroll_failed", "auto_close_due", "lockdown_expired",
+    "remote_unlock", "remote_lock",
+};
+
+/* Indexed by DoorState */
+static const char* STATE_NAMES[] = {
+    "locked", "unlocked", "lockdown", "password_change", "password_confirm", "enrolling",
+};
+
+static_assert(sizeof(INPUT_NAMES) / sizeof(INPUT_NAMES[0]) == door_fsm::NUM_INPUTS, "INPUT_NAMES is indexed by DoorInput");
+static_assert(sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]) == door_fsm::NUM_STATES, "STATE_NAMES is indexed by DoorState");
+
+typedef struct PassResult_s
+{
+    uint64_t digest = 0;
+    size_t num_applied = 0;
+    size_t num_commands = 0;
+    size_t state_steps[door_fsm::NUM_STATES] = { 0 };
+} PassResult_t;
+
+/* The limits are derived by step() and never fed in */
+static bool is_derived(DoorInput input)
+{
+    return input == DoorInput::PasswordMismatchLimit || input == DoorInput::FingerprintMismatchLimit;
+}
+
+static bool load_trace(const char* path, vector<DoorInput>* trace)
+{
+    ifstream file(path);
+    string line;
+    size_t line_num = 0;
+
+    if (!file)
+        return false;
+
+    while (getline(file, line))
+    {
+        ++line_num;
+        line = line.substr(0, line.find('#'));
+        line.erase(remove_if(line.begin(), line.end(), [](char c) { return isspace(static_cast<unsigned char>(c)); }), line.end());
+
+        if (line.empty())
+            continue;
+
+        auto name = find_if(begin(INPUT_NAMES), end(INPUT_NAMES), [&](const char* n) { return line == n; });
+        DoorInput input = static_cast<DoorInput>(name - begin(INPUT_NAMES));
+
+        if (name == end(INPUT_NAMES) || is_derived(input))
+        {
+            fprintf(stderr, "%s:%zu: unknown input '%s'\n", path, line_num, line.c_str());
+            return false;
+        }
+
+        trace->push_back(input);
+    }
+
+    return true;
+}
+
+/* Inputs drawn uniformly, so every state sees its ignored inputs as often as its valid ones */
+static void generate_trace(uint32_t seed, vector<DoorInput>* trace)
+{
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, static_cast<int>(DoorInput::Count) - 1);
+
+    while (trace->size() < BENCH_FSM_GENERATED_STEPS)
+    {
+        DoorInput input = static_cast<DoorInput>(pick(rng));
+
+        if (!is_derived(input))
+            trace->push_back(input);
+    }
+}
+
+/* FNV-1a over the state after each step and the commands it issued */
+static void mix(uint64_t* digest, uint8_t value)
+{
+    *digest = (*digest ^ value) * 0x100000001B3ULL;
+}
+
+static PassResult_t run_pass(const vector<DoorInput>& trace)
+{
+    DoorFsm fsm(BENCH_FSM_MAX_MISMATCH);
+    PassResult_t result;
+
+    result.digest = 0xCBF29CE484222325ULL;
+
+    for (DoorInput input: trace)
+    {
+        ++result.state_steps[static_cast<size_t>(fsm.get_state())];
+
+        const DoorTransition_t* transition = fsm.step(input);
+
+        if (transition != nullptr)
+        {
+            ++result.num_applied;
+
+            for (FsmCommand command: transition->commands)
+            {
+                if (command == FsmCommand::None)
+                    break;
+
+                ++result.num_commands;
+                mix(&result.digest, static_cast<uint8_t>(command));
+            }
+        }
+
+        mix(&result.digest, static_cast<uint8_t>(fsm.get_state()));
+    }
+
+    return result;
+}
+
+static int64_t percentile(vector<int64_t>& values, int pct)
+{
+    if (values.empty())
+        return 0;
+
+    sort(values.begin(), values.end());
+    return values[min(values.size() - 1, values.size() * pct / 100)];
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 && strcmp(argv[1], "-") != 0 ? argv[1] : nullptr;
+    size_t repeat = argc > 2 ? strtoul(argv[2], nullptr, 10) : BENCH_FSM_DEFAULT_REPEAT;
+    uint32_t seed = argc > 3 ? strtoul(argv[3], nullptr, 10) : 1;
+    vector<DoorInput> trace;
+    bool is_loaded = true;
+
+    if (path != nullptr)
+        is_loaded = load_trace(path, &trace);
+    else
+        generate_trace(seed, &trace);
+
+    if (!is_loaded)
+    {
+        fprintf(stderr, "Failed to load %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (trace.empty() || repeat == 0)
+    {
+        fprintf(stderr, "Nothing to replay\n");
+        return EXIT_FAILURE;
+    }
+
+    PassResult_t first = run_pass(trace);
+    vector<int64_t> step_ps;
+    size_t diverged = 0;
+
+    for (size_t i = 0; i < repeat; ++i)
+    {
+        auto start = chrono::steady_clock::now();
+        PassResult_t result = run_pass(trace);
+        auto elapsed = chrono::steady_clock::now() - start;
+
+        step_ps.push_back(chrono::duration_cast<chrono::nanoseconds>(elapsed).count() * 1000 / static_cast<int64_t>(trace.size()));
+
+        if (result.digest != first.digest)
+            ++diverged;
+    }
+
+    printf("%-18s %9s %7s\n", "state", "steps", "share");
+
+    for (size_t i = 0; i < door_fsm::NUM_STATES; ++i)
+        printf("%-18s %9zu %6.1f%%\n", STATE_NAMES[i], first.state_steps[i], 100.0 * first.state_steps[i] / trace.size());
+
+    printf("%zu inputs, %zu applied, %zu commands, table %zu B, digest %016llx\n", trace.size(), first.num_applied,
+           first.num_commands, sizeof(door_fsm::TABLE), static_cast<unsigned long long>(first.digest));
+    printf("step p50 %.2f ns, p99 %.2f ns over %zu passes, %zu diverged\n",
+           percentile(step_ps, 50) / 1000.0, percentile(step_ps, 99) / 1000.0, repeat, diverged);
+
+    return diverged == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
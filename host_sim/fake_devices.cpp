@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <numeric>
+
+#include "fingerprint/defs.h"
+#include "fake_devices.h"
+
+using namespace std;
+
+#define EF01_HEADER_LEN ( 9 )   /* Start code, address, type, length */
+
+/* ---------- EF01 Sensor ---------- */
+void FakeEf01Sensor::write(const uint8_t* data, size_t len)
+{
+    _rx.insert(_rx.end(), data, data + len);
+
+    while (_rx.size() >= EF01_HEADER_LEN)
+    {
+        if (_rx[0] != (FINGERPRINT_START_CODE >> 8) || _rx[1] != (FINGERPRINT_START_CODE & 0xFF))
+        {
+            ++_bad_packet_cnt;
+            _rx.erase(_rx.begin());
+            continue;
+        }
+
+        uint16_t wire_len = (static_cast<uint16_t>(_rx[7]) << 8) | _rx[8];
+
+        if (_rx.size() < static_cast<size_t>(EF01_HEADER_LEN + wire_len))
+            return;
+
+        const uint8_t* payload = _rx.data() + EF01_HEADER_LEN;
+        uint16_t data_len = wire_len - 2;
+        uint16_t sum = (wire_len >> 8) + (wire_len & 0xFF) + _rx[6];
+        sum += accumulate(payload, payload + data_len, 0);
+        uint16_t wire_sum = (static_cast<uint16_t>(payload[data_len]) << 8) | payload[data_len + 1];
+
+        if (_rx[6] != FINGERPRINT_CMD_PACKET || sum != wire_sum)
+            ++_bad_packet_cnt;
+        else
+            _handle_command(payload, data_len);
+
+        _rx.erase(_rx.begin(), _rx.begin() + EF01_HEADER_LEN + wire_len);
+    }
+}
+
+bool FakeEf01Sensor::read_byte(uint8_t* byte, uint32_t timeout_ms)
+{
+    if (_tx.empty())
+    {
+        _clock.advance_ms(timeout_ms);
+        return false;
+    }
+
+    *byte = _tx.front();
+    _tx.pop_front();
+    return true;
+}
+
+void FakeEf01Sensor::_handle_command(const uint8_t* data, uint16_t len)
+{
+    ++_command_cnt;
+
+    switch (data[0])
+    {
+        case FINGERPRINT_GET_IMAGE:
+            _clock.advance_ms(CAPTURE_MS);
+            _image = _is_finger_present ? _finger : 0;
+            _reply(_is_finger_present ? FINGERPRINT_OK : FINGERPRINT_NO_FINGER);
+            break;
+
+        case FINGERPRINT_IMAGE_2TZ:
+            _clock.advance_ms(TEMPLATIZE_MS);
+            _char_buffers[len > 1 && data[1] == 2 ? 1 : 0] = _image;
+            _reply(FINGERPRINT_OK);
+            break;
+
+        case FINGERPRINT_SEARCH:
+        {
+            _clock.advance_ms(SEARCH_MS);
+            uint16_t candidate = _char_buffers[len > 1 && data[1] == 2 ? 1 : 0];
+
+            if (candidate != 0 && _templates.count(candidate) > 0)
+                _reply(FINGERPRINT_OK, { static_cast<uint8_t>(candidate >> 8), static_cast<uint8_t>(candidate & 0xFF), 0x00, 0x64 });
+            else
+                _reply(FINGERPRINT_NOT_FOUND, { 0x00, 0x00, 0x00, 0x00 });
+            break;
+        }
+
+        case FINGERPRINT_REG_MODEL:
+            _clock.advance_ms(COMMAND_MS);
+            _reply(_char_buffers[0] != 0 && _char_buffers[0] == _char_buffers[1] ? FINGERPRINT_OK : FINGERPRINT_ENROLL_MISMATCH);
+            break;
+
+        case FINGERPRINT_STORE:
+            _clock.advance_ms(COMMAND_MS);
+            _templates.insert(_char_buffers[0]);
+            _reply(FINGERPRINT_OK);
+            break;
+
+        case FINGERPRINT_EMPTY:
+            _clock.advance_ms(COMMAND_MS);
+            _templates.clear();
+            _reply(FINGERPRINT_OK);
+            break;
+
+        case FINGERPRINT_TEMPLATE_COUNT:
+        {
+            _clock.advance_ms(COMMAND_MS);
+            uint16_t cnt = static_cast<uint16_t>(_templates.size());
+            _reply(FINGERPRINT_OK, { static_cast<uint8_t>(cnt >> 8), static_cast<uint8_t>(cnt & 0xFF) });
+            break;
+        }
+
+        default:
+            _clock.advance_ms(COMMAND_MS);
+            _reply(FINGERPRINT_OK);
+            break;
+    }
+}
+
+void FakeEf01Sensor::_reply(uint8_t code, initializer_list<uint8_t> payload)
+{
+    vector<uint8_t> data = { code };
+    data.insert(data.end(), payload.begin(), payload.end());
+
+    uint16_t wire_len = static_cast<uint16_t>(data.size() + 2);
+    uint16_t sum = (wire_len >> 8) + (wire_len & 0xFF) + FINGERPRINT_ACK_PACKET;
+    sum += accumulate(data.begin(), data.end(), 0);
+
+    uint8_t header[EF01_HEADER_LEN] = {
+        FINGERPRINT_START_CODE >> 8, FINGERPRINT_START_CODE & 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF,
+        FINGERPRINT_ACK_PACKET,
+        static_cast<uint8_t>(wire_len >> 8), static_cast<uint8_t>(wire_len & 0xFF),
+    };
+
+    _tx.insert(_tx.end(), header, header + EF01_HEADER_LEN);
+    _tx.insert(_tx.end(), data.begin(), data.end());
+    _tx.push_back(static_cast<uint8_t>(sum >> 8));
+    _tx.push_back(static_cast<uint8_t>(sum & 0xFF));
+}
+
+void ReplayEf01Sensor::_handle_command(const uint8_t* data, uint16_t)
+{
+    if (_replies.empty() || _replies.front().sub != data[0])
+    {
+        ++_mismatch_cnt;
+        _clock.advance_ms(COMMAND_MS);
+        _reply(FINGERPRINT_PACKET_RECV_ERR);
+        return;
+    }
+
+    EventRecord_t record = _replies.front();
+    _replies.pop_front();
+
+    /* No reply, read_byte() lets the reader's own timeout run out */
+    if (record.input == static_cast<uint8_t>(RecordedInput::FpTimeout))
+        return;
+
+    /* The reply arrives when it did on the device */
+    if (_clock.now_us() < record.time_us)
+        _clock.advance_us(record.time_us - _clock.now_us());
+
+    uint8_t hi = static_cast<uint8_t>(record.aux >> 8);
+    uint8_t lo = static_cast<uint8_t>(record.aux & 0xFF);
+
+    if (data[0] == FINGERPRINT_SEARCH)
+        _reply(static_cast<uint8_t>(record.arg), { hi, lo, 0x00, 0x00 });
+    else if (data[0] == FINGERPRINT_TEMPLATE_COUNT)
+        _reply(static_cast<uint8_t>(record.arg), { hi, lo });
+    else
+        _reply(static_cast<uint8_t>(record.arg));
+}
+/* --------------------------------- */
+
+/* ---------- Audio ---------- */
+void RecordingAudioSink::play(AudioName audio, int play_count)
+{
+    /* Rough clip lengths of audio/data */
+    int64_t clip_ms = audio == AudioName::Beep ? 100 : audio == AudioName::Siren ? 1000 : 900;
+
+    for (int i = 0; i < play_count; ++i)
+        _plays.push_back(audio);
+
+    _clock.advance_ms(clip_ms * play_count);
+}
+
+size_t RecordingAudioSink::get_play_cnt(AudioName audio) const
+{
+    return count(_plays.begin(), _plays.end(), audio);
+}
+/* --------------------------- */
+
+/* ---------- Motor ---------- */
+void SimDoorMotor::run(bool open, uint32_t duration_ms)
+{
+    _clock.advance_ms(duration_ms);
+    _is_open = open;
+    ++_run_cnt;
+}
+/* --------------------------- */
@@ -0,0 +1,132 @@
+#ifndef _H_HOST_SIM_FAKE_DEVICES_H_
+#define _H_HOST_SIM_FAKE_DEVICES_H_
+
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "hal/hal.h"
+#include "helper/event_recorder.h"
+
+/* Simulated time, every fake device advances it by what the real part would take */
+class SimClock : public Clock
+{
+public:
+    int64_t now_us() const override { return _now_us; }
+    void advance_us(int64_t us) { _now_us += us; }
+    void advance_ms(int64_t ms) { _now_us += ms * 1000; }
+
+private:
+    int64_t _now_us = 0;
+};
+
+/* JM-101B model: parses EF01 command packets and answers with ACK packets */
+class FakeEf01Sensor : public SerialPort
+{
+public:
+    /* Typical JM-101B timings at 57600 baud */
+    const static uint32_t CAPTURE_MS = 180;
+    const static uint32_t TEMPLATIZE_MS = 40;
+    const static uint32_t SEARCH_MS = 60;
+    const static uint32_t COMMAND_MS = 5;
+
+    FakeEf01Sensor(SimClock& clock) : _clock(clock) { }
+
+    /* 0 is a finger the sensor has never seen */
+    void place_finger(uint16_t finger_id) { _finger = finger_id; _is_finger_present = true; }
+    void remove_finger() { _is_finger_present = false; }
+
+    void enroll(uint16_t finger_id) { _templates.insert(finger_id); }
+    size_t get_command_cnt() const { return _command_cnt; }
+    size_t get_bad_packet_cnt() const { return _bad_packet_cnt; }
+
+    void write(const uint8_t* data, size_t len) override;
+    bool read_byte(uint8_t* byte, uint32_t timeout_ms) override;
+
+protected:
+    SimClock& _clock;
+
+    virtual void _handle_command(const uint8_t* data, uint16_t len);
+    void _reply(uint8_t code, std::initializer_list<uint8_t> payload = { });
+
+private:
+    std::vector<uint8_t> _rx;
+    std::deque<uint8_t> _tx;
+
+    bool _is_finger_present = false;
+    uint16_t _finger = 0;
+    uint16_t _image = 0;
+    uint16_t _char_buffers[2] = { 0, 0 };
+    std::set<uint16_t> _templates;
+
+    size_t _command_cnt = 0;
+    size_t _bad_packet_cnt = 0;
+};
+
+/* Answers with recorded FpFrame / FpTimeout records instead of the model, at the recorded times */
+class ReplayEf01Sensor : public FakeEf01Sensor
+{
+public:
+    ReplayEf01Sensor(SimClock& clock) : FakeEf01Sensor(clock) { }
+
+    void push_reply(const EventRecord_t& record) { _replies.push_back(record); }
+
+    /* Commands the recording has no matching reply for */
+    size_t get_mismatch_cnt() const { return _mismatch_cnt; }
+    size_t get_unused_cnt() const { return _replies.size(); }
+
+protected:
+    void _handle_command(const uint8_t* data, uint16_t len) override;
+
+private:
+    std::deque<EventRecord_t> _replies;
+    size_t _mismatch_cnt = 0;
+};
+
+/* 3x4 matrix, get_pressed_key() returns whatever the script pressed last */
+class ScriptedKeypad : public KeypadMatrix
+{
+public:
+    void press(char key) { _key = key; }
+    char get_pressed_key() override { return _key; }
+
+private:
+    char _key = '\0';
+};
+
+/* MAX98357A stand-in, only counts and takes the clip's play time */
+class RecordingAudioSink : public AudioSink
+{
+public:
+    RecordingAudioSink(SimClock& clock) : _clock(clock) { }
+
+    void play(AudioName audio, int play_count = 1) override;
+
+    size_t get_play_cnt(AudioName audio) const;
+    void reset() { _plays.clear(); }
+
+private:
+    SimClock& _clock;
+    std::vector<AudioName> _plays;
+};
+
+class SimDoorMotor : public DoorMotor
+{
+public:
+    SimDoorMotor(SimClock& clock) : _clock(clock) { }
+
+    void run(bool open, uint32_t duration_ms) override;
+
+    bool is_open() const { return _is_open; }
+    size_t get_run_cnt() const { return _run_cnt; }
+
+private:
+    SimClock& _clock;
+    bool _is_open = false;
+    size_t _run_cnt = 0;
+};
+
+#endif
@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "fake_devices.h"
+#include "sim_door.h"
+#include "helper/event_recorder.h"
+#include "helper/settings.h"
+
+using namespace std;
+
+/*
+ * Replays an evrec partition dump against the host build of the door logic:
+ *   parttool.py --port /dev/ttyUSB0 read_partition --partition-name evrec --output evrec.bin
+ *   ./build_host/replay_door evrec.bin [repeat] [-v]
+ * Every boot in the dump starts a fresh lock from its Boot record. The recorded FSM transitions
+ * are the expected output: a boot whose replayed transitions differ is reported and fails the run.
+ */
+
+#define REPLAY_CAPTURE_RETRY_CNT    ( 1000 )    /* The firmware retries until the sensor answers, the recording decides */
+#define REPLAY_RECORDS_PER_SECTOR   ( EVREC_SECTOR_SIZE / sizeof(EventRecord_t) )
+
+/* Indexed by RecordedInput */
+static const char* INPUT_NAMES[] = {
+    "sector", "boot", "setting", "button", "key_edge", "key", "entry", "finger", "presence",
+    "fp_frame", "fp_timeout", "remote", "tel_sent", "transition", "overflow",
+};
+
+static_assert(sizeof(INPUT_NAMES) / sizeof(INPUT_NAMES[0]) == static_cast<size_t>(RecordedInput::Count), "INPUT_NAMES is indexed by RecordedInput");
+
+typedef struct Transition_s
+{
+    uint8_t input;
+    uint8_t to;
+    int64_t time_us;
+} Transition_t;
+
+typedef struct BootReplay_s
+{
+    size_t num_inputs = 0;
+    size_t num_lost = 0;
+    size_t fp_mismatch_cnt = 0;
+    size_t entry_mismatch_cnt = 0;
+    int64_t duration_us = 0;
+    int64_t max_skew_us = 0;
+    vector<Transition_t> expected;
+    vector<Transition_t> replayed;
+} BootReplay_t;
+
+static bool is_input(const EventRecord_t& record, RecordedInput input)
+{
+    return record.input == static_cast<uint8_t>(input);
+}
+
+/* Sectors in write order, torn and erased slots skipped. Records before the first Boot belong to an overwritten boot */
+static bool load_boots(const char* path, vector<vector<EventRecord_t>>* boots, size_t* torn_cnt)
+{
+    ifstream file(path, ios::binary);
+
+    if (!file)
+        return false;
+
+    vector<uint8_t> image((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    vector<pair<uint32_t, size_t>> sectors;
+
+    for (size_t offset = 0; offset + EVREC_SECTOR_SIZE <= image.size(); offset += EVREC_SECTOR_SIZE)
+    {
+        EventRecord_t header;
+        memcpy(&header, image.data() + offset, sizeof(header));
+
+        if (header.check == event_record_check(header) && is_input(header, RecordedInput::SectorHeader) && header.time_us == EVREC_SECTOR_MAGIC)
+            sectors.push_back({ header.arg | static_cast<uint32_t>(header.aux) << 16, offset });
+    }
+
+    sort(sectors.begin(), sectors.end());
+
+    for (const auto& sector: sectors)
+    {
+        for (size_t slot = 1; slot < REPLAY_RECORDS_PER_SECTOR; ++slot)
+        {
+            EventRecord_t record;
+            memcpy(&record, image.data() + sector.second + slot * sizeof(record), sizeof(record));
+
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+
+            if (all_of(bytes, bytes + sizeof(record), [](uint8_t byte) { return byte == 0xFF; }))
+                break;
+
+            if (record.check != event_record_check(record) || record.input >= static_cast<uint8_t>(RecordedInput::Count))
+            {
+                ++*torn_cnt;
+                continue;
+            }
+
+            if (is_input(record, RecordedInput::Boot))
+                boots->emplace_back();
+
+            if (!boots->empty())
+                boots->back().push_back(record);
+        }
+    }
+
+    return true;
+}
+
+static void print_record(const EventRecord_t& record)
+{
+    printf("  %12.3f ms  %-10s sub %3u  arg 0x%04x  aux 0x%04x\n", record.time_us / 1000.0, INPUT_NAMES[record.input], record.sub, record.arg, record.aux);
+}
+
+static BootReplay_t replay_boot(vector<EventRecord_t> records, bool is_verbose)
+{
+    BootReplay_t result;
+
+    SimClock clock;
+    SimClock actuator_clock;
+    ReplayEf01Sensor sensor(clock);
+    ScriptedKeypad keypad;
+    RecordingAudioSink audio(actuator_clock);
+    SimDoorMotor motor(actuator_clock);
+    FingerprintReader reader(&sensor);
+    SimDoor door(clock, actuator_clock, keypad, reader, audio, motor);
+
+    deque<EventRecord_t> entries;
+    int64_t auto_close_ms = DEFAULT_AUTO_CLOSE_TIME_S * 1000LL;
+    int64_t lockdown_ms = DEFAULT_LOCKDOWN_TIME_S * 1000LL;
+
+    /* Claim order is kept for equal times, so a scan stays behind its edge */
+    stable_sort(records.begin(), records.end(), [](const EventRecord_t& a, const EventRecord_t& b) { return a.time_us < b.time_us; });
+
+    for (const auto& record: records)
+    {
+        if (is_input(record, RecordedInput::FpFrame) || is_input(record, RecordedInput::FpTimeout))
+            sensor.push_reply(record);
+        else if (is_input(record, RecordedInput::EntryResult))
+            entries.push_back(record);
+        else if (is_input(record, RecordedInput::FsmTransition))
+            result.expected.push_back({ record.sub, static_cast<uint8_t>(record.arg), record.time_us });
+    }
+
+    door.set_capture_retry_cnt(REPLAY_CAPTURE_RETRY_CNT);
+    door.set_entry_matcher([&entries, &result](const string&)
+    {
+        if (entries.empty())
+        {
+            ++result.entry_mismatch_cnt;
+            return make_pair(false, false);
+        }
+
+        uint16_t matches = entries.front().arg;
+        entries.pop_front();
+        return make_pair((matches & 0x1) != 0, (matches & 0x2) != 0);
+    });
+    door.set_transition_observer([&result](DoorInput input, DoorState to, int64_t time_us)
+    {
+        result.replayed.push_back({ static_cast<uint8_t>(input), static_cast<uint8_t>(to), time_us });
+    });
+
+    auto apply_setting = [&](const EventRecord_t& record)
+    {
+        uint32_t value = record.arg | static_cast<uint32_t>(record.aux) << 16;
+
+        if (record.sub == static_cast<uint8_t>(Setting::AutoCloseTimeS))
+            auto_close_ms = value * 1000LL;
+        else if (record.sub == static_cast<uint8_t>(Setting::LockdownTimeS))
+            lockdown_ms = value * 1000LL;
+
+        door.set_timing(auto_close_ms, lockdown_ms);
+    };
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const EventRecord_t& record = records[i];
+        RecordedInput input = static_cast<RecordedInput>(record.input);
+
+        if (is_verbose)
+            print_record(record);
+
+        switch (input)
+        {
+            case RecordedInput::Boot:
+                /* record_boot() writes the settings right behind it, the restore needs them */
+                for (size_t j = i + 1; j < records.size() && is_input(records[j], RecordedInput::SettingApplied); ++j)
+                    apply_setting(records[j]);
+
+                /* The device rounds the time left down to seconds, a lockdown it restored still expires through the timer */
+                door.restore(static_cast<DoorState>(record.arg & 0xF), (record.arg >> 4) & 0xF, (record.arg >> 8) & 0xF,
+                             (record.arg >> 12) == static_cast<uint16_t>(DoorStatus::Opened), max<int64_t>(record.aux * 1000LL, 1));
+                continue;
+
+            case RecordedInput::SettingApplied:
+                apply_setting(record);
+                continue;
+
+            case RecordedInput::Overflow:
+                result.num_lost += record.arg;
+                continue;
+
+            case RecordedInput::ButtonEdge:
+            case RecordedInput::KeyEdge:
+            case RecordedInput::FingerTouched:
+            case RecordedInput::RemoteDoor:
+                break;
+
+            default:
+                continue;
+        }
+
+        ++result.num_inputs;
+        door.advance_to(record.time_us);
+
+        if (input == RecordedInput::ButtonEdge && record.sub < static_cast<uint8_t>(LockButton::Count))
+            door.on_button(static_cast<LockButton>(record.sub));
+        else if (input == RecordedInput::FingerTouched)
+            door.on_finger_touched();
+        else if (input == RecordedInput::RemoteDoor)
+            door.on_remote_command(static_cast<DoorCommand>(record.arg));
+        else if (input == RecordedInput::KeyEdge)
+        {
+            /* The edge's scan result, if the device got as far as scanning */
+            char key = '\0';
+
+            for (size_t j = i + 1; j < records.size() && records[j].time_us == record.time_us; ++j)
+            {
+                if (is_input(records[j], RecordedInput::KeyScanned))
+                {
+                    key = static_cast<char>(records[j].arg);
+                    break;
+                }
+            }
+
+            keypad.press(key);
+            door.on_key_activity();
+            keypad.press('\0');
+        }
+
+        /* Whatever follows belongs to the next boot */
+        if (door.is_reset())
+            break;
+    }
+
+    if (!records.empty())
+    {
+        door.advance_to(records.back().time_us);
+        result.duration_us = records.back().time_us - records.front().time_us;
+    }
+
+    result.fp_mismatch_cnt = sensor.get_mismatch_cnt() + sensor.get_unused_cnt();
+
+    for (size_t i = 0; i < min(result.expected.size(), result.replayed.size()); ++i)
+        result.max_skew_us = max<int64_t>(result.max_skew_us, llabs(result.replayed[i].time_us - result.expected[i].time_us));
+
+    return result;
+}
+
+/* Index of the first transition that differs, SIZE_MAX when the replay matches the device */
+static size_t find_divergence(const BootReplay_t& result)
+{
+    for (size_t i = 0; i < max(result.expected.size(), result.replayed.size()); ++i)
+    {
+        if (i >= result.expected.size() || i >= result.replayed.size() ||
+            result.expected[i].input != result.replayed[i].input || result.expected[i].to != result.replayed[i].to)
+            return i;
+    }
+
+    return SIZE_MAX;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    size_t repeat = 1;
+    bool is_verbose = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            is_verbose = true;
+        else if (path == nullptr)
+            path = argv[i];
+        else
+            repeat = max<size_t>(1, strtoul(argv[i], nullptr, 10));
+    }
+
+    vector<vector<EventRecord_t>> boots;
+    size_t torn_cnt = 0;
+
+    if (path == nullptr || !load_boots(path, &boots, &torn_cnt))
+    {
+        fprintf(stderr, "usage: %s <evrec.bin> [repeat] [-v]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t diverged = 0;
+    int64_t traced_us = 0;
+    size_t num_records = 0;
+
+    printf("%-5s %-5s %8s %7s %11s %10s %6s %6s  %s\n", "boot", "start", "records", "inputs", "transitions", "skew ms", "fp", "lost", "result");
+
+    for (size_t b = 0; b < boots.size(); ++b)
+    {
+        BootReplay_t result = replay_boot(boots[b], is_verbose);
+        size_t divergence = find_divergence(result);
+        bool is_ok = divergence == SIZE_MAX && result.fp_mismatch_cnt == 0 && result.entry_mismatch_cnt == 0;
+
+        traced_us += result.duration_us;
+        num_records += boots[b].size();
+
+        printf("%-5zu %-5s %8zu %7zu %5zu/%-5zu %10.3f %6zu %6zu  ", b, boots[b].front().sub ? "warm" : "cold", boots[b].size(), result.num_inputs,
+               result.replayed.size(), result.expected.size(), result.max_skew_us / 1000.0, result.fp_mismatch_cnt, result.num_lost);
+
+        if (is_ok)
+        {
+            /* The stage overflowed, inputs are missing and a lost Boot merges two boots */
+            printf(result.num_lost > 0 ? "incomplete\n" : "ok\n");
+            continue;
+        }
+
+        ++diverged;
+
+        if (divergence == SIZE_MAX)
+        {
+            printf("diverged: %zu fingerprint, %zu entry records unmatched\n", result.fp_mismatch_cnt, result.entry_mismatch_cnt);
+            continue;
+        }
+
+        /* -1 stands for a transition one side never made */
+        auto describe = [](const vector<Transition_t>& transitions, size_t i, char* buf, size_t len)
+        {
+            if (i < transitions.size())
+                snprintf(buf, len, "%u->%u at %.3f ms", transitions[i].input, transitions[i].to, transitions[i].time_us / 1000.0);
+            else
+                snprintf(buf, len, "-1");
+        };
+
+        char expected[48];
+        char replayed[48];
+        describe(result.expected, divergence, expected, sizeof(expected));
+        describe(result.replayed, divergence, replayed, sizeof(replayed));
+        printf("diverged at #%zu: device %s, replay %s\n", divergence, expected, replayed);
+    }
+
+    /* Timing mode: the same dump over and over, for comparing builds */
+    auto start = chrono::steady_clock::now();
+
+    for (size_t r = 1; r < repeat; ++r)
+    {
+        for (const auto& boot: boots)
+            replay_boot(boot, false);
+    }
+
+    if (repeat > 1)
+    {
+        double wall_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("%zu replays of %zu records in %.3f s, %.0f records/s, %.0fx real time\n", repeat - 1, num_records, wall_s,
+               (repeat - 1) * num_records / wall_s, (repeat - 1) * traced_us / 1e6 / wall_s);
+    }
+
+    printf("%zu boots, %zu diverged, %zu torn records, %.1f s traced\n", boots.size(), diverged, torn_cnt, traced_us / 1e6);
+
+    return diverged == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
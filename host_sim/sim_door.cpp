@@ -0,0 +1,208 @@
+#include "sim_door.h"
+
+using namespace std;
+
+SimDoor::SimDoor(SimClock& clock, SimClock& actuator_clock, KeypadMatrix& keypad, FingerprintReader& reader, AudioSink& audio, DoorMotor& motor)
+    : _clock(clock), _actuator_clock(actuator_clock), _reader(reader), _controller(clock, keypad, *this), _actuator(actuator_clock, motor, audio, *this)
+{
+}
+
+void SimDoor::restore(DoorState state, uint8_t pwd_mismatch_cnt, uint8_t fingerprint_mismatch_cnt, bool is_door_open, int64_t lockdown_left_ms)
+{
+    DoorStatus door_status = is_door_open ? DoorStatus::Opened : DoorStatus::Closed;
+
+    _actuator.restore(door_status);
+    _controller.restore(state, pwd_mismatch_cnt, fingerprint_mismatch_cnt, door_status, lockdown_left_ms);
+    _settle();
+}
+
+void SimDoor::on_key_activity()
+{
+    _controller.on_key_activity(_clock.now_us());
+    _settle();
+}
+
+void SimDoor::on_finger_touched()
+{
+    _controller.on_finger_touched(_clock.now_us());
+    _settle();
+}
+
+void SimDoor::on_button(LockButton button)
+{
+    _controller.on_button(button, _clock.now_us());
+    _settle();
+}
+
+void SimDoor::on_remote_command(DoorCommand command)
+{
+    _controller.on_remote_command(command, _clock.now_us());
+    _settle();
+}
+
+void SimDoor::advance_to(int64_t time_us)
+{
+    if (_clock.now_us() < time_us)
+        _clock.advance_us(time_us - _clock.now_us());
+
+    if (_lockdown_due_us != 0 && _clock.now_us() >= _lockdown_due_us)
+    {
+        _lockdown_due_us = 0;
+        _controller.on_timer(DoorTimer::Lockdown, _clock.now_us());
+    }
+
+    if (_auto_close_due_us != 0 && _clock.now_us() >= _auto_close_due_us)
+    {
+        _auto_close_due_us = 0;
+        _controller.on_timer(DoorTimer::AutoClose, _clock.now_us());
+    }
+
+    _settle();
+}
+
+void SimDoor::post_action(const Action_t& action)
+{
+    _actions.push_back({ action, _clock.now_us() });
+}
+
+uint32_t SimDoor::get_timeout_ms(DoorTimer timer)
+{
+    return static_cast<uint32_t>(timer == DoorTimer::Lockdown ? _lockdown_ms : _auto_close_ms);
+}
+
+/* The actuator arms auto-close after the motor run, on its own clock */
+void SimDoor::start_timer(DoorTimer timer, uint32_t timeout_ms)
+{
+    int64_t due_us = (_is_actuating ? _actuator_clock : _clock).now_us() + timeout_ms * 1000LL;
+
+    if (timer == DoorTimer::Lockdown)
+        _lockdown_due_us = due_us;
+    else
+        _auto_close_due_us = due_us;
+}
+
+void SimDoor::stop_timer(DoorTimer timer)
+{
+    if (timer == DoorTimer::Lockdown)
+        _lockdown_due_us = 0;
+    else
+        _auto_close_due_us = 0;
+}
+
+EntryMatch_t SimDoor::match_entry(const string& keys, const string& new_password)
+{
+    if (!_entry_matcher)
+        return { keys == _password, keys == new_password };
+
+    pair<bool, bool> matches = _entry_matcher(keys);
+    return { matches.first, matches.second };
+}
+
+void SimDoor::on_transition(DoorState from, DoorInput input, DoorState to, int64_t time_us)
+{
+    if (_transition_observer)
+        _transition_observer(input, to, time_us);
+}
+
+void SimDoor::on_action_started(const Action_t& action, int64_t latency_us)
+{
+    if (action.type != ActionType::PlayAudio)
+        _last_motor_latency_us = latency_us;
+}
+
+/* Drains tsk_actuator's queue, then runs a sensor job the input started, like tsk_fp */
+void SimDoor::_settle()
+{
+    while (true)
+    {
+        while (!_actions.empty())
+        {
+            SimAction_t queued = _actions.front();
+            _actions.pop_front();
+
+            /* An idle actuator picks the action up as soon as it is queued */
+            if (_actuator_clock.now_us() < queued.queued_us)
+                _actuator_clock.advance_us(queued.queued_us - _actuator_clock.now_us());
+
+            _is_actuating = true;
+            _actuator.run(queued.action);
+            _is_actuating = false;
+        }
+
+        if (_is_search_pending)
+        {
+            _is_search_pending = false;
+            bool is_found = _search();
+
+            /* Like FingerprintSearched, the result is stamped when the search finishes */
+            _controller.on_fingerprint_searched(is_found, _clock.now_us());
+        }
+        else if (_is_enrollment_pending)
+        {
+            _is_enrollment_pending = false;
+            bool is_enrolled = _enroll();
+
+            _controller.on_enrollment_done(is_enrolled, _clock.now_us());
+        }
+        else
+            break;
+    }
+}
+
+/* Retries only while the sensor says no finger, any other error ends the capture */
+bool SimDoor::_capture()
+{
+    for (uint32_t i = 0; i < _capture_retry_cnt; ++i)
+    {
+        _reader.get_image();
+
+        if (_reader.get_last_error() == FINGERPRINT_OK)
+            return true;
+
+        if (_reader.get_last_error() != FINGERPRINT_NO_FINGER)
+            return false;
+    }
+
+    return false;
+}
+
+/* The search job of scan_fingerprint() */
+bool SimDoor::_search()
+{
+    if (!_capture())
+        return false;
+
+    _reader.image_to_template(1);
+
+    if (_reader.get_last_error() != FINGERPRINT_OK)
+        return false;
+
+    _reader.search(true);
+    return _reader.get_last_error() == FINGERPRINT_OK;
+}
+
+/* Two captures, one model, like FingerprintReaderHelper::enroll() */
+bool SimDoor::_enroll()
+{
+    bool is_enrolled = _capture();
+    _reader.image_to_template(1);
+    is_enrolled &= _reader.get_last_error() == FINGERPRINT_OK;
+
+    is_enrolled &= _capture();
+    _reader.image_to_template(2);
+    is_enrolled &= _reader.get_last_error() == FINGERPRINT_OK;
+
+    if (is_enrolled)
+    {
+        _reader.create_model();
+        is_enrolled = _reader.get_last_error() == FINGERPRINT_OK;
+    }
+
+    if (is_enrolled)
+    {
+        _reader.store_model(_reader.get_template_count() + 1);
+        is_enrolled = _reader.get_last_error() == FINGERPRINT_OK;
+    }
+
+    return is_enrolled;
+}
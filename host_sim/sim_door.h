@@ -0,0 +1,115 @@
+#ifndef _H_HOST_SIM_SIM_DOOR_H_
+#define _H_HOST_SIM_SIM_DOOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "door_controller.h"
+#include "fingerprint/reader.h"
+#include "hal/hal.h"
+#include "fake_devices.h"
+
+#define SIM_CAPTURE_RETRY_CNT   ( 5 )   /* The firmware waits on the sensor until it is canceled, the sim gives up */
+
+/*
+ * Single-threaded host for the firmware's DoorController and DoorActuator, the effects backed by fakes.
+ * Actions run right after the input that queued them, in queue order like tsk_actuator,
+ * but on their own clock: a 30 s siren does not hold up the reactor's timers.
+ * The fingerprint jobs run inline and report back before the next input.
+ */
+class SimDoor : public DoorEffects
+{
+public:
+    /* audio and motor advance actuator_clock, keypad and sensor advance clock */
+    SimDoor(SimClock& clock, SimClock& actuator_clock, KeypadMatrix& keypad, FingerprintReader& reader, AudioSink& audio, DoorMotor& motor);
+
+    /* Decides what a finished entry matched: password, then confirmation */
+    typedef std::function<std::pair<bool, bool>(const std::string& keys)> EntryMatcher;
+    typedef std::function<void(DoorInput input, DoorState to, int64_t time_us)> TransitionObserver;
+
+    void set_password(const std::string& password) { _password = password; }
+    void set_entry_matcher(EntryMatcher matcher) { _entry_matcher = matcher; }
+    void set_transition_observer(TransitionObserver observer) { _transition_observer = observer; }
+
+    /* The autoCloseTimeS and lockdownTimeS settings */
+    void set_timing(int64_t auto_close_ms, int64_t lockdown_ms) { _auto_close_ms = auto_close_ms; _lockdown_ms = lockdown_ms; }
+    void set_capture_retry_cnt(uint32_t cnt) { _capture_retry_cnt = cnt; }
+
+    /* Warm start, as restore_snapshot() leaves it */
+    void restore(DoorState state, uint8_t pwd_mismatch_cnt, uint8_t fingerprint_mismatch_cnt, bool is_door_open, int64_t lockdown_left_ms);
+
+    /* Input events, the GPIO interrupts on the device */
+    void on_key_activity();
+    void on_finger_touched();
+    void on_button(LockButton button);
+    void on_remote_command(DoorCommand command);
+
+    /* Fires auto-close and lockdown expiry when they are due */
+    void advance_to(int64_t time_us);
+
+    DoorState get_state() const { return _controller.get_fsm().get_state(); }
+
+    /* The reset button got through the debounce, the device wipes itself and restarts */
+    bool is_reset() const { return _is_reset; }
+
+    size_t get_tel_cnt() const { return _tel_cnt; }
+
+    /* Event to motor start of the last door movement */
+    int64_t get_last_motor_latency_us() const { return _last_motor_latency_us; }
+
+    void post_action(const Action_t& action) override;
+    uint32_t get_timeout_ms(DoorTimer timer) override;
+    void start_timer(DoorTimer timer, uint32_t timeout_ms) override;
+    void stop_timer(DoorTimer timer) override;
+    void push_tel(TelemetryMessageStatus status) override { ++_tel_cnt; }
+    EntryMatch_t match_entry(const std::string& keys, const std::string& new_password) override;
+    void save_password(const std::string& password) override { _password = password; }
+    void start_search(int64_t time_us) override { _is_search_pending = true; }
+    void start_enrollment() override { _is_enrollment_pending = true; }
+    void reset_system() override { _is_reset = true; }
+    void on_transition(DoorState from, DoorInput input, DoorState to, int64_t time_us) override;
+    void on_action_started(const Action_t& action, int64_t latency_us) override;
+
+private:
+    typedef struct SimAction_s
+    {
+        Action_t action;
+        int64_t queued_us;
+    } SimAction_t;
+
+    SimClock& _clock;
+    SimClock& _actuator_clock;
+    FingerprintReader& _reader;
+
+    DoorController _controller;
+    DoorActuator _actuator;
+    std::deque<SimAction_t> _actions;
+    bool _is_actuating = false;
+
+    std::string _password;
+    EntryMatcher _entry_matcher;
+    TransitionObserver _transition_observer;
+
+    int64_t _auto_close_ms = DEFAULT_AUTO_CLOSE_TIME_S * 1000LL;
+    int64_t _lockdown_ms = DEFAULT_LOCKDOWN_TIME_S * 1000LL;
+    uint32_t _capture_retry_cnt = SIM_CAPTURE_RETRY_CNT;
+
+    int64_t _auto_close_due_us = 0;
+    int64_t _lockdown_due_us = 0;
+    bool _is_search_pending = false;
+    bool _is_enrollment_pending = false;
+    bool _is_reset = false;
+
+    size_t _tel_cnt = 0;
+    int64_t _last_motor_latency_us = 0;
+
+    void _settle();
+    bool _capture();
+    bool _search();
+    bool _enroll();
+};
+
+#endif
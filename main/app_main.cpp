@@ -1,15 +1,19 @@
-#include <queue>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include <esp_log.h>
 #include <esp_pm.h>
+#include <esp_random.h>
 #include <esp_sleep.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
 #include <esp_wifi_types.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
 
 #include <driver/gpio.h>
 #include <driver/rtc_io.h>
@@ -22,13 +26,35 @@
 #include "defs.h"
 #include "config.h"
 #include "cancellationtokensource.h"
+#include "mem_policy.h"
+#include "reactor.h"
+#include "rtos_arena.h"
+#include "task_config.h"
+#include "radio_manager.h"
+#include "door_controller.h"
 #include "azure/dev_provisioning.h"
 #include "azure/iot_hub_provisioning.h"
 #include "azure/iot_hub_action.h"
+#include "azure/iot_hub_command.h"
+#include "azure/iot_hub_twin.h"
+#include "azure/reconnect_backoff.h"
 #include "fingerprint/reader.h"
 #include "fingerprint/helper.h"
+#include "hal/esp_hal.h"
+#include "hal/recording_port.h"
 #include "modules/keypad.h"
+#include "helper/deferred_log.h"
+#include "helper/diagnostics.h"
+#include "helper/event_recorder.h"
+#include "helper/hash.h"
+#include "helper/jitter_bench.h"
+#include "helper/nvs.h"
+#include "helper/power.h"
+#include "helper/settings.h"
 #include "helper/system.h"
+#include "helper/time_sync.h"
+#include "helper/trace.h"
+#include "helper/warm_start.h"
 #include "wifi/station.h"
 #include "audio/data/metadata.h"
 #include "modules/i2s_controller.h"
@@ -45,82 +71,224 @@ static const char* TAG = "app_main";
 /* Buttons */
 static const gpio_num_t BTN_GPIOS[] = { RESET_BTN_PORT, DOOR_SW_BTN_PORT, ENROLL_BTN_PORT };
 
+static_assert(sizeof(BTN_GPIOS) / sizeof(BTN_GPIOS[0]) == static_cast<size_t>(LockButton::Count), "BTN_GPIOS is indexed by LockButton");
+
 // ---------- Fingerprint Reader ---------- //
-static FingerprintReader fp_reader;
+static EspUartPort fp_uart;
+static RecordingSerialPort fp_port(fp_uart);
+static FingerprintReader fp_reader(&fp_port);
 static FingerprintReaderHelper fpr_helper;
 static SemaphoreHandle_t fp_reader_sem = nullptr;
+static QueueHandle_t fp_job_queue = nullptr;
 // ---------------------------------------- //
 
 static SemaphoreHandle_t sleep_sem = nullptr;
 static CancellationTokenSource main_cts;
-static CancellationToken* main_ct = main_cts.create_linked_token();
+static CancellationToken* main_ct = nullptr;
 
 /* ---------- I2S Controller ---------- */
 static I2SController i2s_controller = I2SController(i2s_gpio_cfg);
+static EspAudioSink audio_sink(i2s_controller);
 /* ------------------------------- */
 
+/* ---------- Motor Driver ---------- */
+static EspDoorMotor door_motor(MOTOR_DRIVER_PWR_TR_BASE_PORT, MOTOR_DRIVER_ENA_IN1_PORT, MOTOR_DRIVER_ENA_IN2_PORT);
+/* ---------------------------------- */
+
 /* ---------- Keypad ---------- */
-static string pressed_keys;
+static Keypad keypad(NUM_KEYPAD_ROWS, NUM_KEYPAD_COLS, KEYPAD_ROWS, KEYPAD_COLS, false);
+
+/* A row interrupt only says some key went down, the matrix is scanned once to find which */
+class ScannedKeypad : public KeypadMatrix
+{
+public:
+    char get_pressed_key() override;
+};
 /* ---------------------------- */
 
 // ---------- System ---------- //
 static nvs_handle_t sys_nvs_handle;
-static string password, new_password;
-static uint8_t pwd_validation_cnt = 0;
-static uint8_t pwd_mismatch_cnt = 0;
-static uint8_t fingerprint_mismatch_cnt = 0;
 
-static uint64_t last_opened_time = 0;
-static uint64_t last_closed_time = 0;
-static int activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
+/* Only the salted digest is kept in memory, it is also what a warm start restores */
+static uint8_t pin_salt[PIN_SALT_LEN];
+static uint8_t password_digest[PIN_DIGEST_LEN];
+static int64_t lockdown_deadline = 0;      /* get_mono_time_us() */
 
-static bool is_system_lockdown = false;
-static uint64_t last_lockdown_time = 0;
+static QueueHandle_t action_queue = nullptr;
 
-static SemaphoreHandle_t door_status_sem = xSemaphoreCreateMutex();
-
-static int last_key_pressed_time = get_time();
-
-static DoorStatus door_status = DoorStatus::Closed;
-static SystemStatus system_status = SystemStatus::None;
+static esp_timer_handle_t activity_timer = nullptr;
+static esp_timer_handle_t lockdown_timer = nullptr;
+static esp_timer_handle_t auto_close_timer = nullptr;
 // --------------------------------- //
 
+/* ---------- Door ---------- */
+/* Backs the door logic with the queues, timers and NVS of this file */
+class LockEffects : public DoorEffects
+{
+public:
+    void post_action(const Action_t& action) override;
+    uint32_t get_timeout_ms(DoorTimer timer) override;
+    void start_timer(DoorTimer timer, uint32_t timeout_ms) override;
+    void stop_timer(DoorTimer timer) override;
+    void push_tel(TelemetryMessageStatus status) override;
+    EntryMatch_t match_entry(const string& keys, const string& new_password) override;
+    void save_password(const string& password) override;
+    void start_search(int64_t time_us) override;
+    void start_enrollment() override;
+    void reset_system() override;
+
+    void on_activity() override;
+    void on_entry_started() override;
+    void on_key_scanned(char key, int64_t time_us) override;
+    void on_entry(const EntryMatch_t& match, int64_t time_us) override;
+    void on_transition(DoorState from, DoorInput input, DoorState to, int64_t time_us) override;
+    void on_action_started(const Action_t& action, int64_t latency_us) override;
+    void on_action_done(const Action_t& action) override;
+};
+
+static EspClock event_clock;
+static ScannedKeypad scanned_keypad;
+static LockEffects lock_effects;
+
+/* Door and auth logic, only stepped on the reactor */
+static DoorController door(event_clock, scanned_keypad, lock_effects);
+
+/* Owns the physical position, the status command and the snapshot read it from other tasks */
+static DoorActuator actuator(event_clock, door_motor, audio_sink, lock_effects);
+/* -------------------------- */
+
 /* -------------------- Telemetry -------------------- */
-static queue<TelemetryPayload_t> tel_payloads;
+static QueueHandle_t tel_queue = nullptr;
+
+/* Unsent telemetry survives deep sleep here, the radio may not have been up since it was queued */
+static RTC_DATA_ATTR TelemetryPayload_t rtc_outbox[RTC_OUTBOX_SIZE];
+static RTC_DATA_ATTR uint8_t rtc_outbox_len = 0;
 /* --------------------------------------------------- */
 
-/* System Initialization */
-void init_nvs()
+/* Decides whether a message is worth turning the radio on for */
+static TelPriority get_tel_priority(TelemetryMessageStatus status)
+{
+    switch (status)
+    {
+        case TelemetryMessageStatus::LockdownCausePasswordMismatch:
+        case TelemetryMessageStatus::LockdownCauseFingerprintMismatch:
+        case TelemetryMessageStatus::NotEnoughBattery:
+            return TelPriority::High;
+
+        case TelemetryMessageStatus::Opened:
+        case TelemetryMessageStatus::Closed:
+        case TelemetryMessageStatus::SystemBooted:
+            return TelPriority::Low;
+
+        default:
+            return TelPriority::Normal;
+    }
+}
+
+static void push_tel(TelemetryMessageStatus status)
 {
-    esp_err_t res = nvs_flash_init();
+    TelemetryPayload_t payload = { status };
+    payload.time_us = get_mono_time_us();
 
-    if (res == ESP_ERR_NVS_NO_FREE_PAGES || res == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    if (xQueueSend(tel_queue, &payload, 0) != pdTRUE)
     {
-        if ((res = nvs_flash_erase()) == ESP_OK)
-            ESP_ERROR_CHECK_WITHOUT_ABORT(nvs_flash_init());
+        ESP_LOGW(TAG, "Telemetry queue full, dropped: %u", static_cast<uint16_t>(status));
+        return;
     }
 
-    ESP_LOGI(TAG, "NVS flash initialized: %d", res);
+    notify_outbox(get_tel_priority(status));
 }
 
-static void init_vars()
+static size_t get_outbox_len()
 {
-    password.reserve(MAX_PWD_LEN);
-    new_password.reserve(MAX_PWD_LEN);
-    pressed_keys.reserve(MAX_PWD_LEN);
-    read_password();
+    return uxQueueMessagesWaiting(tel_queue);
+}
+
+static void save_outbox()
+{
+    rtc_outbox_len = 0;
+
+    while (rtc_outbox_len < RTC_OUTBOX_SIZE && xQueueReceive(tel_queue, &rtc_outbox[rtc_outbox_len], 0) == pdTRUE)
+        ++rtc_outbox_len;
+}
+
+static void restore_outbox()
+{
+    for (uint8_t i = 0; i < rtc_outbox_len && i < RTC_OUTBOX_SIZE; ++i)
+    {
+        if (xQueueSend(tel_queue, &rtc_outbox[i], 0) == pdTRUE)
+            notify_outbox(get_tel_priority(rtc_outbox[i].status));
+    }
+
+    rtc_outbox_len = 0;
+}
+/* --------------------------------------------------- */
+
+/* Timers */
+static esp_timer_handle_t create_event_timer(const char* name, EventType type)
+{
+    esp_timer_handle_t timer = nullptr;
+
+    esp_timer_create_args_t args = {
+        .callback = [](void* arg) { post_event(static_cast<EventType>(reinterpret_cast<uintptr_t>(arg))); },
+        .arg = reinterpret_cast<void*>(static_cast<uintptr_t>(type)),
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = name,
+        .skip_unhandled_events = true,
+    };
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_create(&args, &timer));
+    return timer;
+}
+
+static void restart_timer(esp_timer_handle_t timer, uint64_t timeout_ms)
+{
+    esp_timer_stop(timer);
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_start_once(timer, timeout_ms * 1000));
+}
+
+static void init_timers()
+{
+    activity_timer = create_event_timer("activity", EventType::ActivityTimeout);
+    lockdown_timer = create_event_timer("lockdown", EventType::LockdownExpired);
+    auto_close_timer = create_event_timer("auto_close", EventType::AutoCloseDue);
+}
+
+/* Pushes the deep sleep deadline out, replaces the 10 ms countdown loop */
+static void touch_activity()
+{
+    restart_timer(activity_timer, get_setting(Setting::ActivityRemTimeMs));
+}
+/* ------------------------------------------------------------ */
+
+/* System Initialization */
+static void init_vars(const WarmStart_t* snapshot)
+{
+    fp_job_queue = create_static_queue(Subsystem::Core, FP_JOB_QUEUE_SIZE, sizeof(FingerprintJob));
+    action_queue = create_static_queue(Subsystem::Core, ACTION_QUEUE_SIZE, sizeof(Action_t));
+    tel_queue = create_bulk_queue(Subsystem::Azure, AZURE_IOT_HUB_TEL_QUEUE_SIZE, sizeof(TelemetryPayload_t));
+
+    if (snapshot != nullptr)
+    {
+        memcpy(pin_salt, snapshot->pin_salt, sizeof(pin_salt));
+        memcpy(password_digest, snapshot->password_digest, sizeof(password_digest));
+    }
+    else
+        read_password();
 }
 /* ------------------------------------------------------------ */
 
 /* I2S Controller */
 static void enable_i2s_controller()
 {
+    acquire_power_lock(PowerLock::I2s);
     ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(I2S_CONTROLLER_PWR_TR_BASE, GPIO_LEVEL_LOW));
 }
 
 static void disable_i2s_controller()
 {
     ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(I2S_CONTROLLER_PWR_TR_BASE, GPIO_LEVEL_HIGH));
+    release_power_lock(PowerLock::I2s);
 }
 
 static void init_i2s_controller()
@@ -142,29 +310,91 @@ static void init_i2s_controller()
 }
 /* ------------------------------------------------------------ */
 
+/* GPIO Interrupts */
+
+/* arg packs the event type in the high byte and the gpio number in the low byte */
+static void IRAM_ATTR gpio_event_isr_handler(void* arg)
+{
+    uintptr_t packed = reinterpret_cast<uintptr_t>(arg);
+    gpio_num_t gpio = static_cast<gpio_num_t>(packed & 0xFF);
+    BaseType_t higher_prio_task_woken = pdFALSE;
+
+    /* Light sleep only wakes on levels, so each trigger re-arms for the opposite one and only the rising one is an event */
+    if (gpio_get_level(gpio))
+    {
+        gpio_wakeup_enable(gpio, GPIO_INTR_LOW_LEVEL);
+        post_event_from_isr(static_cast<EventType>(packed >> 8), gpio, &higher_prio_task_woken);
+    }
+    else
+        gpio_wakeup_enable(gpio, GPIO_INTR_HIGH_LEVEL);
+
+    portYIELD_FROM_ISR(higher_prio_task_woken);
+}
+
+/* Inputs leave the RTC mux so they can raise digital interrupts, enter_sleep_mode hands them back */
+static void init_event_gpio(gpio_num_t gpio, EventType type)
+{
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_dis(gpio));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_deinit(gpio));
+
+    gpio_config_t gpio_cfg = {
+        .pin_bit_mask = BIT64(gpio),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_HIGH_LEVEL,
+    };
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
+    enable_light_sleep_wakeup(gpio);
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_isr_handler_add(gpio, gpio_event_isr_handler,
+                                  reinterpret_cast<void*>((static_cast<uintptr_t>(type) << 8) | gpio)));
+}
+
+static void init_gpio_isr()
+{
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_install_isr_service(0));
+}
+/* ------------------------------------------------------------ */
+
 /* Keypad */
+static void set_keypad_cols(uint32_t level)
+{
+    for (uint8_t i = 0; i < NUM_KEYPAD_COLS; ++i)
+        ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(KEYPAD_COLS[i], level));
+}
+
+static void set_keypad_intr(bool enabled)
+{
+    for (uint8_t i = 0; i < NUM_KEYPAD_ROWS; ++i)
+        ESP_ERROR_CHECK_WITHOUT_ABORT(enabled ? gpio_intr_enable(KEYPAD_ROWS[i]) : gpio_intr_disable(KEYPAD_ROWS[i]));
+}
+
 static void init_keypad()
 {
     /* Set cols */
     for (uint8_t i = 0; i < NUM_KEYPAD_COLS; ++i)
     {
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(KEYPAD_COLS[i]));
         ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_dis(KEYPAD_COLS[i]));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(KEYPAD_COLS[i], RTC_GPIO_MODE_OUTPUT_ONLY));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pullup_dis(KEYPAD_COLS[i]));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_dis(KEYPAD_COLS[i]));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_level(KEYPAD_COLS[i], GPIO_LEVEL_LOW));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_deinit(KEYPAD_COLS[i]));
+
+        gpio_config_t gpio_cfg = {
+            .pin_bit_mask = BIT64(KEYPAD_COLS[i]),
+            .mode = GPIO_MODE_OUTPUT,
+            .pull_up_en = GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_DISABLE,
+        };
+
+        ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
     }
 
-    /* Set rows */
+    /* Set rows, any key press raises a row while the cols idle high */
     for (uint8_t i = 0; i < NUM_KEYPAD_ROWS; ++i)
-    {
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(KEYPAD_ROWS[i]));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_dis(KEYPAD_ROWS[i]));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(KEYPAD_ROWS[i], RTC_GPIO_MODE_INPUT_ONLY));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pullup_dis(KEYPAD_ROWS[i]));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_en(KEYPAD_ROWS[i]));
-    }
+        init_event_gpio(KEYPAD_ROWS[i], EventType::KeyActivity);
+
+    set_keypad_cols(GPIO_LEVEL_HIGH);
+    keypad.set_keymap((const char*)KEYPAD_MAP);
 }
 /* ------------------------------------------------------------ */
 
@@ -190,18 +420,16 @@ static void disable_pir_sens()
 static void init_pir_sens()
 {
     /* Set rx port */
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(PIR_SENSOR_RX_PORT));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(PIR_SENSOR_RX_PORT, RTC_GPIO_MODE_INPUT_ONLY));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pullup_dis(PIR_SENSOR_RX_PORT));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_en(PIR_SENSOR_RX_PORT));
+    init_event_gpio(PIR_SENSOR_RX_PORT, EventType::PresenceDetected);
     
     /* Set pwr port */
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(PIR_SENSOR_PWR_PORT));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_dis(PIR_SENSOR_PWR_PORT));
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(PIR_SENSOR_PWR_PORT, RTC_GPIO_MODE_OUTPUT_ONLY));
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pullup_dis(PIR_SENSOR_PWR_PORT));
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_dis(PIR_SENSOR_PWR_PORT));
     
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_level(PIR_SENSOR_PWR_PORT, GPIO_LEVEL_LOW));
+    enable_pir_sens();
 }
 /* ------------------------------------------------------------ */
 
@@ -231,10 +459,12 @@ static void init_fp_reader()
 
     ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
 
-    fp_reader.set_reader(FP_READER_UART_PORT, FP_READER_TX_PORT, FP_READER_RX_PORT, FP_READER_BAUD_RATE);
+    fp_uart.set_uart(FP_READER_UART_PORT, FP_READER_TX_PORT, FP_READER_RX_PORT, FP_READER_BAUD_RATE);
+    main_ct = main_cts.create_linked_token();
+    fp_uart.set_cancellation_token(main_ct);
     fpr_helper.cancellation_token = main_ct;
     fpr_helper.set_reader(&fp_reader);
-    fp_reader_sem = xSemaphoreCreateMutex();
+    fp_reader_sem = create_static_mutex(Subsystem::Fingerprint);
 
     enable_fp_reader();
 }
@@ -262,11 +492,7 @@ static void disable_fp_reader_touch_sens()
 static void init_fp_reader_touch_sens()
 {
     /* Set rx port */
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(FP_READER_TOUCH_RX_PORT));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_dis(FP_READER_TOUCH_RX_PORT));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(FP_READER_TOUCH_RX_PORT, RTC_GPIO_MODE_INPUT_ONLY));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pullup_dis(FP_READER_TOUCH_RX_PORT));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_dis(FP_READER_TOUCH_RX_PORT));
+    init_event_gpio(FP_READER_TOUCH_RX_PORT, EventType::FingerTouched);
     
     /* Set pwr port */
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(FP_READER_TOUCH_PWR_PORT));
@@ -284,672 +510,761 @@ static void init_fp_reader_touch_sens()
 static void init_btns()
 {
     for (const auto& btn_gpio: BTN_GPIOS)
-    {
-        /* RTC GPIO */
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(btn_gpio));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(btn_gpio, RTC_GPIO_MODE_INPUT_ONLY));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pullup_dis(btn_gpio));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_en(btn_gpio));
-
-        /* Non RTC GPIO */
-        // gpio_config_t gpio_cfg = {
-        //     .pin_bit_mask = BIT64(btn_gpio),
-        //     .mode = GPIO_MODE_INPUT,
-        //     .pull_up_en = GPIO_PULLUP_DISABLE,
-        //     .pull_down_en = GPIO_PULLDOWN_ENABLE,
-        //     .intr_type = GPIO_INTR_DISABLE,
-        // };
-
-        // ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
-    }
+        init_event_gpio(btn_gpio, EventType::ButtonPressed);
 }
 
 /* ------------------------------------------------------------ */
 
 /* Executable Initialization Tasks */
+/* Only waits and hands off, DPS and hub connects run on the azure-prv-* stacks */
 static void init_sys()
 {
-    const char* TASK_NAME = "tsk_init_sys";
-
-    auto task = [](void* pvParameters)
-    {
-        while (!is_connected())
-            vTaskDelay(pdMS_TO_TICKS(250));
-
-        while (!is_synced_time())
-        {
-            sync_time();
-            vTaskDelay(pdMS_TO_TICKS(2500));
-        }
-
-        last_opened_time += get_time();
-        last_closed_time += get_time();
-
-        vTaskDelete(NULL);
-    };
-
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);  
-}
-
-static void init_azure()
-{
-    const char* TASK_NAME = "tsk_init_azure";
-
     auto task = [](void* pvParameters)
     {
         while (!is_connected())
             vTaskDelay(pdMS_TO_TICKS(250));
 
-        while (!is_synced_time())
-            vTaskDelay(pdMS_TO_TICKS(2500));
+        /* A trusted wake leaves SNTP off, otherwise it runs in the background */
+        start_time_sync();
 
-        while (!is_dev_provisioned())
-        {
-            exec_dev_provisioning();
-            vTaskDelay(pdMS_TO_TICKS(INIT_AUZRE_DELAY));
-        }
+        /* SAS tokens and TLS need the wall clock, on a trusted wake this returns at once */
+        wait_time_trusted();
 
+        /* A cached DPS assignment is dropped when the hub rejects it, so DPS reruns from here */
         while (!is_iot_hub_provisioned())
         {
-            exec_iot_hub_provisioning();
+            if (!is_dev_provisioned())
+                exec_dev_provisioning();
+
+            if (is_dev_provisioned())
+                exec_iot_hub_provisioning();
+
             vTaskDelay(pdMS_TO_TICKS(INIT_AUZRE_DELAY));
         }
 
         vTaskDelete(NULL);
     };
 
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);  
+    create_task(TaskId::Init, task);
 }
 /* -------------------------------------------------- */
 
 /* Motor Driver */
-static void enable_motor_driver()
-{
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_PWR_TR_BASE_PORT, GPIO_LEVEL_LOW));
-}
-
-static void disable_motor_driver()
-{
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_PWR_TR_BASE_PORT, GPIO_LEVEL_HIGH));
-}
-
-static void rotate_to_right()
+static void init_motor_driver()
 {
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_ENA_IN1_PORT, GPIO_LEVEL_HIGH));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_ENA_IN2_PORT, GPIO_LEVEL_LOW));
+    door_motor.init();
 }
+/* ------------------------------------------------------------ */
 
-static void rotate_to_left()
+/* ---------- Actuator ---------- */
+static void actuate()
 {
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_ENA_IN1_PORT, GPIO_LEVEL_LOW));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_ENA_IN2_PORT, GPIO_LEVEL_HIGH));
-}
+    auto task = [](void* pvParameters)
+    {
+        Action_t action;
 
-static void stop_motor()
-{
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_ENA_IN1_PORT, GPIO_LEVEL_LOW));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(MOTOR_DRIVER_ENA_IN2_PORT, GPIO_LEVEL_LOW));
-}
+        while (true)
+        {
+            if (xQueueReceive(action_queue, &action, portMAX_DELAY) == pdTRUE)
+                actuator.run(action);
+        }
 
-static void init_motor_driver()
-{
-    /* Set pwr tr base */
-    gpio_config_t gpio_cfg = {
-        .pin_bit_mask = BIT64(MOTOR_DRIVER_PWR_TR_BASE_PORT),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
+        vTaskDelete(NULL);
     };
 
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
-
-    /* Set ena in1 */
-    gpio_cfg.pin_bit_mask = BIT64(MOTOR_DRIVER_ENA_IN1_PORT);
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
-
-    /* Set ena in2 */
-    gpio_cfg.pin_bit_mask = BIT64(MOTOR_DRIVER_ENA_IN2_PORT);
-    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
-
-    disable_motor_driver();
+    create_task(TaskId::Actuator, task);
 }
-/* ------------------------------------------------------------ */
+/* -------------------------------------------------- */
 
-static void open_door()
+/* ---------- Direct Methods ---------- */
+static uint32_t request_door(DoorCommand command, char* response, size_t response_len)
 {
-    if (xSemaphoreTake(door_status_sem, portMAX_DELAY) == pdTRUE)
+    /* A single byte read, the reactor still decides when the event arrives */
+    if (door.get_fsm().is_busy())
     {
-        if (door_status == DoorStatus::Closed)
-        {
-            TickType_t last_time = xTaskGetTickCount();
-
-            enable_motor_driver();
-            rotate_to_right();
-            vTaskDelayUntil(&last_time, pdMS_TO_TICKS(1000));
-            stop_motor();
-            disable_motor_driver();
-
-            i2s_controller.play(AudioName::Opened, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-            last_opened_time = get_time();
-            door_status = DoorStatus::Opened;
-            
-            tel_payloads.push({ TelemetryMessageStatus::Opened });
-        }
+        snprintf(response, response_len, "{\"error\":\"busy\"}");
+        return AZURE_IOT_HUB_CMD_STATUS_CONFLICT;
+    }
 
-        xSemaphoreGive(door_status_sem);
+    if (!post_event(EventType::DoorRequested, static_cast<uint32_t>(command)))
+    {
+        snprintf(response, response_len, "{\"error\":\"queue full\"}");
+        return AZURE_IOT_HUB_CMD_STATUS_UNAVAILABLE;
     }
 
+    snprintf(response, response_len, "{\"door\":\"%s\"}", command == DoorCommand::Open ? "opening" : "closing");
+    return AZURE_IOT_HUB_CMD_STATUS_ACCEPTED;
 }
 
-static void close_door()
+static void init_door_cmds()
 {
-    if (xSemaphoreTake(door_status_sem, portMAX_DELAY) == pdTRUE)
+    register_iot_hub_command(AZURE_IOT_HUB_CMD_UNLOCK, [](const uint8_t*, uint32_t, char* response, size_t response_len) -> uint32_t
     {
-        if (door_status == DoorStatus::Opened)
-        {
-            TickType_t last_time = xTaskGetTickCount();
-
-            enable_motor_driver();
-            rotate_to_left();
-            vTaskDelayUntil(&last_time, pdMS_TO_TICKS(1000));
-            stop_motor();
-            disable_motor_driver();
+        return request_door(DoorCommand::Open, response, response_len);
+    });
 
-            i2s_controller.play(AudioName::Closed, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-            last_closed_time = get_time();
-            door_status = DoorStatus::Closed;
+    register_iot_hub_command(AZURE_IOT_HUB_CMD_LOCK, [](const uint8_t*, uint32_t, char* response, size_t response_len) -> uint32_t
+    {
+        return request_door(DoorCommand::Close, response, response_len);
+    });
 
-            tel_payloads.push({ TelemetryMessageStatus::Closed });
-        }
+    register_iot_hub_command(AZURE_IOT_HUB_CMD_STATUS, [](const uint8_t*, uint32_t, char* response, size_t response_len) -> uint32_t
+    {
+        snprintf(response, response_len, "{\"door\":\"%s\",\"lockdown\":%s}",
+                 actuator.get_door_status() == DoorStatus::Opened ? "opened" : "closed",
+                 door.get_fsm().is_lockdown() ? "true" : "false");
+        return AZURE_IOT_HUB_CMD_STATUS_OK;
+    });
 
-        xSemaphoreGive(door_status_sem);
-    }
+    init_iot_hub_commands();
 }
 /* -------------------------------------------------- */
 
 /* ---------- System ---------- */
-static bool is_password_input_mode()
+static void reset_system()
 {
-    return door_status == DoorStatus::Closed && system_status == SystemStatus::None;
-}
+    /* Reset password */
+    write_password(DEFAULT_PASSWORD);
 
-static bool match_password()
-{
-    if (system_status == SystemStatus::None)
-        return password == pressed_keys;
+    /* Clear fingerprints */
+    fp_reader.clear_database();
 
-    return pwd_validation_cnt == 0 ? true : new_password == pressed_keys;
+    /* Notify resetting */
+    audio_sink.play(AudioName::Beep, 5);
+    flush_event_record();
+
+    /* Restart system */
+    esp_restart();
 }
 
-static bool is_fingerprint_search_mode()
+/* Hands an input back to the RTC mux so it can wake the chip from deep sleep */
+static void enable_rtc_wakeup(gpio_num_t gpio)
 {
-    return door_status == DoorStatus::Closed && system_status == SystemStatus::None;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(gpio));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(gpio, RTC_GPIO_MODE_INPUT_ONLY));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_pulldown_en(gpio));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_wakeup_enable(gpio, GPIO_INTR_HIGH_LEVEL));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(gpio));
 }
 
-static void play_siren()
+/* Warm Start */
+static void save_snapshot()
 {
-    i2s_controller.play(AudioName::Siren, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, 30);
+    WarmStart_t snapshot = { };
+    const DoorFsm& fsm = door.get_fsm();
+
+    snapshot.door_state = static_cast<uint8_t>(fsm.get_state());
+    snapshot.door_status = static_cast<uint8_t>(actuator.get_door_status());
+    snapshot.pwd_mismatch_cnt = fsm.get_pwd_mismatch_cnt();
+    snapshot.fingerprint_mismatch_cnt = fsm.get_fingerprint_mismatch_cnt();
+    snapshot.lockdown_deadline = fsm.is_lockdown() ? lockdown_deadline : 0;
+    memcpy(snapshot.pin_salt, pin_salt, sizeof(snapshot.pin_salt));
+    memcpy(snapshot.password_digest, password_digest, sizeof(snapshot.password_digest));
+
+    if (is_dev_provisioned())
+    {
+        strlcpy(snapshot.iot_hub_hostname, get_iot_hub_hostname(), sizeof(snapshot.iot_hub_hostname));
+        strlcpy(snapshot.iot_hub_dev_id, get_iot_hub_dev_id(), sizeof(snapshot.iot_hub_dev_id));
+    }
+
+    save_warm_start(snapshot);
 }
 
-static void reset_system()
+/* Where the replayer starts from: the restored state and the settings in effect */
+static void record_boot(bool is_warm_start)
 {
-    /* Reset password */
-    password = DEFAULT_PASSWORD;
-    write_password();
+    const DoorFsm& fsm = door.get_fsm();
+    int64_t now = get_mono_time_us();
+    uint16_t lockdown_left = fsm.is_lockdown() && lockdown_deadline > now ? static_cast<uint16_t>(min<int64_t>((lockdown_deadline - now) / 1000000, UINT16_MAX)) : 0;
+    uint16_t state = static_cast<uint16_t>(fsm.get_state()) | fsm.get_pwd_mismatch_cnt() << 4 | fsm.get_fingerprint_mismatch_cnt() << 8 | static_cast<uint16_t>(actuator.get_door_status()) << 12;
 
-    /* Clear fingerprints */
-    fp_reader.clear_database();
-
-    /* Notify resetting */
-    i2s_controller.play(AudioName::Beep, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, 5);
+    record_event(RecordedInput::Boot, is_warm_start, state, lockdown_left);
 
-    /* Restart system */
-    esp_restart();
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Setting::Count); ++i)
+    {
+        uint32_t value = get_setting(static_cast<Setting>(i));
+        record_event(RecordedInput::SettingApplied, i, static_cast<uint16_t>(value & 0xFFFF), static_cast<uint16_t>(value >> 16));
+    }
 }
 
+/* Runs before any task starts, so the FSM and timers are touched from here only once */
+static void restore_snapshot(const WarmStart_t& snapshot)
+{
+    int64_t now = get_mono_time_us();
+    int64_t lockdown_left_ms = snapshot.lockdown_deadline > now ? (snapshot.lockdown_deadline - now + 999) / 1000 : 0;
+    DoorStatus door_status = static_cast<DoorStatus>(snapshot.door_status);
+
+    actuator.restore(door_status);
+    door.restore(static_cast<DoorState>(snapshot.door_state), snapshot.pwd_mismatch_cnt, snapshot.fingerprint_mismatch_cnt, door_status, lockdown_left_ms);
+
+    restore_dev_provisioning(snapshot.iot_hub_hostname, snapshot.iot_hub_dev_id);
+}
+/* ---------------------------- */
 
 static void enter_sleep_mode()
 {
+    /* Aborts a capture still waiting on the sensor instead of sitting out its UART timeout */
+    disable_fp_reader();
+
     /* Buttons */
     for (const auto& btn_gpio: BTN_GPIOS)
-    {
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_wakeup_enable(btn_gpio, GPIO_INTR_HIGH_LEVEL));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(btn_gpio));
-    }
+        enable_rtc_wakeup(btn_gpio);
 
     /* Keypad */
     for (uint8_t i = 0; i < NUM_KEYPAD_COLS; ++i)
     {
+        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_init(KEYPAD_COLS[i]));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_direction(KEYPAD_COLS[i], RTC_GPIO_MODE_OUTPUT_ONLY));
         ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_level(KEYPAD_COLS[i], GPIO_LEVEL_HIGH));
         ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(KEYPAD_COLS[i]));
     }
 
     for (uint8_t i = 0; i < NUM_KEYPAD_ROWS; ++i)
-    {
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_wakeup_enable(KEYPAD_ROWS[i], GPIO_INTR_HIGH_LEVEL));
-        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(KEYPAD_ROWS[i]));
-    }
+        enable_rtc_wakeup(KEYPAD_ROWS[i]);
 
     /* Fingerprint Reader */
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_level(FP_READER_TOUCH_PWR_PORT, GPIO_LEVEL_HIGH));
     ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(FP_READER_TOUCH_PWR_PORT));
 
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_wakeup_enable(FP_READER_TOUCH_RX_PORT, GPIO_INTR_HIGH_LEVEL));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(FP_READER_TOUCH_RX_PORT));
+    enable_rtc_wakeup(FP_READER_TOUCH_RX_PORT);
 
     /* PIR Sensor */
-    // ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_level(PIR_SENSOR_PWR_PORT, GPIO_LEVEL_HIGH));
-    // ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(PIR_SENSOR_PWR_PORT));
+    if (PIR_SENSOR_ENABLED)
+    {
+        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_set_level(PIR_SENSOR_PWR_PORT, GPIO_LEVEL_HIGH));
+        ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(PIR_SENSOR_PWR_PORT));
 
-    // ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_wakeup_enable(PIR_SENSOR_RX_PORT, GPIO_INTR_HIGH_LEVEL));
-    // ESP_ERROR_CHECK_WITHOUT_ABORT(rtc_gpio_hold_en(PIR_SENSOR_RX_PORT));
+        enable_rtc_wakeup(PIR_SENSOR_RX_PORT);
+    }
     
     /* Deep Sleep */
+    TRACE(SleepEntered, 0);
+    dump_trace();
+    flush_deferred_log();
+    flush_event_record();
+    save_snapshot();
+    save_outbox();
+    suspend_time_sync();
     ESP_ERROR_CHECK_WITHOUT_ABORT(esp_sleep_enable_gpio_wakeup());
 
+    /* Wake for the next cloud sync even if nobody touches the lock */
+    uint64_t sync_due_in_s = max<uint64_t>(get_radio_sync_due_in_s(), RADIO_MIN_SLEEP_WAKEUP_S);
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_sleep_enable_timer_wakeup(sync_due_in_s * 1000 * 1000));
+
     ESP_LOGI(TAG, "Entering sleep mode");
     esp_deep_sleep_start();
 }
 
-static void update_status()
+/* Generated once per device, so a digest lifted from RTC memory cannot be matched against a precomputed table */
+static void read_pin_salt()
 {
-    const char* TASK_NAME = "tsk_upd_status";
-
-    auto task = [](void* pvParameters)
-    {
-        while (true)
-        {
-            if (activity_rem_time <= 0)
-                enter_sleep_mode();
-
-            if (is_system_lockdown)
-            {
-                if (get_time() - last_lockdown_time >= 30)
-                    is_system_lockdown = false;
-            }
+    if (read_nvs_blob(NVS_KEY_PIN_SALT, pin_salt, sizeof(pin_salt)))
+        return;
 
-            if (door_status == DoorStatus::Opened && system_status == SystemStatus::None && get_time() - last_opened_time >= 5)
-                close_door();
-
-            vTaskDelay(pdMS_TO_TICKS(10));
-            activity_rem_time -= 10;
-        }
-    };
-
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);  
+    esp_fill_random(pin_salt, sizeof(pin_salt));
+    write_nvs_blob(NVS_KEY_PIN_SALT, pin_salt, sizeof(pin_salt));
 }
 
 static void read_password()
 {
-    size_t num_read_bytes = 0;
+    char pwd[MAX_PWD_LEN + 1] = { 0 };
+    size_t pwd_len = sizeof(pwd);
 
-    ESP_ERROR_CHECK_WITHOUT_ABORT(nvs_open(NVS_DEFAULT_PART_NAME, NVS_READWRITE, &sys_nvs_handle));
-    ESP_ERROR_CHECK_WITHOUT_ABORT(nvs_get_str(sys_nvs_handle, NVS_KEY_PASSWORD, const_cast<char*>(password.c_str()), &num_read_bytes));
+    read_pin_salt();
+    hash_pin(pin_salt, DEFAULT_PASSWORD, password_digest);
 
-    if (password.size() == 0)
-        password = DEFAULT_PASSWORD;
+    if (nvs_open(NVS_DEFAULT_PART_NAME, NVS_READONLY, &sys_nvs_handle) != ESP_OK)
+        return;
+
+    if (nvs_get_str(sys_nvs_handle, NVS_KEY_PASSWORD, pwd, &pwd_len) == ESP_OK && pwd[0] != 0)
+        hash_pin(pin_salt, pwd, password_digest);
+
+    nvs_close(sys_nvs_handle);
 }
 
-static void write_password()
+static void write_password(const char* pwd)
 {
-    ESP_ERROR_CHECK_WITHOUT_ABORT(nvs_set_str(sys_nvs_handle, NVS_KEY_PASSWORD, password.c_str()));
+    hash_pin(pin_salt, pwd, password_digest);
+
+    if (nvs_open(NVS_DEFAULT_PART_NAME, NVS_READWRITE, &sys_nvs_handle) != ESP_OK)
+        return;
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(nvs_set_str(sys_nvs_handle, NVS_KEY_PASSWORD, pwd));
     ESP_ERROR_CHECK_WITHOUT_ABORT(nvs_commit(sys_nvs_handle));
     nvs_close(sys_nvs_handle);
 }
 
 /* ---------------------------- */
 
-static void scan_btns()
+/* ---------- Door State Machine ---------- */
+static void push_fp_job(FingerprintJob job)
 {
-    const char* TASK_NAME = "tsk_scan_btns";
-
-    auto task = [](void* pvParameters)
-    {
-        while (true)
-        {
-            bool door_btn_status = static_cast<bool>(rtc_gpio_get_level(DOOR_SW_BTN_PORT));
+    if (xQueueSend(fp_job_queue, &job, 0) != pdTRUE)
+        ESP_LOGW(TAG, "Fingerprint job dropped: %d", static_cast<int>(job));
+}
 
-            if (door_btn_status)
-            {
-                activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
+void LockEffects::post_action(const Action_t& action)
+{
+    if (xQueueSend(action_queue, &action, 0) != pdTRUE)
+        ESP_LOGW(TAG, "Action dropped: %d", static_cast<int>(action.type));
+}
 
-                pwd_mismatch_cnt = 0;
-                fingerprint_mismatch_cnt = 0;
+uint32_t LockEffects::get_timeout_ms(DoorTimer timer)
+{
+    return (timer == DoorTimer::Lockdown ? get_setting(Setting::LockdownTimeS) : get_setting(Setting::AutoCloseTimeS)) * 1000;
+}
 
-                if (door_status == DoorStatus::Closed)
-                    open_door();
-                else
-                    close_door();
-            }
+/* The lockdown deadline is kept in the mono clock, the snapshot carries it across deep sleep */
+void LockEffects::start_timer(DoorTimer timer, uint32_t timeout_ms)
+{
+    if (timer == DoorTimer::Lockdown)
+        lockdown_deadline = get_mono_time_us() + timeout_ms * 1000LL;
 
-            bool reset_btn_status = static_cast<bool>(rtc_gpio_get_level(RESET_BTN_PORT));
+    restart_timer(timer == DoorTimer::Lockdown ? lockdown_timer : auto_close_timer, timeout_ms);
+}
 
-            if (reset_btn_status)
-            {
-                activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
-                reset_system();
-            }
+void LockEffects::stop_timer(DoorTimer timer)
+{
+    esp_timer_stop(timer == DoorTimer::Lockdown ? lockdown_timer : auto_close_timer);
+}
 
-            bool enroll_btn_status = static_cast<bool>(rtc_gpio_get_level(ENROLL_BTN_PORT));
+void LockEffects::push_tel(TelemetryMessageStatus status)
+{
+    ::push_tel(status);
+}
 
-            if (enroll_btn_status)
-            {
-                activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
-                is_system_lockdown = false;
-                system_status = SystemStatus::RequestFingerprintEnrollmentMode;
-            }
+EntryMatch_t LockEffects::match_entry(const string& keys, const string& new_password)
+{
+    uint8_t digest[PIN_DIGEST_LEN];
 
-            vTaskDelay(pdMS_TO_TICKS(100));
-        }
-    };
+    hash_pin(pin_salt, keys.c_str(), digest);
 
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);  
+    return { is_same_pin_digest(digest, password_digest), keys == new_password };
 }
 
-static bool flush_password()
+void LockEffects::save_password(const string& password)
 {
-    if (match_password())
-    {
-        pwd_mismatch_cnt = 0;
-        fingerprint_mismatch_cnt = 0;
-
-        if (system_status == SystemStatus::PasswordChangeMode)
-        {
-            i2s_controller.play(AudioName::Beep, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, 3);
-            if (pwd_validation_cnt++ == 0)
-            {
-                new_password = pressed_keys;
-                return true;
-            }
-
-            if (pwd_validation_cnt++ >= 2)
-            {
-                pwd_validation_cnt = 0;
-                password = new_password;
-                write_password();
-                system_status = SystemStatus::PasswordChanged;
-                i2s_controller.play(AudioName::Enrolled, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-                tel_payloads.push({ TelemetryMessageStatus::PasswordChanged });
-            }
+    write_password(password.c_str());
+}
 
-            return true;
-        }
+void LockEffects::start_search(int64_t time_us)
+{
+    TRACE_AT(FingerTouched, 0, time_us);
+    prewarm_radio();
+    push_fp_job(FingerprintJob::Search);
+}
 
-        return true;
-    }
+void LockEffects::start_enrollment()
+{
+    push_fp_job(FingerprintJob::Enroll);
+}
 
-    if (door_status == DoorStatus::Closed && system_status == SystemStatus::None)
-    {
-        if (++pwd_mismatch_cnt >= MAX_ALLOWED_PWD_MISMATCH_CNT)
-        {
-            is_system_lockdown = true;
-            last_lockdown_time = get_time();
-            pwd_mismatch_cnt = 0;
-            fingerprint_mismatch_cnt = 0;
-            play_siren();
-            tel_payloads.push({ TelemetryMessageStatus::LockdownCausePasswordMismatch });
-            return false;
-        }
-    }
+void LockEffects::reset_system()
+{
+    ::reset_system();
+}
 
-    tel_payloads.push({ TelemetryMessageStatus::PasswordMismatch });
-    return false;
+void LockEffects::on_activity()
+{
+    touch_activity();
 }
 
-static void flush_keys(char key)
+/* First digit of an entry, the link comes up while the rest is typed */
+void LockEffects::on_entry_started()
 {
-    if (true)
-    {
-        if (key == '*' && door_status == DoorStatus::Opened && system_status == SystemStatus::None)
-        {
-            close_door();
-            return;
-        }
+    prewarm_radio();
+}
 
-        if (key == '#' && door_status == DoorStatus::Opened && system_status == SystemStatus::None)
-            return;
-        
-        if (flush_password())
-        {
-            if (system_status == SystemStatus::PasswordChanged)
-                system_status = SystemStatus::None;
-            else
-            {
-                if (key == '*' && door_status == DoorStatus::Closed && system_status == SystemStatus::None)
-                    open_door();
-                else if (key == '#')
-                {
-                    system_status = SystemStatus::PasswordChangeMode;
-                    i2s_controller.play(AudioName::Beep, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, 2);
-                }
-            }
-        }
-        else
-            i2s_controller.play(AudioName::RepeatAgain, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-    }
+void LockEffects::on_key_scanned(char key, int64_t time_us)
+{
+    TRACE_AT(KeyPressed, key, time_us);
+    record_event(RecordedInput::KeyScanned, 0, key >= '0' && key <= '9' ? '0' : key, 0, time_us);
+    DLOGD(KEYPAD, TAG, "Key: %c", key);
+}
 
-    pressed_keys.clear();
+/* The replayer never sees the digits, only what they matched */
+void LockEffects::on_entry(const EntryMatch_t& match, int64_t time_us)
+{
+    record_event(RecordedInput::EntryResult, 0, match.password | match.confirmation << 1, 0, time_us);
 }
 
-static void scan_keys()
+void LockEffects::on_transition(DoorState from, DoorInput input, DoorState to, int64_t time_us)
 {
-    const char* TASK_NAME = "tsk_scan_keys";
+    ESP_LOGI(TAG, "FSM: %d --(%d)--> %d", static_cast<int>(from), static_cast<int>(input), static_cast<int>(to));
+    TRACE(FsmTransition, static_cast<uint16_t>(static_cast<uint8_t>(input) << 8 | static_cast<uint8_t>(to)));
+    record_event(RecordedInput::FsmTransition, static_cast<uint8_t>(input), static_cast<uint16_t>(to), 0, time_us);
+}
 
-    auto task = [](void* pvParameters)
+/* Runs on the actuator */
+void LockEffects::on_action_started(const Action_t& action, int64_t latency_us)
+{
+    if (action.type == ActionType::PlayAudio)
     {
-        Keypad keypad(NUM_KEYPAD_ROWS, NUM_KEYPAD_COLS, KEYPAD_ROWS, KEYPAD_COLS, true);
-        keypad.set_keymap((const char*)KEYPAD_MAP);
-
-        while (true)
-        {
-            char key = keypad.get_pressed_key();
+#if JITTER_BENCH_ENABLED
+        if (action.time_us != 0)
+            record_jitter_sample(latency_us, action.time_us);
+#endif
 
-            if (is_system_lockdown || key == '\0')
-            {
-                vTaskDelay(pdMS_TO_TICKS(10));
-                continue;
-            }
+        TRACE(AudioStart, static_cast<uint16_t>(action.audio));
+        return;
+    }
 
-            activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
-            ESP_LOGI(TAG, "Key: %c", key);
+    if (latency_us > AZURE_IOT_HUB_CMD_TO_MOTOR_TARGET_US)
+        ESP_LOGW(TAG, "Event to motor latency: %lld us (target %u us)", latency_us, AZURE_IOT_HUB_CMD_TO_MOTOR_TARGET_US);
+    else
+        ESP_LOGI(TAG, "Event to motor latency: %lld us", latency_us);
 
-            if (key >= '0' && key <= '9')
-            {
-                if (door_status == DoorStatus::Opened && system_status == SystemStatus::None)
-                    continue;
+    TRACE(MotorStart, action.type == ActionType::OpenDoor);
+}
 
-                if (pressed_keys.size() == MAX_PWD_LEN)
-                    continue;
+void LockEffects::on_action_done(const Action_t& action)
+{
+    if (action.type == ActionType::PlayAudio)
+        TRACE(AudioDone, static_cast<uint16_t>(action.audio));
+    else
+        TRACE(MotorDone, action.type == ActionType::OpenDoor);
+}
+/* ---------------------------------------- */
 
-                pressed_keys.push_back(key);
-            }
+static void on_btn_pressed(const Event_t& event)
+{
+    for (size_t i = 0; i < sizeof(BTN_GPIOS) / sizeof(BTN_GPIOS[0]); ++i)
+    {
+        if (BTN_GPIOS[i] == static_cast<gpio_num_t>(event.arg))
+            door.on_button(static_cast<LockButton>(i), event.time_us);
+    }
+}
 
-            i2s_controller.play(AudioName::Beep, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
+char ScannedKeypad::get_pressed_key()
+{
+    set_keypad_intr(false);
+    set_keypad_cols(GPIO_LEVEL_LOW);
 
-            if (key == '*' || key == '#') 
-                flush_keys(key);
-        }
+    char key = keypad.get_pressed_key();
 
-        vTaskDelete(NULL);  
-    };
+    set_keypad_cols(GPIO_LEVEL_HIGH);
+    set_keypad_intr(true);
 
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);  
+    return key;
 }
 
+/* Search and enrollment wait on the sensor for seconds, they run here and report back as events */
 static void scan_fingerprint()
 {
-    const char* TASK_NAME = "tsk_scan_fp";
-
     auto task = [](void* pvParameters)
     {
+        FingerprintJob job;
+
         while (true)
         {
-            vTaskDelay(pdMS_TO_TICKS(FP_SCAN_DELAY));
-
-            if (is_system_lockdown)
+            if (xQueueReceive(fp_job_queue, &job, portMAX_DELAY) != pdTRUE)
                 continue;
 
-            if (system_status == SystemStatus::RequestFingerprintEnrollmentMode)
+            /* UART rx is lost in light sleep, stay awake for the whole exchange */
+            acquire_power_lock(PowerLock::Uart);
+            enable_fp_reader();
+
+            if (job == FingerprintJob::Enroll)
             {
-                activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
-                enable_fp_reader();
-                system_status = SystemStatus::FingerprintEnrollmentMode;
-                i2s_controller.play(AudioName::Beep, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, 3);
                 fpr_helper.enroll(fp_reader.get_template_count() + 1);
-            }
 
-            if (system_status == SystemStatus::FingerprintEnrollmentMode)
-            {
                 auto last_enrollment_status = fpr_helper.get_last_enrollment_status();
-                activity_rem_time = DEFAULT_ACTIVITY_REM_TIME;
 
-                if (last_enrollment_status == FingerprintReaderHelper::EVENT_BITS_ENROLLING || last_enrollment_status == FingerprintReaderHelper::EVENT_BITS_ENROLLMENT_RESERVED)
-                    continue;
-                else if (last_enrollment_status == FingerprintReaderHelper::EVENT_BITS_ENROLLED)
+                while (last_enrollment_status == FingerprintReaderHelper::EVENT_BITS_ENROLLING || last_enrollment_status == FingerprintReaderHelper::EVENT_BITS_ENROLLMENT_RESERVED)
                 {
-                    tel_payloads.push({ TelemetryMessageStatus::FingerprintEnrolled });
-                    i2s_controller.play(AudioName::Enrolled, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
+                    vTaskDelay(pdMS_TO_TICKS(get_setting(Setting::FpScanDelayMs)));
+                    last_enrollment_status = fpr_helper.get_last_enrollment_status();
                 }
-                else if (last_enrollment_status == FingerprintReaderHelper::EVENT_BITS_ENROLLMENT_FAILED)
-                {
-                    tel_payloads.push({ TelemetryMessageStatus::FingerprintEnrollmentFailed });
-                    i2s_controller.play(AudioName::EnrollmentFailed, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-                }
-
-                system_status = SystemStatus::None;
-            }
 
-            if (!is_fingerprint_search_mode())
+                release_power_lock(PowerLock::Uart);
+                post_event(EventType::EnrollmentDone, last_enrollment_status);
                 continue;
-
-            if (!static_cast<bool>(rtc_gpio_get_level(FP_READER_TOUCH_RX_PORT)))
-                continue;
-
-            enable_fp_reader();
+            }
 
             if (xSemaphoreTake(fp_reader_sem, portMAX_DELAY) == pdTRUE)
             {
                 pair<uint16_t, uint16_t> res = fpr_helper.search(true);
-
-                if (res.first == 0 && res.second == 0)
-                {
-                    tel_payloads.push({ TelemetryMessageStatus::FingerprintMismatch });
-
-                    if (++fingerprint_mismatch_cnt >= MAX_ALLOWED_PWD_MISMATCH_CNT)
-                    {
-                        is_system_lockdown = true;
-                        last_lockdown_time = get_time();
-                        fingerprint_mismatch_cnt = 0;
-                        pwd_mismatch_cnt = 0;
-                        play_siren();
-                        tel_payloads.push({ TelemetryMessageStatus::LockdownCauseFingerprintMismatch });
-                    }
-                    else
-                        i2s_controller.play(AudioName::RepeatAgain, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-                }
-                else
-                {
-                    pwd_mismatch_cnt = 0;
-                    fingerprint_mismatch_cnt = 0;
-                    open_door();
-                }
-
                 xSemaphoreGive(fp_reader_sem);
+
+                post_event(EventType::FingerprintSearched, !(res.first == 0 && res.second == 0));
             }
+
+            release_power_lock(PowerLock::Uart);
         }
 
         vTaskDelete(NULL);  
     };
 
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);  
+    create_task(TaskId::ScanFingerprint, task);
+}
+
+/* Raw inputs before any debouncing or state checks, what host_sim/replay_door.cpp feeds back in */
+static void record_input(const Event_t& event)
+{
+    switch (event.type)
+    {
+        case EventType::ButtonPressed:
+            for (uint8_t i = 0; i < sizeof(BTN_GPIOS) / sizeof(BTN_GPIOS[0]); ++i)
+            {
+                if (BTN_GPIOS[i] == static_cast<gpio_num_t>(event.arg))
+                    record_event(RecordedInput::ButtonEdge, i, 0, 0, event.time_us);
+            }
+            break;
+
+        case EventType::KeyActivity:
+            record_event(RecordedInput::KeyEdge, 0, 0, 0, event.time_us);
+            break;
+
+        case EventType::FingerTouched:
+            record_event(RecordedInput::FingerTouched, 0, 0, 0, event.time_us);
+            break;
+
+        case EventType::PresenceDetected:
+            record_event(RecordedInput::PresenceDetected, 0, 0, 0, event.time_us);
+            break;
+
+        case EventType::DoorRequested:
+            record_event(RecordedInput::RemoteDoor, 0, static_cast<uint16_t>(event.arg), 0, event.time_us);
+            break;
+
+        default:
+            break;
+    }
 }
 
-static void send_tels()
+static void handle_event(const Event_t& event)
 {
-    const char* TASK_NAME = "tsk_send_tels";
+    record_input(event);
 
-    auto task = [](void* pvParameters)
+    switch (event.type)
     {
-        char tel_msg[AZURE_IOT_HUB_TEL_BUF_LEN] = { 0 };
+        case EventType::ButtonPressed:
+            on_btn_pressed(event);
+            break;
+
+        case EventType::KeyActivity:
+            door.on_key_activity(event.time_us);
+            break;
+
+        case EventType::FingerTouched:
+            door.on_finger_touched(event.time_us);
+            break;
+
+        case EventType::PresenceDetected:
+            touch_activity();
+            prewarm_radio();
+            break;
+
+        case EventType::FingerprintSearched:
+            door.on_fingerprint_searched(event.arg != 0, event.time_us);
+            break;
+
+        case EventType::EnrollmentDone:
+            door.on_enrollment_done(event.arg == FingerprintReaderHelper::EVENT_BITS_ENROLLED, event.time_us);
+            break;
+
+        case EventType::ActivityTimeout:
+            enter_sleep_mode();
+            break;
+
+        case EventType::LockdownExpired:
+            door.on_timer(DoorTimer::Lockdown, event.time_us);
+            break;
+
+        case EventType::AutoCloseDue:
+            door.on_timer(DoorTimer::AutoClose, event.time_us);
+            break;
+
+        case EventType::DoorRequested:
+            door.on_remote_command(static_cast<DoorCommand>(event.arg), event.time_us);
+            break;
+
+#if JITTER_BENCH_ENABLED
+        case EventType::KeyInjected:
+            touch_activity();
+            lock_effects.post_action({ ActionType::PlayAudio, AudioName::Beep, 1, event.time_us });
+            break;
+#endif
+    }
+}
 
-        while (true)
-        {
-            vTaskDelay(pdMS_TO_TICKS(SEND_TEL_DELAY));
+/* Telemetry is flushed in batches from the network task, one radio wake per SendTelDelayMs */
+static void flush_tels()
+{
+    static int64_t last_flush_time = 0;
+    char tel_msg[AZURE_IOT_HUB_TEL_BUF_LEN] = { 0 };
+    TelemetryPayload_t payload;
 
-            if (!is_dev_provisioned() || !is_iot_hub_provisioned())
-                continue; 
+    if (esp_timer_get_time() - last_flush_time < get_setting(Setting::SendTelDelayMs) * 1000LL)
+        return;
 
-            if (tel_payloads.empty())
-                continue;
+    last_flush_time = esp_timer_get_time();
+
+    /* Payloads stay queued while the supervisor brings the link back */
+    while (is_iot_hub_connected() && xQueuePeek(tel_queue, &payload, 0) == pdTRUE)
+    {
+        fill(tel_msg, tel_msg + AZURE_IOT_HUB_TEL_BUF_LEN, 0);
+        snprintf(tel_msg, AZURE_IOT_HUB_TEL_BUF_LEN, AZURE_IOT_HUB_TEL_FORMAT, static_cast<uint8_t>(payload.status), payload.desc, to_wall_time(payload.time_us));
+        TelemetryTicket_t ticket = send_tel(tel_msg, false, false);
 
-            auto payload = tel_payloads.front();
-            tel_payloads.pop();
+        if (ticket.status == TelemetryStatus::HubError)
+            break;
+
+        xQueueReceive(tel_queue, &payload, 0);
+        del_tel_ticket(ticket.pub_id);
+        record_event(RecordedInput::TelemetrySent, static_cast<uint8_t>(ticket.status), static_cast<uint16_t>(ticket.pub_id));
             
-            fill(tel_msg, tel_msg + AZURE_IOT_HUB_TEL_BUF_LEN, 0);
-            snprintf(tel_msg, AZURE_IOT_HUB_TEL_BUF_LEN, AZURE_IOT_HUB_TEL_FORMAT, static_cast<uint8_t>(payload.status), payload.desc);
-            TelemetryTicket_t ticket = send_tel(tel_msg, false, false);
-            del_tel_ticket(ticket.pub_id);
-                
-            ESP_LOGI(TAG, "Telemetry sent: %u", ticket.pub_id);
-            ESP_LOGI(TAG, "Telemetry: %s", tel_msg);
-        }
+        DLOGI(TEL, TAG, "Telemetry sent: %u, status: %d", ticket.pub_id, payload.status);
+    }
+}
 
-        vTaskDelete(NULL);  
-    };
+/* Diagnostics ride the same radio window as telemetry, at most once per DIAG_REPORT_INTERVAL_S */
+static void flush_diagnostics()
+{
+    static char diag_msg[DIAG_TEL_BUF_LEN] = { 0 };
+
+    if (!is_iot_hub_connected() || !is_diag_report_due() || !build_diag_report(diag_msg, DIAG_TEL_BUF_LEN))
+        return;
+
+    TelemetryTicket_t ticket = send_tel(diag_msg, false, false);
+
+    if (ticket.status == TelemetryStatus::HubError)
+        return;
 
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+    del_tel_ticket(ticket.pub_id);
+    mark_diag_reported();
+
+    ESP_LOGI(TAG, "Diagnostics sent: %u", ticket.pub_id);
 }
 
+/* Also supervises the hub connection, a failed process loop or publish drops it to Disconnected */
 static void azure_loop()
 {
-    const char* TASK_NAME = "tsk_az_loop";
-
     auto task = [](void* pvParameters)
     {
         while (true)
         {
-            vTaskDelay(pdMS_TO_TICKS(RECV_CMDS_DELAY));
-
             if (!is_dev_provisioned() || !is_iot_hub_provisioned())
+            {
+                vTaskDelay(pdMS_TO_TICKS(RECV_CMDS_DELAY));
+
+                /* A hub rejection on reconnect drops both, tsk_init has finished by then so provisioning reruns here */
+                if (is_connected() && is_time_trusted() && is_task_slot_free(TaskId::Init))
+                {
+                    if (!is_dev_provisioned())
+                        exec_dev_provisioning();
+                    else
+                        exec_iot_hub_provisioning();
+                }
+
+                continue;
+            }
+
+            if (!is_iot_hub_connected())
+            {
+                vTaskDelay(pdMS_TO_TICKS(RECV_CMDS_DELAY));
+
+                if (!is_connected())
+                    continue;
+
+                uint32_t backoff_delay_ms = AZURE_IOT_RETRY_MAX_BACKOFF_DELAY_MS;
+
+                /* The only backoff on this path, reconnect_iot_hub() tries once and has released the client lock by now */
+                if (reconnect_iot_hub())
+                    reconnect_backoff_on_success();
+                else
+                {
+                    /* An exhausted budget waits the longest delay instead of starting over at once */
+                    reconnect_backoff_on_failure(&backoff_delay_ms);
+                    vTaskDelay(pdMS_TO_TICKS(backoff_delay_ms));
+                }
+
                 continue;
+            }
+
+            /* Commands are answered inside the process loop, so it runs back to back instead of on a poll interval */
+            if (lock_iot_hub_client(pdMS_TO_TICKS(RECV_CMDS_DELAY)))
+            {
+                report_iot_hub_result(AzureIoTHubClient_ProcessLoop(get_iot_hub_client(), AZURE_IOT_HUB_PROCESS_LOOP_TIMEOUT_MS));
+                unlock_iot_hub_client();
+            }
 
-            AzureIoTHubClient_ProcessLoop(get_iot_hub_client(), AZURE_IOT_HUB_PROCESS_LOOP_TIMEOUT_MS);
+            flush_tels();
+            flush_diagnostics();
+
+            /* Let other client users grab the lock between iterations */
+            vTaskDelay(pdMS_TO_TICKS(AZURE_LOOP_YIELD_DELAY));
         }
 
         vTaskDelete(NULL);  
     };
 
-    xTaskCreate(task, TASK_NAME, FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+    create_task(TaskId::AzureLoop, task);
 }
 
 static void exec_tasks()
 {
-    update_status();
-    scan_btns();
-    scan_keys();
+    init_reactor(handle_event);
+    actuate();
     scan_fingerprint();
-    init_sys();
-    init_azure();
-    send_tels();
-    azure_loop();
+    touch_activity();
 }
 
 extern "C" void app_main(void)
 {
+    WarmStart_t snapshot;
+
+    init_clock();
+    init_mem_policy();
+    init_time_sync();
+    bool is_warm_start = load_warm_start(&snapshot);
+
     init_nvs();
-    init_vars();
+    init_deferred_log();
+    init_power_mgmt();
+    init_settings();
+    init_event_recorder();
+    init_vars(is_warm_start ? &snapshot : nullptr);
+    init_timers();
+    init_gpio_isr();
     init_btns();
     init_keypad();
-    // init_pir_sens();
+
+    if (PIR_SENSOR_ENABLED)
+        init_pir_sens();
+
     init_motor_driver();
     init_i2s_controller();
     init_fp_reader();
     init_fp_reader_touch_sens();
-    
-    if (init_wifi_sta())
-        connect(WIFI_AP_SSID, WIFI_AP_PASSWORD, WIFI_AP_AUTH_MODE);
+    init_door_cmds();
+    init_iot_hub_twin();
 
+    if (is_warm_start)
+    {
+        restore_snapshot(snapshot);
+        restore_outbox();
+    }
+
+    record_boot(is_warm_start);
+
+    /* Local unlock is ready before the radio comes up */
     exec_tasks();
-    tel_payloads.push({ TelemetryMessageStatus::SystemBooted });
-}
\ No newline at end of file
+
+#if JITTER_BENCH_ENABLED
+    /* Handshake loop instead of the hub, Wi-Fi stays up for the whole run */
+    if (init_wifi_sta())
+        start_jitter_bench();
+#else
+    /* The network tasks wait for the link */
+    init_sys();
+    azure_loop();
+
+    /* The radio only comes up when the policy asks for it */
+    if (init_wifi_sta())
+        init_radio_manager(get_outbox_len);
+#endif
+
+    push_tel(TelemetryMessageStatus::SystemBooted);
+    log_rtos_budget();
+}
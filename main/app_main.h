@@ -1,48 +1,28 @@
 #ifndef _H_SLS_MAIN_H_
 #define _H_SLS_MAIN_H_
 
-enum class DoorStatus
-{
-    None,
-    Closed,
-    Opened,
-};
+/* DoorStatus, TelemetryMessageStatus, DoorCommand and Action_t are in door_controller.h, host_sim shares them */
 
-enum class SystemStatus
-{
-    None,
-    EmergencyMode,
-    PasswordChangeMode,
-    PasswordChanged,
-    FingerprintEnrollmentMode,
-    RequestFingerprintEnrollmentMode,
-};
+static_assert(sizeof(Action_t) == ARENA_ACTION_SIZE, "Update ARENA_ACTION_SIZE, the core arena budget is sized from it");
 
-enum class TelemetryMessageStatus : uint16_t
+enum class FingerprintJob
 {
-    Opened = 1,
-    Closed,
-    PasswordMismatch,
-    FingerprintMismatch,
-    LockdownCausePasswordMismatch,
-    LockdownCauseFingerprintMismatch,
-    PasswordChanged,
-    StartFingerprintEnrollment,
-    FingerprintEnrolled,
-    FingerprintEnrollmentFailed,
-    NotEnoughBattery,
-    SystemBooted,
+    Search,
+    Enroll,
 };
 
+static_assert(sizeof(FingerprintJob) == ARENA_FP_JOB_SIZE, "Update ARENA_FP_JOB_SIZE, the core arena budget is sized from it");
+
 #define DESC_MAX_LEN    ( 32U )
 
 typedef struct TelemetryPayload_s
 {
     TelemetryMessageStatus status;
     char desc[DESC_MAX_LEN] = { 0 };
+    int64_t time_us = 0;            /* get_mono_time_us() of the event, turned into wall time when sent */
 } TelemetryPayload_t;
 
 static void read_password();
-static void write_password();
+static void write_password(const char* pwd);
 
 #endif
\ No newline at end of file
@@ -8,6 +8,13 @@
             return;                                     \
         }
 
+#define CHECK_ERROR_AND_RETN_VAL(exp, msg, val)         \
+        if (exp)                                        \
+        {                                               \
+            ESP_LOGE(TAG, msg);                         \
+            return val;                                 \
+        }
+
 #define CHECK_ERROR_AND_DEL_TASK(exp, msg)              \
         if (exp)                                        \
         {                                               \
@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -17,8 +19,13 @@ extern "C"
 #include "config.h"
 #include "defs.h"
 #include "network_helper.h"
+#include "helper/hash.h"
+#include "helper/nvs.h"
 #include "helper/system.h"
+#include "helper/time_sync.h"
 #include "dev_provisioning.h"
+#include "rtos_arena.h"
+#include "task_config.h"
 
 /* Each compilation unit must define the NetworkContext struct. */
 struct NetworkContext
@@ -26,6 +33,15 @@ struct NetworkContext
     void * pParams;
 };
 
+typedef struct DpsCache_s
+{
+    uint32_t version;
+    uint32_t config_hash;
+    uint64_t provisioned_time;
+    uint8_t iot_hub_hostname[AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN];
+    uint8_t iot_hub_dev_id[AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN];
+} DpsCache_t;
+
 static const char* TAG = "AzureDeviceProvisioning";
 
 static EventGroupHandle_t status_event_handle = nullptr;
@@ -33,6 +49,7 @@ static TaskHandle_t azure_dev_prv_task_handle = nullptr;
 static AzureIoTResult error_code = eAzureIoTSuccess;
 static uint8_t iot_hub_hostname[AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN] = { 0 };
 static uint8_t iot_hub_dev_id[AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN] = { 0 };
+static bool is_cached_provisioning = false;
 
 bool is_dev_provisioned()
 {
@@ -49,6 +66,85 @@ const char* get_iot_hub_dev_id()
     return reinterpret_cast<const char*>(iot_hub_dev_id);
 }
 
+bool is_dev_provisioned_from_cache()
+{
+    return is_dev_provisioned() && is_cached_provisioning;
+}
+
+/* Binds a cached assignment to the DPS settings it was obtained with */
+static uint32_t get_dps_config_hash()
+{
+    const char* fields[] = { AZURE_IOT_DPS_ID_SCOPE, AZURE_IOT_DPS_REG_ID, AZURE_IOT_DPS_MODEL_ID };
+    const uint8_t separator = 0xFF;
+    uint32_t hash = FNV1A_OFFSET_BASIS;
+
+    for (const auto& field: fields)
+    {
+        hash = fnv1a(field, strlen(field), hash);
+        hash = fnv1a(&separator, sizeof(separator), hash);
+    }
+
+    return hash;
+}
+
+static bool load_dps_cache()
+{
+    DpsCache_t cache;
+    uint64_t now = get_wall_time();
+
+    if (!read_nvs_blob(NVS_KEY_DPS_CACHE, &cache, sizeof(cache)))
+        return false;
+
+    if (cache.version != AZURE_IOT_DPS_CACHE_VERSION || cache.config_hash != get_dps_config_hash())
+    {
+        ESP_LOGI(TAG, "Cached DPS assignment does not match current configuration");
+        return false;
+    }
+
+    /* The age is only checked against a trusted clock, a future timestamp means the cache predates a clock fix */
+    if (is_time_trusted() && (now < cache.provisioned_time || now - cache.provisioned_time >= AZURE_IOT_DPS_CACHE_MAX_AGE_S))
+    {
+        ESP_LOGI(TAG, "Cached DPS assignment expired");
+        return false;
+    }
+
+    cache.iot_hub_hostname[AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN - 1] = 0;
+    cache.iot_hub_dev_id[AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN - 1] = 0;
+
+    if (cache.iot_hub_hostname[0] == 0 || cache.iot_hub_dev_id[0] == 0)
+        return false;
+
+    memcpy(iot_hub_hostname, cache.iot_hub_hostname, sizeof(iot_hub_hostname));
+    memcpy(iot_hub_dev_id, cache.iot_hub_dev_id, sizeof(iot_hub_dev_id));
+
+    return true;
+}
+
+static void save_dps_cache()
+{
+    DpsCache_t cache = { 0 };
+
+    cache.version = AZURE_IOT_DPS_CACHE_VERSION;
+    cache.config_hash = get_dps_config_hash();
+    cache.provisioned_time = get_wall_time();
+    memcpy(cache.iot_hub_hostname, iot_hub_hostname, sizeof(cache.iot_hub_hostname));
+    memcpy(cache.iot_hub_dev_id, iot_hub_dev_id, sizeof(cache.iot_hub_dev_id));
+
+    if (!write_nvs_blob(NVS_KEY_DPS_CACHE, &cache, sizeof(cache)))
+        ESP_LOGE(TAG, "Failed to cache DPS assignment");
+}
+
+void invalidate_dev_provisioning()
+{
+    ESP_LOGI(TAG, "Invalidating DPS assignment: %s:%s", iot_hub_hostname, iot_hub_dev_id);
+
+    erase_nvs_key(NVS_KEY_DPS_CACHE);
+    is_cached_provisioning = false;
+
+    if (status_event_handle)
+        xEventGroupClearBits(status_event_handle, EVENT_BITS_DPS_SUCCESS);
+}
+
 static void task_provision_dev(void* _NO_USED_)
 {
     NetworkCredentials_t network_credentials = { 0 };
@@ -59,14 +155,17 @@ static void task_provision_dev(void* _NO_USED_)
     AzureIoTProvisioningClient_t azure_iot_provisioning_client;
 
     uint32_t mqtt_msg_buf_size = 0;
-    uint32_t received_iot_hub_hostname_len = AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN;
-    uint32_t received_iot_hub_dev_id_len = AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN;
+    uint32_t received_iot_hub_hostname_len = AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN - 1;
+    uint32_t received_iot_hub_dev_id_len = AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN - 1;
+
+    /* The registration SAS token is stamped with the wall clock */
+    wait_time_trusted();
 
     /* Set the pParams member of the network context with desired transport. */
     network_context.pParams = &tls_transport_params;
 
     /* Initialize the network credentials. */
-    SetupNetworkCredentials(&network_credentials);
+    CHECK_ERROR_AND_DEL_TASK(SetupNetworkCredentials(&network_credentials) != 0, "Failed to setup network credentials");
     
     CHECK_ERROR_AND_DEL_TASK(
         ConnectToServerWithBackoffRetries( AZURE_IOT_DPS_ENDPOINT_HOSTNAME, 
@@ -94,7 +193,7 @@ static void task_provision_dev(void* _NO_USED_)
                                                     strlen(AZURE_IOT_DPS_REG_ID),
                                                     NULL,
                                                     get_shared_mqtt_msg_buf(&mqtt_msg_buf_size), mqtt_msg_buf_size,
-                                                    get_time,
+                                                    get_wall_time,
                                                     &transport_interface );
     AZURE_CHECK_ERROR_AND_DEL_TASK(error_code, "Failed to Azure IoT Provisioning Client");
     ESP_LOGI(TAG, "Azure IoT Provisioning Client initialized");
@@ -122,6 +221,8 @@ static void task_provision_dev(void* _NO_USED_)
                                                                 iot_hub_hostname, &received_iot_hub_hostname_len,
                                                                 iot_hub_dev_id, &received_iot_hub_dev_id_len );
     AZURE_CHECK_ERROR_AND_DEL_TASK(error_code, "Failed to get dev and hub");
+    iot_hub_hostname[received_iot_hub_hostname_len] = 0;
+    iot_hub_dev_id[received_iot_hub_dev_id_len] = 0;
     ESP_LOGI(TAG, "Azure IoT Provisioning Client got device and hub: %s:%s", iot_hub_hostname, iot_hub_dev_id);
 
     AzureIoTProvisioningClient_Deinit(&azure_iot_provisioning_client);
@@ -135,15 +236,45 @@ static void task_provision_dev(void* _NO_USED_)
     TLS_Socket_Disconnect(&network_context);
     ESP_LOGI(TAG, "Disconnected from Azure IoT Provisioning EndPoint");
 
+    save_dps_cache();
+    is_cached_provisioning = false;
+
     xEventGroupSetBits(status_event_handle, EVENT_BITS_DPS_SUCCESS);
     vTaskDelete(NULL);
 }
 
+/* Takes the assignment from the warm-start snapshot, a hub rejection still invalidates it like a cached one */
+void restore_dev_provisioning(const char* hostname, const char* dev_id)
+{
+    if (!status_event_handle)
+        status_event_handle = create_static_event_group(Subsystem::Azure);
+
+    if (hostname[0] == 0 || dev_id[0] == 0)
+        return;
+
+    strlcpy(reinterpret_cast<char*>(iot_hub_hostname), hostname, sizeof(iot_hub_hostname));
+    strlcpy(reinterpret_cast<char*>(iot_hub_dev_id), dev_id, sizeof(iot_hub_dev_id));
+
+    is_cached_provisioning = true;
+    xEventGroupSetBits(status_event_handle, EVENT_BITS_DPS_SUCCESS);
+}
+
 void exec_dev_provisioning()
 {
     if (!status_event_handle)
-        status_event_handle = xEventGroupCreate();
+        status_event_handle = create_static_event_group(Subsystem::Azure);
+
+    if (is_dev_provisioned())
+        return;
+
+    if (load_dps_cache())
+    {
+        ESP_LOGI(TAG, "Using cached DPS assignment: %s:%s", iot_hub_hostname, iot_hub_dev_id);
+        is_cached_provisioning = true;
+        xEventGroupSetBits(status_event_handle, EVENT_BITS_DPS_SUCCESS);
+        return;
+    }
 
     if (azure_dev_prv_task_handle == nullptr || eTaskGetState(azure_dev_prv_task_handle) == eDeleted)
-        xTaskCreate(task_provision_dev, "azure-prv-dev", FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, &azure_dev_prv_task_handle);
+        create_task(TaskId::DevProvisioning, task_provision_dev, NULL, &azure_dev_prv_task_handle);
 }
\ No newline at end of file
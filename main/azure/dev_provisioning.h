@@ -5,10 +5,13 @@
 #define EVENT_BITS_DPS_SUCCESS   ( 2 )
 
 bool is_dev_provisioned();
+bool is_dev_provisioned_from_cache();
 
 const char* get_iot_hub_hostname();
 const char* get_iot_hub_dev_id();
 
 void exec_dev_provisioning();
+void restore_dev_provisioning(const char* hostname, const char* dev_id);
+void invalidate_dev_provisioning();
 
 #endif
\ No newline at end of file
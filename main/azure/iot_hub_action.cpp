@@ -18,6 +18,7 @@ extern "C"
 #include "config.h"
 #include "defs.h"
 #include "network_helper.h"
+#include "helper/deferred_log.h"
 #include "helper/system.h"
 #include "iot_hub_provisioning.h"
 #include "iot_hub_action.h"
@@ -30,7 +31,7 @@ static unordered_map<uint16_t, TelemetryTicket_t> tel_tickets(AZURE_IOT_HUB_TEL_
 
 void iot_hub_tel_callback(uint16_t packet_id)
 {
-    ESP_LOGI(TAG, "Telemetry acknowledgement received: %u", packet_id);
+    DLOGI(TEL, TAG, "Telemetry acknowledgement received: %u", packet_id);
 
     if (tel_tickets.find(packet_id) != tel_tickets.end())
         tel_tickets[packet_id].status = TelemetryStatus::Published;
@@ -43,7 +44,8 @@ static bool wait_tel_ack(AzureIoTHubClient_t* client, uint16_t packet_id)
 
     while(tel_tickets[packet_id].status != TelemetryStatus::Published && remaning_count > 0)
     {
-        AzureIoTHubClient_ProcessLoop(client, AZURE_IOT_HUB_PROCESS_LOOP_TIMEOUT_MS);
+        if (!report_iot_hub_result(AzureIoTHubClient_ProcessLoop(client, AZURE_IOT_HUB_PROCESS_LOOP_TIMEOUT_MS)))
+            break;
 
         vTaskDelay(pdMS_TO_TICKS(AZURE_IOT_HUB_TEL_ACK_WAIT_INTERVAL));
         remaining_time -= AZURE_IOT_HUB_TEL_ACK_WAIT_INTERVAL;
@@ -77,7 +79,7 @@ TelemetryTicket_t send_tel(const char* tel_msg, bool wait_ack, bool remove_after
 {
     TelemetryTicket_t ticket;
 
-    if (!is_iot_hub_provisioned())
+    if (!is_iot_hub_connected() || !lock_iot_hub_client(pdMS_TO_TICKS(AZURE_IOT_HUB_TEL_ACK_TIMEOUT_MS)))
     {
         ticket.status = TelemetryStatus::HubError;
         return ticket;
@@ -88,25 +90,34 @@ TelemetryTicket_t send_tel(const char* tel_msg, bool wait_ack, bool remove_after
                                                     (uint8_t*)tel_msg, strlen(tel_msg),
                                                     NULL, eAzureIoTHubMessageQoS1, &ticket.pub_id );
 
-    ticket.status = TelemetryStatus::Sent;
-    tel_tickets[ticket.pub_id] = ticket;
-
-    if (!ticket.azure_result == eAzureIoTSuccess)
+    if (ticket.azure_result != eAzureIoTSuccess)
     {
-        ESP_LOGI(TAG, "Telemetry send failed");
+        ESP_LOGW(TAG, "Telemetry send failed: %d", ticket.azure_result);
+        report_iot_hub_result(ticket.azure_result);
+        unlock_iot_hub_client();
+
+        ticket.status = TelemetryStatus::HubError;
         return ticket;
     }
 
-    ESP_LOGI(TAG, "Telemetry sent, packet id: %u", ticket.pub_id);
+    ticket.status = TelemetryStatus::Sent;
+    tel_tickets[ticket.pub_id] = ticket;
+
+    DLOGD(TEL, TAG, "Telemetry sent, packet id: %u", ticket.pub_id);
 
     if (!wait_ack)
+    {
+        unlock_iot_hub_client();
         return ticket;
+    }
 
     if (!wait_tel_ack(hub_client, ticket.pub_id))
         ticket.status = TelemetryStatus::NoAck;
     else
         ticket.status = TelemetryStatus::Published;
 
+    unlock_iot_hub_client();
+
     tel_tickets.erase(ticket.pub_id);
     return ticket;
 }
\ No newline at end of file
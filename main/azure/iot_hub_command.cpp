@@ -0,0 +1,78 @@
+#include <cstring>
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+
+extern "C"
+{
+#include <azure_iot_hub_client.h>
+}
+
+#include "config.h"
+#include "iot_hub_provisioning.h"
+#include "iot_hub_command.h"
+
+typedef struct IotHubCommand_s
+{
+    const char* name;
+    IotHubCommandHandler handler;
+} IotHubCommand_t;
+
+static const char* TAG = "AzureIotHubCommand";
+
+static IotHubCommand_t commands[AZURE_IOT_HUB_MAX_COMMANDS] = { };
+static size_t num_commands = 0;
+
+bool register_iot_hub_command(const char* name, IotHubCommandHandler handler)
+{
+    if (num_commands >= AZURE_IOT_HUB_MAX_COMMANDS)
+        return false;
+
+    commands[num_commands++] = { name, handler };
+    return true;
+}
+
+static const IotHubCommand_t* find_command(const uint8_t* name, uint16_t name_len)
+{
+    for (size_t i = 0; i < num_commands; ++i)
+    {
+        if (strlen(commands[i].name) == name_len && memcmp(commands[i].name, name, name_len) == 0)
+            return &commands[i];
+    }
+
+    return nullptr;
+}
+
+/* Invoked from inside AzureIoTHubClient_ProcessLoop, so the reply leaves in the same iteration */
+static void iot_hub_command_callback(AzureIoTHubClientCommandRequest_t* request, void* _NO_USED_)
+{
+    char response[AZURE_IOT_HUB_CMD_RESPONSE_BUF_LEN] = "{}";
+    uint32_t status = AZURE_IOT_HUB_CMD_STATUS_NOT_FOUND;
+
+    const IotHubCommand_t* command = find_command(request->pucCommandName, request->usCommandNameLength);
+
+    if (command)
+        status = command->handler(static_cast<const uint8_t*>(request->pvMessagePayload), request->ulPayloadLength,
+                                  response, sizeof(response));
+
+    ESP_LOGI(TAG, "Command %.*s: %lu", request->usCommandNameLength, request->pucCommandName, status);
+
+    AzureIoTResult_t result = AzureIoTHubClient_SendCommandResponse(get_iot_hub_client(), request, status,
+                                                                    reinterpret_cast<const uint8_t*>(response), strlen(response));
+
+    if (result != eAzureIoTSuccess)
+    {
+        ESP_LOGE(TAG, "Failed to send command response: %d", result);
+        report_iot_hub_result(result);
+    }
+}
+
+static AzureIoTResult_t subscribe_commands(AzureIoTHubClient_t* client)
+{
+    return AzureIoTHubClient_SubscribeCommand(client, iot_hub_command_callback, nullptr, AZURE_IOT_HUB_SUBSCRIBE_TIMEOUT_MS);
+}
+
+void init_iot_hub_commands()
+{
+    register_iot_hub_subscription(subscribe_commands);
+}
@@ -0,0 +1,22 @@
+#ifndef _H_IOT_HUB_COMMAND_H_
+#define _H_IOT_HUB_COMMAND_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define AZURE_IOT_HUB_MAX_COMMANDS              ( 8 )
+#define AZURE_IOT_HUB_CMD_RESPONSE_BUF_LEN      ( 128U )
+
+#define AZURE_IOT_HUB_CMD_STATUS_OK             ( 200U )
+#define AZURE_IOT_HUB_CMD_STATUS_ACCEPTED       ( 202U )
+#define AZURE_IOT_HUB_CMD_STATUS_NOT_FOUND      ( 404U )
+#define AZURE_IOT_HUB_CMD_STATUS_CONFLICT       ( 409U )
+#define AZURE_IOT_HUB_CMD_STATUS_UNAVAILABLE    ( 503U )
+
+/* Runs on the process-loop task, must not block. Writes a JSON body to response and returns the status code */
+typedef uint32_t (*IotHubCommandHandler)(const uint8_t* payload, uint32_t payload_len, char* response, size_t response_len);
+
+bool register_iot_hub_command(const char* name, IotHubCommandHandler handler);
+void init_iot_hub_commands();
+
+#endif
@@ -2,6 +2,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
+#include <freertos/semphr.h>
 
 extern "C"
 {
@@ -18,9 +19,12 @@ extern "C"
 #include "defs.h"
 #include "network_helper.h"
 #include "helper/system.h"
+#include "helper/time_sync.h"
 #include "dev_provisioning.h"
 #include "iot_hub_action.h"
 #include "iot_hub_provisioning.h"
+#include "rtos_arena.h"
+#include "task_config.h"
 
 /* Each compilation unit must define the NetworkContext struct. */
 struct NetworkContext
@@ -42,16 +46,97 @@ static AzureIoTHubClient_t azure_iot_hub_client;
 static AzureIoTTransportInterface_t transport_interface;
 static bool session_present = false;
 
+static SemaphoreHandle_t client_mutex = nullptr;
+static volatile IotHubConnState conn_state = IotHubConnState::Disconnected;
+static IotHubSubscribeFn subscriptions[AZURE_IOT_HUB_MAX_SUBSCRIPTIONS] = { nullptr };
+static size_t num_subscriptions = 0;
+static bool is_subscribed = false;
+
 bool is_iot_hub_provisioned()
 {
     return status_event_handle && xEventGroupGetBits(status_event_handle) & EVENT_BITS_IHP_SUCCESS;
 }
 
+bool is_iot_hub_connected()
+{
+    return is_iot_hub_provisioned() && conn_state == IotHubConnState::Connected;
+}
+
+IotHubConnState get_iot_hub_conn_state()
+{
+    return conn_state;
+}
+
 AzureIoTHubClient_t* get_iot_hub_client()
 {
     return &azure_iot_hub_client;
 }
 
+/* The middleware is not thread-safe, every task touching the client holds this lock */
+bool lock_iot_hub_client(TickType_t timeout)
+{
+    return client_mutex && xSemaphoreTakeRecursive(client_mutex, timeout) == pdTRUE;
+}
+
+void unlock_iot_hub_client()
+{
+    xSemaphoreGiveRecursive(client_mutex);
+}
+
+bool register_iot_hub_subscription(IotHubSubscribeFn subscribe)
+{
+    if (num_subscriptions >= AZURE_IOT_HUB_MAX_SUBSCRIPTIONS)
+        return false;
+
+    subscriptions[num_subscriptions++] = subscribe;
+
+    /* Late registrations are subscribed right away, otherwise on the next (re)connect */
+    if (is_iot_hub_connected() && lock_iot_hub_client(portMAX_DELAY))
+    {
+        report_iot_hub_result(subscribe(&azure_iot_hub_client));
+        unlock_iot_hub_client();
+    }
+
+    return true;
+}
+
+static AzureIoTResult_t subscribe_all()
+{
+    is_subscribed = false;
+
+    for (size_t i = 0; i < num_subscriptions; ++i)
+    {
+        AzureIoTResult_t result = subscriptions[i](&azure_iot_hub_client);
+
+        if (result != eAzureIoTSuccess)
+            return result;
+    }
+
+    is_subscribed = true;
+    return eAzureIoTSuccess;
+}
+
+/* Returns false when the result means the MQTT session or the socket underneath is gone */
+bool report_iot_hub_result(AzureIoTResult_t result)
+{
+    switch (result)
+    {
+        case eAzureIoTErrorFailed:
+        case eAzureIoTErrorPublishFailed:
+        case eAzureIoTErrorSubscribeFailed:
+        case eAzureIoTErrorSubackWaitTimeout:
+            if (conn_state == IotHubConnState::Connected)
+            {
+                ESP_LOGW(TAG, "Azure IoT Hub link lost: %d", result);
+                conn_state = IotHubConnState::Disconnected;
+            }
+            return false;
+
+        default:
+            return true;
+    }
+}
+
 static void task_provision_iot_hub(void* _NO_USED_)
 {
     if (!is_dev_provisioned())
@@ -68,18 +153,23 @@ static void task_provision_iot_hub(void* _NO_USED_)
     const char* iot_hub_hostname = get_iot_hub_hostname();
     const char* iot_hub_device_id = get_iot_hub_dev_id();
 
+    /* The connect SAS token is stamped with the wall clock */
+    wait_time_trusted();
+
     /* Set the pParams member of the network context with desired transport. */
     network_context.pParams = &tls_transport_params;
 
     /* Initialize the network credentials. */
-    SetupNetworkCredentials(&network_credentials);
-
-    CHECK_ERROR_AND_DEL_TASK(
-        ConnectToServerWithBackoffRetries( iot_hub_hostname, 
-                                                AZURE_IOT_HUB_ENDPOINT_PORT, 
-                                                &network_credentials, 
-                                                &network_context) != 0,
-        "Failed to connect to the server");
+    CHECK_ERROR_AND_DEL_TASK(SetupNetworkCredentials(&network_credentials) != 0, "Failed to setup network credentials");
+
+    if (ConnectToServerWithBackoffRetries(  iot_hub_hostname, 
+                                            AZURE_IOT_HUB_ENDPOINT_PORT, 
+                                            &network_credentials, 
+                                            &network_context) != 0)
+    {
+        /* An unreachable hub says nothing about the assignment, only a rejection below drops it */
+        CHECK_ERROR_AND_DEL_TASK(true, "Failed to connect to the server");
+    }
     ESP_LOGI(TAG, "Connected to Azure IoT Hub EndPoint: %s:%d", iot_hub_hostname, AZURE_IOT_HUB_ENDPOINT_PORT);
 
     /* Fill in Transport Interface send and receive function pointers. */
@@ -108,7 +198,7 @@ static void task_provision_iot_hub(void* _NO_USED_)
                                             (const uint8_t*)iot_hub_device_id, strlen(iot_hub_device_id),
                                             &hub_options,
                                             get_shared_mqtt_msg_buf(&mqtt_msg_buf_size), mqtt_msg_buf_size,
-                                            get_time,
+                                            get_wall_time,
                                             &transport_interface );
     AZURE_CHECK_ERROR_AND_DEL_TASK(error_code, "Failed to initialize iot hub client");
     ESP_LOGI(TAG, "Azure IoT Hub Client initialized");
@@ -123,27 +213,119 @@ static void task_provision_iot_hub(void* _NO_USED_)
     error_code = AzureIoTHubClient_Connect(   &azure_iot_hub_client, 
                                                 false, &session_present, 
                                                 AZURE_IOT_HUB_CONNACK_RECV_TIMEOUT_MS   );
+
+    if (error_code != eAzureIoTSuccess)
+    {
+        /* Rejected by the hub, the next attempt has to go through DPS again */
+        if (is_dev_provisioned_from_cache())
+            invalidate_dev_provisioning();
+
+        AzureIoTHubClient_Deinit(&azure_iot_hub_client);
+        AzureIoT_Deinit();
+        TLS_Socket_Disconnect(&network_context);
+    }
+
     AZURE_CHECK_ERROR_AND_DEL_TASK(error_code, "Failed to connect to azure iot hub");
     ESP_LOGI(TAG, "Connected to Azure IoT Hub EndPoint");
 
+    if (lock_iot_hub_client(portMAX_DELAY))
+    {
+        /* A failed subscription is retried by the supervisor through reconnect_iot_hub() */
+        conn_state = report_iot_hub_result(subscribe_all()) ? IotHubConnState::Connected : IotHubConnState::Disconnected;
+        unlock_iot_hub_client();
+    }
+
     xEventGroupSetBits(status_event_handle, EVENT_BITS_IHP_SUCCESS);
     vTaskDelete(NULL);
 }
 
-void reconnect_iot_hub()
+/* Tears down the dead session and makes one attempt to bring it back, the connection supervisor runs the backoff */
+bool reconnect_iot_hub()
 {
+    if (!is_iot_hub_provisioned())
+        return false;
+
+    /* A fresh SAS token is generated on connect, the supervisor retries once the clock is trusted again */
+    if (!is_time_trusted())
+        return false;
+
+    CHECK_ERROR_AND_RETN_VAL(!lock_iot_hub_client(portMAX_DELAY), "Failed to lock iot hub client", false);
+
+    conn_state = IotHubConnState::Reconnecting;
+
+    /* Best effort, the socket is most likely gone already */
+    AzureIoTHubClient_Disconnect(&azure_iot_hub_client);
+    TLS_Socket_Disconnect(&network_context);
+
+    if (ConnectToServer(get_iot_hub_hostname(), AZURE_IOT_HUB_ENDPOINT_PORT, &network_credentials, &network_context) != 0)
+    {
+        ESP_LOGE(TAG, "Failed to reconnect to the server");
+        conn_state = IotHubConnState::Disconnected;
+        unlock_iot_hub_client();
+        return false;
+    }
+
     error_code = AzureIoTHubClient_Connect(   &azure_iot_hub_client, 
                                                 false, &session_present, 
                                                 AZURE_IOT_HUB_CONNACK_RECV_TIMEOUT_MS   );
-    AZURE_CHECK_ERROR_AND_RETN(error_code, "Failed to connect to azure iot hub");
-    ESP_LOGI(TAG, "Connected to Azure IoT Hub EndPoint");
+
+    if (error_code != eAzureIoTSuccess && is_dev_provisioned_from_cache())
+    {
+        /* Rejected by the hub, the client is torn down and the supervisor reruns DPS and hub provisioning */
+        ESP_LOGE(TAG, "Rejected by azure iot hub on reconnect: %d", error_code);
+        invalidate_dev_provisioning();
+
+        AzureIoTHubClient_Deinit(&azure_iot_hub_client);
+        AzureIoT_Deinit();
+        TLS_Socket_Disconnect(&network_context);
+
+        conn_state = IotHubConnState::Disconnected;
+        xEventGroupClearBits(status_event_handle, EVENT_BITS_IHP_SUCCESS);
+        unlock_iot_hub_client();
+        return false;
+    }
+
+    /* The hub keeps subscriptions of a persistent session, only a fresh one needs them again */
+    if (error_code == eAzureIoTSuccess && (!session_present || !is_subscribed))
+        error_code = subscribe_all();
+
+    if (error_code != eAzureIoTSuccess)
+    {
+        ESP_LOGE(TAG, "Failed to reconnect to azure iot hub: %d", error_code);
+        TLS_Socket_Disconnect(&network_context);
+        conn_state = IotHubConnState::Disconnected;
+        unlock_iot_hub_client();
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Reconnected to Azure IoT Hub EndPoint, session present: %d", session_present);
+    conn_state = IotHubConnState::Connected;
+    unlock_iot_hub_client();
+    return true;
+}
+
+/* Graceful close before the radio goes down, the supervisor reconnects once Wi-Fi is back */
+void disconnect_iot_hub()
+{
+    if (!is_iot_hub_provisioned() || !lock_iot_hub_client(portMAX_DELAY))
+        return;
+
+    if (conn_state == IotHubConnState::Connected)
+        AzureIoTHubClient_Disconnect(&azure_iot_hub_client);
+
+    TLS_Socket_Disconnect(&network_context);
+    conn_state = IotHubConnState::Disconnected;
+    unlock_iot_hub_client();
 }
 
 void exec_iot_hub_provisioning()
 {
     if (!status_event_handle)
-        status_event_handle = xEventGroupCreate();
+        status_event_handle = create_static_event_group(Subsystem::Azure);
+
+    if (!client_mutex)
+        client_mutex = create_static_mutex(Subsystem::Azure, true);
 
     if (azure_iot_hub_prv_task_handle == nullptr || eTaskGetState(azure_iot_hub_prv_task_handle) == eDeleted)
-        xTaskCreate(task_provision_iot_hub, "azure-prv-dev", FREERTOS_DEFAULT_STACK_SIZE, NULL, tskIDLE_PRIORITY, &azure_iot_hub_prv_task_handle);
+        create_task(TaskId::IotHubProvisioning, task_provision_iot_hub, NULL, &azure_iot_hub_prv_task_handle);
 }
\ No newline at end of file
@@ -1,14 +1,36 @@
 #ifndef _H_IOT_HUB_PROVISIONING_H_
 #define _H_IOT_HUB_PROVISIONING_H_
 
+#include <freertos/FreeRTOS.h>
 #include <azure_iot_hub_client.h>
 
 #define EVENT_BITS_IHP_FAILED    ( 1 )
 #define EVENT_BITS_IHP_SUCCESS   ( 2 )
 
+#define AZURE_IOT_HUB_MAX_SUBSCRIPTIONS ( 4 )
+
+enum class IotHubConnState
+{
+    Disconnected,
+    Connected,
+    Reconnecting,
+};
+
+/* Subscribes one hub feature (commands, properties, ...) on a fresh MQTT session */
+typedef AzureIoTResult_t (*IotHubSubscribeFn)(AzureIoTHubClient_t* client);
+
 bool is_iot_hub_provisioned();
+bool is_iot_hub_connected();
+IotHubConnState get_iot_hub_conn_state();
 AzureIoTHubClient_t* get_iot_hub_client();
-void reconnect_iot_hub();
+
+bool lock_iot_hub_client(TickType_t timeout);
+void unlock_iot_hub_client();
+
+bool register_iot_hub_subscription(IotHubSubscribeFn subscribe);
+bool report_iot_hub_result(AzureIoTResult_t result);
+bool reconnect_iot_hub();
+void disconnect_iot_hub();
 void exec_iot_hub_provisioning();
 
 #endif
\ No newline at end of file
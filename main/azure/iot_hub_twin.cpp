@@ -0,0 +1,168 @@
+#include <cstring>
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+
+extern "C"
+{
+#include <azure_iot_hub_client.h>
+#include <azure_iot_hub_client_properties.h>
+#include <azure_iot_json_reader.h>
+#include <azure_iot_json_writer.h>
+}
+
+#include "config.h"
+#include "helper/event_recorder.h"
+#include "helper/settings.h"
+#include "iot_hub_provisioning.h"
+#include "iot_hub_twin.h"
+
+static const char* TAG = "AzureIotHubTwin";
+
+static uint8_t reported_buf[AZURE_IOT_HUB_REPORTED_BUF_LEN] = { 0 };
+
+static bool find_setting_token(AzureIoTJSONReader_t* reader, Setting* id)
+{
+    for (size_t i = 0; i < static_cast<size_t>(Setting::Count); ++i)
+    {
+        const char* name = get_setting_name(static_cast<Setting>(i));
+
+        if (AzureIoTJSONReader_TokenIsTextEqual(reader, reinterpret_cast<const uint8_t*>(name), strlen(name)))
+        {
+            *id = static_cast<Setting>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Applies writable properties to the settings store and acknowledges each one in a single reported patch */
+static void apply_desired_properties(AzureIoTHubClientPropertiesResponse_t* message)
+{
+    AzureIoTHubClient_t* client = get_iot_hub_client();
+    AzureIoTJSONReader_t reader;
+    AzureIoTJSONWriter_t writer;
+    uint32_t version = 0;
+    uint32_t num_acks = 0;
+
+    const uint8_t* payload = static_cast<const uint8_t*>(message->pvMessagePayload);
+    const uint8_t* component_name = nullptr;
+    uint32_t component_name_len = 0;
+
+    if (AzureIoTJSONReader_Init(&reader, payload, message->ulPayloadLength) != eAzureIoTSuccess ||
+        AzureIoTHubClientProperties_GetPropertiesVersion(client, &reader, message->xMessageType, &version) != eAzureIoTSuccess)
+    {
+        ESP_LOGE(TAG, "Failed to read properties version");
+        return;
+    }
+
+    /* A full twin fetched on reconnect usually carries nothing new */
+    if (version == get_settings_version())
+        return;
+
+    AzureIoTJSONReader_Init(&reader, payload, message->ulPayloadLength);
+    AzureIoTJSONWriter_Init(&writer, reported_buf, sizeof(reported_buf));
+    AzureIoTJSONWriter_AppendBeginObject(&writer);
+
+    while (AzureIoTHubClientProperties_GetNextComponentProperty(client, &reader, message->xMessageType,
+                                                                eAzureIoTHubClientPropertyWritable,
+                                                                &component_name, &component_name_len) == eAzureIoTSuccess)
+    {
+        Setting id;
+        uint32_t value = 0;
+
+        if (!find_setting_token(&reader, &id))
+        {
+            AzureIoTJSONReader_NextToken(&reader);
+            AzureIoTJSONReader_SkipChildren(&reader);
+            AzureIoTJSONReader_NextToken(&reader);
+            continue;
+        }
+
+        AzureIoTJSONReader_NextToken(&reader);
+
+        bool is_applied = AzureIoTJSONReader_GetTokenUInt32(&reader, &value) == eAzureIoTSuccess && set_setting(id, value);
+        const char* name = get_setting_name(id);
+
+        ESP_LOGI(TAG, "Desired %s: %lu (%s)", name, value, is_applied ? "applied" : "rejected");
+
+        if (is_applied)
+            record_event(RecordedInput::SettingApplied, static_cast<uint8_t>(id), static_cast<uint16_t>(value & 0xFFFF), static_cast<uint16_t>(value >> 16));
+
+        /* An object or array value is rejected as well, its children are skipped so the reader ends on its last token */
+        AzureIoTJSONReader_SkipChildren(&reader);
+
+        /* Rejected values are acked with 400 and the value still in effect */
+        AzureIoTHubClientProperties_BuilderBeginResponseStatus(client, &writer,
+                                                               reinterpret_cast<const uint8_t*>(name), strlen(name),
+                                                               is_applied ? AZURE_IOT_HUB_ACK_OK : AZURE_IOT_HUB_ACK_BAD_REQUEST,
+                                                               version, nullptr, 0);
+        AzureIoTJSONWriter_AppendInt32(&writer, static_cast<int32_t>(get_setting(id)));
+        AzureIoTHubClientProperties_BuilderEndResponseStatus(client, &writer);
+
+        ++num_acks;
+        AzureIoTJSONReader_NextToken(&reader);
+    }
+
+    AzureIoTJSONWriter_AppendEndObject(&writer);
+
+    set_settings_version(version);
+
+    if (!save_settings())
+        ESP_LOGE(TAG, "Failed to cache settings");
+
+    if (num_acks == 0)
+        return;
+
+    int32_t reported_len = AzureIoTJSONWriter_GetBytesUsed(&writer);
+
+    if (reported_len < 0)
+    {
+        ESP_LOGE(TAG, "Reported properties buffer too small");
+        return;
+    }
+
+    AzureIoTResult_t result = AzureIoTHubClient_SendPropertiesReported(client, reported_buf, reported_len, nullptr);
+
+    if (result != eAzureIoTSuccess)
+    {
+        ESP_LOGE(TAG, "Failed to send reported properties: %d", result);
+        report_iot_hub_result(result);
+    }
+}
+
+static void iot_hub_properties_callback(AzureIoTHubClientPropertiesResponse_t* message, void* _NO_USED_)
+{
+    switch (message->xMessageType)
+    {
+        case eAzureIoTHubPropertiesRequestedMessage:
+        case eAzureIoTHubPropertiesWritablePropertyMessage:
+            apply_desired_properties(message);
+            break;
+
+        case eAzureIoTHubPropertiesReportedResponseMessage:
+            ESP_LOGI(TAG, "Reported properties acknowledged: %d", message->xMessageStatus);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static AzureIoTResult_t subscribe_properties(AzureIoTHubClient_t* client)
+{
+    AzureIoTResult_t result = AzureIoTHubClient_SubscribeProperties(client, iot_hub_properties_callback, nullptr,
+                                                                    AZURE_IOT_HUB_SUBSCRIBE_TIMEOUT_MS);
+
+    /* Fetch the whole twin so patches missed while offline or asleep are picked up */
+    if (result == eAzureIoTSuccess)
+        result = AzureIoTHubClient_RequestPropertiesAsync(client);
+
+    return result;
+}
+
+void init_iot_hub_twin()
+{
+    register_iot_hub_subscription(subscribe_properties);
+}
@@ -0,0 +1,11 @@
+#ifndef _H_IOT_HUB_TWIN_H_
+#define _H_IOT_HUB_TWIN_H_
+
+#define AZURE_IOT_HUB_REPORTED_BUF_LEN  ( 512U )
+
+#define AZURE_IOT_HUB_ACK_OK            ( 200 )
+#define AZURE_IOT_HUB_ACK_BAD_REQUEST   ( 400 )
+
+void init_iot_hub_twin();
+
+#endif
@@ -2,17 +2,16 @@ extern "C"
 {
 #include <azure_iot_hub_client.h>
 #include <azure_iot_provisioning_client.h>
-#include <backoff_algorithm.h>
 #include <transport_tls_socket.h>
 #include <transport_abstraction.h>
 }
 
+#include <esp_attr.h>
+
 #include "certs.h"
 #include "config.h"
 #include "network_helper.h"
 
-#define RAND32()    ( rand() / RAND_MAX )
-
 /* Each compilation unit must define the NetworkContext struct. */
 struct NetworkContext
 {
@@ -20,7 +19,9 @@ struct NetworkContext
 };
 
 static const char* TAG = "AzureNetworkHelper";
-static uint8_t shared_mqtt_msg_buf[MQTT_MESSAGE_BUF_SIZE] = { 0 };
+
+/* Only the MQTT tasks touch it, so it can live in PSRAM */
+EXT_RAM_BSS_ATTR static uint8_t shared_mqtt_msg_buf[MQTT_MESSAGE_BUF_SIZE];
 
 uint8_t* get_shared_mqtt_msg_buf(uint32_t* buf_size)
 {
@@ -28,6 +29,32 @@ uint8_t* get_shared_mqtt_msg_buf(uint32_t* buf_size)
     return shared_mqtt_msg_buf;
 }
 
+/**
+* @brief Connect to server once, without touching the backoff state.
+*/
+uint32_t ConnectToServer( const char * pcHostName,
+                          uint32_t port,
+                          NetworkCredentials_t * pxNetworkCredentials,
+                          NetworkContext_t * pxNetworkContext )
+{
+    LogInfo( ( "Creating a TLS connection to %s:%lu.\r\n", pcHostName, port ) );
+
+    /* Attempt to create a mutually authenticated TLS connection. */
+    TlsTransportStatus_t xNetworkStatus = TLS_Socket_Connect( pxNetworkContext,
+                                                              pcHostName, port,
+                                                              pxNetworkCredentials,
+                                                              AZURE_IOT_TRANSPORT_SEND_RECV_TIMEOUT_MS,
+                                                              AZURE_IOT_TRANSPORT_SEND_RECV_TIMEOUT_MS );
+
+    if( xNetworkStatus != eTLSTransportSuccess )
+    {
+        LogWarn( ( "Connection to %s failed [%d].", pcHostName, xNetworkStatus ) );
+    }
+
+    return xNetworkStatus == eTLSTransportSuccess ? 0 : 1;
+}
+/*-----------------------------------------------------------*/
+
 /**
 * @brief Connect to server with backoff retries.
 */
@@ -37,19 +64,13 @@ uint32_t ConnectToServerWithBackoffRetries( const char * pcHostName,
                                                       NetworkContext_t * pxNetworkContext )
 {
     TlsTransportStatus_t xNetworkStatus;
-    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
-    BackoffAlgorithmContext_t xReconnectParams;
-    uint16_t usNextRetryBackOff = 0U;
-
-    /* Initialize reconnect attempts and interval. */
-    BackoffAlgorithm_InitializeParams( &xReconnectParams,
-                                       AZURE_IOT_RETRY_BACKOFF_BASE_MS,
-                                       AZURE_IOT_RETRY_MAX_BACKOFF_DELAY_MS,
-                                       AZURE_IOT_RETRY_MAX_ATTEMPTS );
-
-    /* Attempt to connect to IoT Hub. If connection fails, retry after
-     * a timeout. Timeout value will exponentially increase till maximum
-     * attempts are reached.
+    bool xShouldRetry = true;
+    uint32_t ulNextRetryBackOff = 0U;
+
+    /* Attempt to connect to IoT Hub. If connection fails, retry after a
+     * decorrelated-jitter backoff drawn from the hardware RNG, so devices
+     * recovering from the same outage spread out instead of reconnecting
+     * in lockstep.
      */
     do
     {
@@ -61,28 +82,27 @@ uint32_t ConnectToServerWithBackoffRetries( const char * pcHostName,
                                              AZURE_IOT_TRANSPORT_SEND_RECV_TIMEOUT_MS,
                                              AZURE_IOT_TRANSPORT_SEND_RECV_TIMEOUT_MS );
 
-        if( xNetworkStatus != eTLSTransportSuccess )
+        if( xNetworkStatus == eTLSTransportSuccess )
         {
-            /* Generate a random number and calculate backoff value (in milliseconds) for
-             * the next connection retry.
-             * Note: It is recommended to seed the random number generator with a device-specific
-             * entropy source so that possibility of multiple devices retrying failed network operations
-             * at similar intervals can be avoided. */
-            xBackoffAlgStatus = BackoffAlgorithm_GetNextBackoff( &xReconnectParams, RAND32(), &usNextRetryBackOff );
-
-            if( xBackoffAlgStatus == BackoffAlgorithmRetriesExhausted )
+            reconnect_backoff_on_success();
+        }
+        else
+        {
+            xShouldRetry = reconnect_backoff_on_failure( &ulNextRetryBackOff );
+
+            if( !xShouldRetry )
             {
                 LogError( ( "Connection to the IoT Hub failed, all attempts exhausted." ) );
             }
-            else if( xBackoffAlgStatus == BackoffAlgorithmSuccess )
+            else
             {
                 LogWarn( ( "Connection to the IoT Hub failed [%d]. "
-                           "Retrying connection with backoff and jitter [%d]ms.",
-                           xNetworkStatus, usNextRetryBackOff ) );
-                vTaskDelay( pdMS_TO_TICKS( usNextRetryBackOff ) );
+                           "Retrying connection with backoff and jitter [%lu]ms.",
+                           xNetworkStatus, ulNextRetryBackOff ) );
+                vTaskDelay( pdMS_TO_TICKS( ulNextRetryBackOff ) );
             }
         }
-    } while( ( xNetworkStatus != eTLSTransportSuccess ) && ( xBackoffAlgStatus == BackoffAlgorithmSuccess ) );
+    } while( ( xNetworkStatus != eTLSTransportSuccess ) && xShouldRetry );
 
     return xNetworkStatus == eTLSTransportSuccess ? 0 : 1;
 }
@@ -95,9 +115,18 @@ uint8_t SetupNetworkCredentials( NetworkCredentials_t* pxNetworkCredentials )
 {
     pxNetworkCredentials->xDisableSni = pdFALSE;
 
+    /* Parse the root CA chain once, every connection then shares it. */
+    if( TLS_Socket_LoadRootCaChain( AZURE_IOT_ROOT_CA_DERS,
+                                    AZURE_IOT_ROOT_CA_DER_SIZES,
+                                    sizeof( AZURE_IOT_ROOT_CA_DERS ) / sizeof( AZURE_IOT_ROOT_CA_DERS[ 0 ] ) ) != eTLSTransportSuccess )
+    {
+        LogError( ( "Failed to load the root CA chain." ) );
+        return 1;
+    }
+
     /* Set the credentials for establishing a TLS connection. */
-    pxNetworkCredentials->pucRootCa = ( const unsigned char * ) AZURE_IOT_ROOT_CA_PEM;
-    pxNetworkCredentials->xRootCaSize = sizeof( AZURE_IOT_ROOT_CA_PEM );
+    pxNetworkCredentials->pucRootCa = NULL;
+    pxNetworkCredentials->xRootCaSize = 0;
 
     return 0;
 }
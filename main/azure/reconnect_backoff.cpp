@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_random.h>
+
+#include "reconnect_backoff.h"
+
+using namespace std;
+
+#define RECONNECT_BACKOFF_MAGIC ( 0x424B4F46U )
+
+typedef struct ReconnectBackoffState_s
+{
+    uint32_t magic;
+    uint32_t prev_delay_ms;
+    ReconnectBackoffStats_t stats;
+} ReconnectBackoffState_t;
+
+static const char* TAG = "ReconnectBackoff";
+static RTC_DATA_ATTR ReconnectBackoffState_t state;
+
+static void load_state()
+{
+    /* RTC memory is only retained across deep sleep, start over after a power cycle */
+    if (state.magic == RECONNECT_BACKOFF_MAGIC)
+        return;
+
+    state = { };
+    state.magic = RECONNECT_BACKOFF_MAGIC;
+    state.prev_delay_ms = AZURE_IOT_RETRY_BACKOFF_BASE_MS;
+}
+
+static uint32_t random_between(uint32_t lo, uint32_t hi)
+{
+    if (hi <= lo)
+        return lo;
+
+    return lo + esp_random() % (hi - lo + 1);
+}
+
+void reconnect_backoff_on_success()
+{
+    load_state();
+
+    state.stats.attempts++;
+    state.stats.successes++;
+    state.stats.consecutive_failures = 0;
+    state.prev_delay_ms = AZURE_IOT_RETRY_BACKOFF_BASE_MS;
+}
+
+bool reconnect_backoff_on_failure(uint32_t* next_delay_ms)
+{
+    load_state();
+
+    state.stats.attempts++;
+    state.stats.failures++;
+    state.stats.consecutive_failures++;
+
+    if (AZURE_IOT_RETRY_MAX_ATTEMPTS != AZURE_IOT_RETRY_FOREVER &&
+        state.stats.consecutive_failures >= AZURE_IOT_RETRY_MAX_ATTEMPTS)
+    {
+        ESP_LOGW(TAG, "Retries exhausted after %lu attempts", state.stats.consecutive_failures);
+
+        /* Keep prev_delay_ms so the next round, possibly after deep sleep, stays spread out */
+        state.stats.exhausted++;
+        state.stats.consecutive_failures = 0;
+        return false;
+    }
+
+    uint64_t upper = static_cast<uint64_t>(state.prev_delay_ms) * 3;
+    uint32_t delay_ms = random_between(AZURE_IOT_RETRY_BACKOFF_BASE_MS,
+                                       static_cast<uint32_t>(min<uint64_t>(upper, AZURE_IOT_RETRY_MAX_BACKOFF_DELAY_MS)));
+
+    state.prev_delay_ms = delay_ms;
+    state.stats.last_delay_ms = delay_ms;
+    state.stats.total_delay_ms += delay_ms;
+
+    *next_delay_ms = delay_ms;
+    return true;
+}
+
+void get_reconnect_backoff_stats(ReconnectBackoffStats_t* stats)
+{
+    load_state();
+    *stats = state.stats;
+}
@@ -0,0 +1,30 @@
+#ifndef _H_AZURE_RECONNECT_BACKOFF_H_
+#define _H_AZURE_RECONNECT_BACKOFF_H_
+
+#include <cstdint>
+
+/* Retry until connected when used as the max attempt count */
+#define AZURE_IOT_RETRY_FOREVER                         ( 0U )
+
+#define AZURE_IOT_RETRY_MAX_ATTEMPTS                    ( 5U )
+#define AZURE_IOT_RETRY_MAX_BACKOFF_DELAY_MS            ( 60 * 1000U )
+#define AZURE_IOT_RETRY_BACKOFF_BASE_MS                 ( 500U )
+
+typedef struct ReconnectBackoffStats_s
+{
+    uint32_t attempts;              /* Connection attempts, across deep sleep */
+    uint32_t failures;              /* Failed attempts */
+    uint32_t successes;             /* Successful attempts */
+    uint32_t exhausted;             /* Times the retry budget ran out */
+    uint32_t consecutive_failures;  /* Failures since the last success */
+    uint32_t last_delay_ms;         /* Most recent backoff delay */
+    uint64_t total_delay_ms;        /* Accumulated backoff delay */
+} ReconnectBackoffStats_t;
+
+/* Decorrelated jitter: delay = min(cap, random(base, prev * 3)), seeded by the hardware RNG.
+*  State lives in RTC memory so a device that sleeps mid-outage resumes its backoff instead of restarting at base. */
+void reconnect_backoff_on_success();
+bool reconnect_backoff_on_failure(uint32_t* next_delay_ms);
+void get_reconnect_backoff_stats(ReconnectBackoffStats_t* stats);
+
+#endif
@@ -1,18 +1,153 @@
-#include "helper/system.h"
+#include <esp_log.h>
+
 #include "cancellationtoken.h"
 
-CancellationToken::CancellationToken(bool canceled)
+#define EVENT_BITS_TOKEN_CANCELED   ( BIT0 )
+
+static const char* TAG = "CancellationToken";
+static CancellationToken token_pool[CANCELLATION_TOKEN_POOL_SIZE];
+static portMUX_TYPE token_lock = portMUX_INITIALIZER_UNLOCKED;
+
+CancellationToken* CancellationToken::_acquire()
 {
-    _is_cancellation_requested = canceled;
-    _lifetime = get_time();
+    CancellationToken* token = nullptr;
+
+    portENTER_CRITICAL(&token_lock);
+
+    for (auto& slot: token_pool)
+    {
+        if (!slot._is_used)
+        {
+            slot._is_used = true;
+            token = &slot;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&token_lock);
+
+    if (token == nullptr)
+    {
+        ESP_LOGE(TAG, "Pool exhausted, raise CANCELLATION_TOKEN_POOL_SIZE");
+        return nullptr;
+    }
+
+    /* Kernel objects are made once per slot and reused by every later owner */
+    if (token->_event_group == nullptr)
+        token->_event_group = xEventGroupCreateStatic(&token->_event_group_buf);
+
+    if (token->_timer == nullptr)
+    {
+        esp_timer_create_args_t args = {
+            .callback = [](void* arg) { static_cast<CancellationToken*>(arg)->_cancel(); },
+            .arg = token,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "cts_after",
+            .skip_unhandled_events = true,
+        };
+
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_create(&args, &token->_timer));
+    }
+
+    token->_reset();
+    return token;
 }
 
-CancellationToken::~CancellationToken() { }
+void CancellationToken::_release(CancellationToken* token)
+{
+    token->_reset();
+
+    portENTER_CRITICAL(&token_lock);
+
+    for (auto& entry: token->_callbacks)
+        entry = { };
+
+    token->_is_used = false;
+
+    portEXIT_CRITICAL(&token_lock);
+}
 
 bool CancellationToken::is_cancellation_requested()
 {
-    if (_milliseconds_delay >= 0)
-        return get_time() >= _lifetime + _milliseconds_delay;
+    return (xEventGroupGetBits(_event_group) & EVENT_BITS_TOKEN_CANCELED) != 0;
+}
+
+bool CancellationToken::delay(TickType_t ticks)
+{
+    return (xEventGroupWaitBits(_event_group, EVENT_BITS_TOKEN_CANCELED, pdFALSE, pdTRUE, ticks) & EVENT_BITS_TOKEN_CANCELED) == 0;
+}
+
+bool CancellationToken::register_callback(CancellationCallback_t callback, void* arg)
+{
+    bool is_registered = false;
+
+    portENTER_CRITICAL(&token_lock);
 
-    return _is_cancellation_requested;
+    for (auto& entry: _callbacks)
+    {
+        if (entry.callback == nullptr)
+        {
+            entry = { callback, arg };
+            is_registered = true;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&token_lock);
+
+    /* A cancel that raced with the registration did not see the callback */
+    if (is_registered && is_cancellation_requested())
+        callback(arg);
+
+    return is_registered;
+}
+
+void CancellationToken::unregister_callback(CancellationCallback_t callback, void* arg)
+{
+    portENTER_CRITICAL(&token_lock);
+
+    for (auto& entry: _callbacks)
+    {
+        if (entry.callback == callback && entry.arg == arg)
+            entry = { };
+    }
+
+    portEXIT_CRITICAL(&token_lock);
+}
+
+void CancellationToken::_cancel()
+{
+    Callback_t callbacks[CANCELLATION_TOKEN_MAX_CALLBACKS];
+
+    /* Waiters on the bit wake here, the rest through their callbacks */
+    xEventGroupSetBits(_event_group, EVENT_BITS_TOKEN_CANCELED);
+
+    portENTER_CRITICAL(&token_lock);
+
+    for (uint8_t i = 0; i < CANCELLATION_TOKEN_MAX_CALLBACKS; ++i)
+        callbacks[i] = _callbacks[i];
+
+    portEXIT_CRITICAL(&token_lock);
+
+    for (const auto& entry: callbacks)
+    {
+        if (entry.callback)
+            entry.callback(entry.arg);
+    }
+}
+
+void CancellationToken::_cancel_after(uint32_t milliseconds_delay)
+{
+    esp_timer_stop(_timer);
+
+    if (milliseconds_delay == 0)
+        _cancel();
+    else
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_start_once(_timer, milliseconds_delay * 1000ULL));
+}
+
+void CancellationToken::_reset()
+{
+    esp_timer_stop(_timer);
+    xEventGroupClearBits(_event_group, EVENT_BITS_TOKEN_CANCELED);
 }
\ No newline at end of file
@@ -1,19 +1,51 @@
 #ifndef _H_CANCELLATION_TOKEN_H_
 #define _H_CANCELLATION_TOKEN_H_
 
-#include "helper/system.h"
+#include <cstdint>
 
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#define CANCELLATION_TOKEN_POOL_SIZE        ( 4 )
+#define CANCELLATION_TOKEN_MAX_CALLBACKS    ( 2 )
+
+typedef void (*CancellationCallback_t)(void* arg);
+
+/* Taken from a fixed pool by CancellationTokenSource, the cancel bit is a wait handle for blocked tasks */
 class CancellationToken
 {
 public:
-    CancellationToken(bool canceled);
-    ~CancellationToken();
-
     bool is_cancellation_requested();
+
+    /* Sleeps like vTaskDelay, false as soon as the token is canceled */
+    bool delay(TickType_t ticks);
+
+    /*
+     * For waits the token cannot see, such as a driver queue: the callback wakes them.
+     * Runs in the canceling task or the esp_timer task, so it must not block. Called at once if already canceled.
+     */
+    bool register_callback(CancellationCallback_t callback, void* arg);
+    void unregister_callback(CancellationCallback_t callback, void* arg);
 private:
-    bool _is_cancellation_requested = false;
-    uint64_t _lifetime;
-    int _milliseconds_delay = -1;
+    typedef struct Callback_s
+    {
+        CancellationCallback_t callback;
+        void* arg;
+    } Callback_t;
+
+    StaticEventGroup_t _event_group_buf;
+    EventGroupHandle_t _event_group = nullptr;
+    esp_timer_handle_t _timer = nullptr;
+    Callback_t _callbacks[CANCELLATION_TOKEN_MAX_CALLBACKS] = { };
+    bool _is_used = false;
+
+    static CancellationToken* _acquire();
+    static void _release(CancellationToken* token);
+
+    void _cancel();
+    void _cancel_after(uint32_t milliseconds_delay);
+    void _reset();
 
     friend class CancellationTokenSource;
 };
@@ -1,40 +1,56 @@
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
-
-#include "helper/system.h"
 #include "cancellationtokensource.h"
 
+static_assert(CANCELLATION_TOKEN_POOL_SIZE <= 8, "_owned_mask holds one bit per token");
+
 CancellationTokenSource::CancellationTokenSource() { }
-CancellationTokenSource::~CancellationTokenSource() { }
+
+CancellationTokenSource::~CancellationTokenSource()
+{
+    for (uint8_t i = 0; i < _num_tokens; ++i)
+    {
+        if (_owned_mask & (1U << i))
+            CancellationToken::_release(_tokens[i]);
+    }
+}
 
 void CancellationTokenSource::reset()
 {
-    for(auto& token: _tokens)
-        token->_is_cancellation_requested = false;
+    for (uint8_t i = 0; i < _num_tokens; ++i)
+        _tokens[i]->_reset();
 }
 
 void CancellationTokenSource::cancel()
 {
-    for(auto& token: _tokens)
-        token->_is_cancellation_requested = true;
+    for (uint8_t i = 0; i < _num_tokens; ++i)
+        _tokens[i]->_cancel();
 }
 
 void CancellationTokenSource::cancel_after(int millisecondsDelay)
 {
-    for(auto& token: _tokens)
-    {
-        token->_milliseconds_delay = millisecondsDelay;
-        token->_lifetime = get_time();
-    }
+    for (uint8_t i = 0; i < _num_tokens; ++i)
+        _tokens[i]->_cancel_after(millisecondsDelay > 0 ? millisecondsDelay : 0);
 }
 
-void CancellationTokenSource::link_token(CancellationToken* token)
+bool CancellationTokenSource::link_token(CancellationToken* token)
 {
-    _tokens.push_back(token);
+    if (token == nullptr || _num_tokens == CANCELLATION_TOKEN_POOL_SIZE)
+        return false;
+
+    _tokens[_num_tokens++] = token;
+    return true;
 }
 
 CancellationToken* CancellationTokenSource::create_linked_token()
 {
-    _tokens.push_back(new CancellationToken(false));
-    return _tokens.back();
+    if (_num_tokens == CANCELLATION_TOKEN_POOL_SIZE)
+        return nullptr;
+
+    CancellationToken* token = CancellationToken::_acquire();
+
+    if (token == nullptr)
+        return nullptr;
+
+    _owned_mask |= 1U << _num_tokens;
+    _tokens[_num_tokens++] = token;
+    return token;
 }
\ No newline at end of file
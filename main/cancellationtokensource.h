@@ -1,7 +1,7 @@
 #ifndef _H_CANCELLATION_TOKEN_SOURCE_H_
 #define _H_CANCELLATION_TOKEN_SOURCE_H_
 
-#include <vector>
+#include <cstdint>
 #include <cancellationtoken.h>
 
 using namespace std;
@@ -15,10 +15,14 @@ public:
     void reset();
     void cancel();
     void cancel_after(int millisecondsDelay);
-    void link_token(CancellationToken* token);
+    bool link_token(CancellationToken* token);
+
+    /* nullptr when the pool is exhausted, the token goes back to the pool with the source */
     CancellationToken* create_linked_token();
 private:
-    vector<CancellationToken*> _tokens;
+    CancellationToken* _tokens[CANCELLATION_TOKEN_POOL_SIZE] = { };
+    uint8_t _num_tokens = 0;
+    uint8_t _owned_mask = 0;
 };
 
 #endif
\ No newline at end of file
@@ -7,20 +7,31 @@
 #include <driver/gpio.h>
 #include <driver/uart.h>
 
+#include "door_timing.h"
+
 /* System */
 #define DEV_ID                                      "YOUR-DEV-ID"
 #define DEV_NAME                                    "SLS-PROTO-V1"
 #define FREERTOS_DEFAULT_STACK_SIZE                 ( 8192 )
-#define MAX_PWD_LEN                                 ( 64 )
 #define DEFAULT_ACTIVITY_REM_TIME                   ( 30 * 1000 )
+#define DEFAULT_EVENT_CAPTURE                       ( 0 )
 
 /* Main Tasks */
 #define TASK_MAX_WAIT_TIME_MS   ( 15000 )
-#define KEY_SCAN_DELAY          ( 250 )
 #define FP_SCAN_DELAY           ( 250 )
 #define INIT_AUZRE_DELAY        ( 3000 )
 #define SEND_TEL_DELAY          ( 3000 )
 #define RECV_CMDS_DELAY         ( 3000 )
+#define AZURE_LOOP_YIELD_DELAY  ( 10 )
+
+/* Reactor */
+#define REACTOR_QUEUE_SIZE      ( 32 )
+#define ACTION_QUEUE_SIZE       ( 8 )
+#define FP_JOB_QUEUE_SIZE       ( 2 )
+
+/* Power Management */
+#define PM_MAX_CPU_FREQ_MHZ     ( CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ )
+#define PM_MIN_CPU_FREQ_MHZ     ( 40 )
 
 /* Azure Device Provisioning Service */
 #define AZURE_IOT_DPS_ENDPOINT_HOSTNAME             "global.azure-devices-provisioning.net"
@@ -35,6 +46,9 @@
 
 #define AZURE_IOT_DPS_REG_TIMEOUT_MS                ( 3 * 1000U )
 
+#define AZURE_IOT_DPS_CACHE_VERSION                 ( 1U )
+#define AZURE_IOT_DPS_CACHE_MAX_AGE_S               ( 30 * 24 * 60 * 60ULL )
+
 /* Azure IoT Hub */
 
 #define AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN          ( 128U )
@@ -46,18 +60,24 @@
 #define AZURE_IOT_HUB_MODEL_ID                      AZURE_IOT_DPS_MODEL_ID
 
 #define AZURE_IOT_HUB_TEL_BUF_LEN               ( 128U )
-#define AZURE_IOT_HUB_TEL_FORMAT                "{\"status\":%d, \"desc\":\"%s\"}"
+#define AZURE_IOT_HUB_TEL_FORMAT                "{\"status\":%d, \"desc\":\"%s\", \"ts\":%llu}"
 
 #define AZURE_IOT_HUB_TEL_ACK_WAIT_INTERVAL   ( 500U )
 #define AZURE_IOT_HUB_TEL_ACK_TIMEOUT_MS      ( 5 * 1000U )
 #define AZURE_IOT_HUB_TEL_ACK_MAX_WAIT_COUNT  ( 5 )
 #define AZURE_IOT_HUB_TEL_QUEUE_SIZE          ( 100 )
+#define RTC_OUTBOX_SIZE                       ( 16 )
 
 #define AZURE_IOT_HUB_CONNACK_RECV_TIMEOUT_MS       ( 10 * 1000U )
 
 #define AZURE_IOT_HUB_SUBSCRIBE_TIMEOUT_MS          ( 10 * 1000U)
 #define AZURE_IOT_HUB_PROCESS_LOOP_TIMEOUT_MS       ( 500U )
 
+#define AZURE_IOT_HUB_CMD_UNLOCK                    "unlock"
+#define AZURE_IOT_HUB_CMD_LOCK                      "lock"
+#define AZURE_IOT_HUB_CMD_STATUS                    "status"
+#define AZURE_IOT_HUB_CMD_TO_MOTOR_TARGET_US        ( 20 * 1000U )
+
 /* Fingerprint Reader */
 #define FP_READER_PWR_TR_BASE_PORT  ( GPIO_NUM_42 )
 #define FP_READER_UART_PORT         ( UART_NUM_1 )
@@ -69,6 +89,7 @@
 #define FP_READER_TOUCH_PWR_PORT    ( GPIO_NUM_10 )
 
 /* PIR Sensor */
+#define PIR_SENSOR_ENABLED          ( false )
 #define PIR_SENSOR_PWR_PORT         ( GPIO_NUM_0 )
 #define PIR_SENSOR_RX_PORT          ( GPIO_NUM_0 )
 
@@ -106,11 +127,11 @@ constexpr i2s_std_gpio_config_t i2s_gpio_cfg = i2s_std_gpio_config_t {
 
 /* NVS */
 #define NVS_KEY_PASSWORD  ( "pwd" )
+#define NVS_KEY_PIN_SALT  ( "pin_salt" )
+#define NVS_KEY_DPS_CACHE ( "dps_cache" )
+#define NVS_KEY_SETTINGS  ( "settings" )
 #define DEFAULT_PASSWORD  ( "0000" )
 
-/* System */
-#define MAX_ALLOWED_PWD_MISMATCH_CNT ( 3 )
-
 /* Wifi Station */
 #define WIFI_AP_SSID        ( "YOUR-WIFI_SSID" )
 #define WIFI_AP_PASSWORD    ( "YOUR-WIFI-PASSWORD" )
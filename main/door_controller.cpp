@@ -0,0 +1,279 @@
+#include "door_controller.h"
+
+DoorController::DoorController(Clock& clock, KeypadMatrix& keypad, DoorEffects& effects)
+    : _clock(clock), _keypad(keypad), _effects(effects), _fsm(MAX_ALLOWED_PWD_MISMATCH_CNT)
+{
+    for (auto& time: _last_btn_pressed_time)
+        time = -BTN_DEBOUNCE_MS * 1000LL;
+
+    _pressed_keys.reserve(MAX_PWD_LEN);
+    _new_password.reserve(MAX_PWD_LEN);
+}
+
+void DoorController::restore(DoorState state, uint8_t pwd_mismatch_cnt, uint8_t fingerprint_mismatch_cnt, DoorStatus door_status, int64_t lockdown_left_ms)
+{
+    _fsm.restore(state, pwd_mismatch_cnt, fingerprint_mismatch_cnt);
+
+    if (_fsm.is_lockdown())
+    {
+        if (lockdown_left_ms > 0)
+            _effects.start_timer(DoorTimer::Lockdown, static_cast<uint32_t>(lockdown_left_ms));
+        else
+            _fsm.step(DoorInput::LockdownExpired);
+    }
+
+    if (door_status == DoorStatus::Opened)
+    {
+        if (_fsm.get_state() == DoorState::Unlocked)
+            _effects.start_timer(DoorTimer::AutoClose, _effects.get_timeout_ms(DoorTimer::AutoClose));
+        else
+            _effects.post_action({ ActionType::CloseDoor, AudioName::Beep, 0, _clock.now_us() });
+    }
+}
+
+void DoorController::on_button(LockButton button, int64_t time_us)
+{
+    int64_t& last_pressed_time = _last_btn_pressed_time[static_cast<size_t>(button)];
+
+    /* Edge interrupts bounce, one press per BTN_DEBOUNCE_MS */
+    if (time_us - last_pressed_time < BTN_DEBOUNCE_MS * 1000LL)
+        return;
+
+    last_pressed_time = time_us;
+    _effects.on_activity();
+
+    if (button == LockButton::Door)
+        _dispatch(DoorInput::DoorButton, time_us);
+    else if (button == LockButton::Reset)
+        _effects.reset_system();
+    else if (button == LockButton::Enroll)
+        _dispatch(DoorInput::EnrollButton, time_us);
+}
+
+void DoorController::on_key_activity(int64_t time_us)
+{
+    if (!_fsm.is_accepting_keys() || time_us - _last_key_pressed_time < KEY_DEBOUNCE_MS * 1000LL)
+        return;
+
+    char key = _keypad.get_pressed_key();
+
+    if (key == '\0')
+        return;
+
+    _last_key_pressed_time = time_us;
+    _effects.on_key_scanned(key, time_us);
+    _effects.on_activity();
+
+    if (key >= '0' && key <= '9')
+    {
+        if (_fsm.get_state() == DoorState::Unlocked)
+            return;
+
+        if (_pressed_keys.size() == MAX_PWD_LEN)
+            return;
+
+        if (_pressed_keys.empty())
+            _effects.on_entry_started();
+
+        _pressed_keys.push_back(key);
+    }
+
+    _play(AudioName::Beep, 1, time_us);
+
+    if (key == '*' || key == '#')
+        _flush_keys(key, time_us);
+}
+
+void DoorController::on_finger_touched(int64_t time_us)
+{
+    if (!_fsm.is_accepting_fingerprint())
+        return;
+
+    _effects.on_activity();
+    _effects.start_search(time_us);
+}
+
+/* Stamped when the search finished, not when the finger went down */
+void DoorController::on_fingerprint_searched(bool is_found, int64_t time_us)
+{
+    _effects.on_activity();
+    _dispatch(is_found ? DoorInput::FingerprintOk : DoorInput::FingerprintMismatch, time_us);
+}
+
+void DoorController::on_enrollment_done(bool is_enrolled, int64_t time_us)
+{
+    _effects.on_activity();
+    _dispatch(is_enrolled ? DoorInput::EnrollOk : DoorInput::EnrollFailed, time_us);
+}
+
+void DoorController::on_timer(DoorTimer timer, int64_t time_us)
+{
+    _dispatch(timer == DoorTimer::Lockdown ? DoorInput::LockdownExpired : DoorInput::AutoCloseDue, time_us);
+}
+
+void DoorController::on_remote_command(DoorCommand command, int64_t time_us)
+{
+    _effects.on_activity();
+    _dispatch(command == DoorCommand::Open ? DoorInput::RemoteUnlock : DoorInput::RemoteLock, time_us);
+}
+
+/* Only key beeps carry their event time */
+void DoorController::_play(AudioName audio, int play_count, int64_t time_us)
+{
+    _effects.post_action({ ActionType::PlayAudio, audio, play_count, time_us });
+}
+
+/* Turns a finished entry into an FSM input, what the keys mean depends on the state */
+void DoorController::_flush_keys(char key, int64_t time_us)
+{
+    EntryMatch_t match = _effects.match_entry(_pressed_keys, _new_password);
+    DoorInput input = _fsm.classify_entry(key, match.password, match.confirmation);
+
+    _effects.on_entry(match, time_us);
+
+    if (input != DoorInput::Count)
+        _dispatch(input, time_us);
+
+    _pressed_keys.clear();
+}
+
+void DoorController::_dispatch(DoorInput input, int64_t time_us)
+{
+    DoorState from = _fsm.get_state();
+    const DoorTransition_t* transition = _fsm.step(input);
+
+    if (transition == nullptr)
+        return;
+
+    _effects.on_transition(from, input, transition->to, time_us);
+
+    for (const auto& command: transition->commands)
+        _exec(command, time_us);
+}
+
+/* Everything here only queues work, so a transition never blocks the reactor */
+void DoorController::_exec(FsmCommand command, int64_t time_us)
+{
+    switch (command)
+    {
+        case FsmCommand::None:
+        case FsmCommand::ResetMismatch:
+            break;
+
+        /* time_us is the triggering event's post time, the actuator measures event-to-motor latency from it */
+        case FsmCommand::OpenDoor:
+            _effects.post_action({ ActionType::OpenDoor, AudioName::Beep, 0, time_us });
+            break;
+
+        case FsmCommand::CloseDoor:
+            _effects.post_action({ ActionType::CloseDoor, AudioName::Beep, 0, time_us });
+            break;
+
+        case FsmCommand::PlayBeep:
+            _play(AudioName::Beep);
+            break;
+
+        case FsmCommand::PlayBeep2:
+            _play(AudioName::Beep, 2);
+            break;
+
+        case FsmCommand::PlayBeep3:
+            _play(AudioName::Beep, 3);
+            break;
+
+        case FsmCommand::PlayRepeatAgain:
+            _play(AudioName::RepeatAgain);
+            break;
+
+        case FsmCommand::PlaySiren:
+            _play(AudioName::Siren, 30);
+            break;
+
+        case FsmCommand::PlayEnrolled:
+            _play(AudioName::Enrolled);
+            break;
+
+        case FsmCommand::PlayEnrollmentFailed:
+            _play(AudioName::EnrollmentFailed);
+            break;
+
+        case FsmCommand::StartLockdownTimer:
+            _effects.start_timer(DoorTimer::Lockdown, _effects.get_timeout_ms(DoorTimer::Lockdown));
+            break;
+
+        case FsmCommand::StopLockdownTimer:
+            _effects.stop_timer(DoorTimer::Lockdown);
+            break;
+
+        case FsmCommand::StoreNewPassword:
+            _new_password = _pressed_keys;
+            break;
+
+        case FsmCommand::SavePassword:
+            _effects.save_password(_new_password);
+            break;
+
+        case FsmCommand::StartEnrollment:
+            _effects.start_enrollment();
+            break;
+
+        case FsmCommand::TelPasswordMismatch:
+            _effects.push_tel(TelemetryMessageStatus::PasswordMismatch);
+            break;
+
+        case FsmCommand::TelFingerprintMismatch:
+            _effects.push_tel(TelemetryMessageStatus::FingerprintMismatch);
+            break;
+
+        case FsmCommand::TelLockdownPassword:
+            _effects.push_tel(TelemetryMessageStatus::LockdownCausePasswordMismatch);
+            break;
+
+        case FsmCommand::TelLockdownFingerprint:
+            _effects.push_tel(TelemetryMessageStatus::LockdownCauseFingerprintMismatch);
+            break;
+
+        case FsmCommand::TelPasswordChanged:
+            _effects.push_tel(TelemetryMessageStatus::PasswordChanged);
+            break;
+
+        case FsmCommand::TelEnrolled:
+            _effects.push_tel(TelemetryMessageStatus::FingerprintEnrolled);
+            break;
+
+        case FsmCommand::TelEnrollmentFailed:
+            _effects.push_tel(TelemetryMessageStatus::FingerprintEnrollmentFailed);
+            break;
+    }
+}
+
+void DoorActuator::run(const Action_t& action)
+{
+    _effects.on_action_started(action, _clock.now_us() - action.time_us);
+
+    if (action.type == ActionType::PlayAudio)
+        _audio.play(action.audio, action.play_count);
+    else
+        _move_door(action.type == ActionType::OpenDoor);
+
+    _effects.on_action_done(action);
+}
+
+/* Only the actuator writes the status, so nothing is held across the motor run and the audio */
+void DoorActuator::_move_door(bool open)
+{
+    if (_door_status.load() != (open ? DoorStatus::Closed : DoorStatus::Opened))
+        return;
+
+    _motor.run(open, DOOR_MOTOR_RUN_MS);
+    _audio.play(open ? AudioName::Opened : AudioName::Closed);
+    _door_status.store(open ? DoorStatus::Opened : DoorStatus::Closed);
+
+    /* Auto-close counts from the end of the run and the clip */
+    if (open)
+        _effects.start_timer(DoorTimer::AutoClose, _effects.get_timeout_ms(DoorTimer::AutoClose));
+    else
+        _effects.stop_timer(DoorTimer::AutoClose);
+
+    _effects.push_tel(open ? TelemetryMessageStatus::Opened : TelemetryMessageStatus::Closed);
+}
@@ -0,0 +1,182 @@
+#ifndef _H_DOOR_CONTROLLER_H_
+#define _H_DOOR_CONTROLLER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "door_fsm.h"
+#include "door_timing.h"
+#include "hal/hal.h"
+
+/*
+ * Input handling and command execution of the reactor, and the actuator's action loop.
+ * Only the HAL and an injected clock and effects sink, so host_sim runs this same code.
+ */
+
+enum class DoorStatus
+{
+    None,
+    Closed,
+    Opened,
+};
+
+enum class TelemetryMessageStatus : uint16_t
+{
+    Opened = 1,
+    Closed,
+    PasswordMismatch,
+    FingerprintMismatch,
+    LockdownCausePasswordMismatch,
+    LockdownCauseFingerprintMismatch,
+    PasswordChanged,
+    StartFingerprintEnrollment,
+    FingerprintEnrolled,
+    FingerprintEnrollmentFailed,
+    NotEnoughBattery,
+    SystemBooted,
+};
+
+enum class DoorCommand
+{
+    Open,
+    Close,
+};
+
+enum class ActionType
+{
+    OpenDoor,
+    CloseDoor,
+    PlayAudio,
+};
+
+typedef struct Action_s
+{
+    ActionType type;
+    AudioName audio;
+    int play_count;
+    int64_t time_us;        /* When the triggering event was posted */
+} Action_t;
+
+/* Same order as BTN_GPIOS, the index is what ButtonEdge records carry */
+enum class LockButton : uint8_t
+{
+    Reset,
+    Door,
+    Enroll,
+    Count,
+};
+
+enum class DoorTimer : uint8_t
+{
+    AutoClose,
+    Lockdown,
+};
+
+/* What a finished entry matched */
+typedef struct EntryMatch_s
+{
+    bool password;
+    bool confirmation;      /* The new password being confirmed */
+} EntryMatch_t;
+
+/*
+ * Everything the door logic does to the rest of the system. app_main.cpp backs it with queues, esp_timers and NVS,
+ * host_sim with fakes. The timer and telemetry calls also come from the actuator, the rest only from the reactor.
+ */
+class DoorEffects
+{
+public:
+    virtual ~DoorEffects() { }
+
+    /* To the actuator, must not block */
+    virtual void post_action(const Action_t& action) = 0;
+
+    /* One-shot, a start replaces a pending expiry, which comes back as DoorController::on_timer() */
+    virtual uint32_t get_timeout_ms(DoorTimer timer) = 0;
+    virtual void start_timer(DoorTimer timer, uint32_t timeout_ms) = 0;
+    virtual void stop_timer(DoorTimer timer) = 0;
+
+    virtual void push_tel(TelemetryMessageStatus status) = 0;
+
+    virtual EntryMatch_t match_entry(const std::string& keys, const std::string& new_password) = 0;
+    virtual void save_password(const std::string& password) = 0;
+
+    /* Sensor jobs, the results come back as on_fingerprint_searched() and on_enrollment_done() */
+    virtual void start_search(int64_t time_us) = 0;
+    virtual void start_enrollment() = 0;
+
+    virtual void reset_system() = 0;
+
+    /* Observers, the device traces and records them */
+    virtual void on_activity() { }
+    virtual void on_entry_started() { }
+    virtual void on_key_scanned(char key, int64_t time_us) { }
+    virtual void on_entry(const EntryMatch_t& match, int64_t time_us) { }
+    virtual void on_transition(DoorState from, DoorInput input, DoorState to, int64_t time_us) { }
+    virtual void on_action_started(const Action_t& action, int64_t latency_us) { }
+    virtual void on_action_done(const Action_t& action) { }
+};
+
+/* Reactor side, every call comes from the one task that owns the FSM */
+class DoorController
+{
+public:
+    DoorController(Clock& clock, KeypadMatrix& keypad, DoorEffects& effects);
+
+    const DoorFsm& get_fsm() const { return _fsm; }
+
+    /* Warm start, before any input. lockdown_left_ms 0 means the lockdown ran out while asleep */
+    void restore(DoorState state, uint8_t pwd_mismatch_cnt, uint8_t fingerprint_mismatch_cnt, DoorStatus door_status, int64_t lockdown_left_ms);
+
+    /* Inputs, time_us is when the event was posted */
+    void on_button(LockButton button, int64_t time_us);
+    void on_key_activity(int64_t time_us);
+    void on_finger_touched(int64_t time_us);
+    void on_fingerprint_searched(bool is_found, int64_t time_us);
+    void on_enrollment_done(bool is_enrolled, int64_t time_us);
+    void on_timer(DoorTimer timer, int64_t time_us);
+    void on_remote_command(DoorCommand command, int64_t time_us);
+
+private:
+    Clock& _clock;
+    KeypadMatrix& _keypad;
+    DoorEffects& _effects;
+
+    DoorFsm _fsm;
+    std::string _pressed_keys;
+    std::string _new_password;
+    int64_t _last_key_pressed_time = -KEY_DEBOUNCE_MS * 1000LL;
+    int64_t _last_btn_pressed_time[static_cast<size_t>(LockButton::Count)];
+
+    void _play(AudioName audio, int play_count = 1, int64_t time_us = 0);
+    void _flush_keys(char key, int64_t time_us);
+    void _dispatch(DoorInput input, int64_t time_us);
+    void _exec(FsmCommand command, int64_t time_us);
+};
+
+/* Motor runs and clips block for up to seconds, so they run here instead of on the reactor */
+class DoorActuator
+{
+public:
+    DoorActuator(Clock& clock, DoorMotor& motor, AudioSink& audio, DoorEffects& effects) : _clock(clock), _motor(motor), _audio(audio), _effects(effects) { }
+
+    /* Physical position, only run() writes it after the restore. Safe to read from any task */
+    DoorStatus get_door_status() const { return _door_status.load(); }
+    void restore(DoorStatus door_status) { _door_status.store(door_status); }
+
+    void run(const Action_t& action);
+
+private:
+    Clock& _clock;
+    DoorMotor& _motor;
+    AudioSink& _audio;
+    DoorEffects& _effects;
+
+    std::atomic<DoorStatus> _door_status { DoorStatus::Closed };
+
+    void _move_door(bool open);
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "door_fsm.h"
+
+bool DoorFsm::is_busy() const
+{
+    return _state == DoorState::PasswordChange || _state == DoorState::PasswordConfirm || _state == DoorState::Enrolling;
+}
+
+bool DoorFsm::is_accepting_keys() const
+{
+    return _state != DoorState::Lockdown && _state != DoorState::Enrolling;
+}
+
+DoorInput DoorFsm::classify_entry(char terminator, bool password_matches, bool confirmation_matches) const
+{
+    switch (_state)
+    {
+        case DoorState::Locked:
+            if (!password_matches)
+                return DoorInput::PasswordMismatch;
+
+            return terminator == '*' ? DoorInput::PasswordOk : DoorInput::ChangeRequested;
+
+        case DoorState::Unlocked:
+            return terminator == '*' ? DoorInput::CloseKey : DoorInput::Count;
+
+        case DoorState::PasswordChange:
+            return DoorInput::NewPasswordEntered;
+
+        case DoorState::PasswordConfirm:
+            return confirmation_matches ? DoorInput::PasswordConfirmed : DoorInput::PasswordMismatch;
+
+        default:
+            return DoorInput::Count;
+    }
+}
+
+const DoorTransition_t* DoorFsm::step(DoorInput input)
+{
+    /* Mismatch limits are the only guards, they only count while locked */
+    if (_state == DoorState::Locked)
+    {
+        if (input == DoorInput::PasswordMismatch && ++_pwd_mismatch_cnt >= _max_mismatch)
+            input = DoorInput::PasswordMismatchLimit;
+        else if (input == DoorInput::FingerprintMismatch && ++_fingerprint_mismatch_cnt >= _max_mismatch)
+            input = DoorInput::FingerprintMismatchLimit;
+    }
+
+    const DoorTransition_t& transition = door_fsm::lookup(_state, input);
+
+    if (!transition.valid)
+        return nullptr;
+
+    for (const auto& command: transition.commands)
+    {
+        if (command == FsmCommand::ResetMismatch)
+        {
+            _pwd_mismatch_cnt = 0;
+            _fingerprint_mismatch_cnt = 0;
+        }
+    }
+
+    _state = transition.to;
+    return &transition;
+}
+
+void DoorFsm::restore(DoorState state, uint8_t pwd_mismatch_cnt, uint8_t fingerprint_mismatch_cnt)
+{
+    bool resumable = state == DoorState::Locked || state == DoorState::Unlocked || state == DoorState::Lockdown;
+
+    _state = resumable ? state : DoorState::Locked;
+    _pwd_mismatch_cnt = pwd_mismatch_cnt < _max_mismatch ? pwd_mismatch_cnt : 0;
+    _fingerprint_mismatch_cnt = fingerprint_mismatch_cnt < _max_mismatch ? fingerprint_mismatch_cnt : 0;
+}
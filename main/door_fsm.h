@@ -0,0 +1,196 @@
+#ifndef _H_DOOR_FSM_H_
+#define _H_DOOR_FSM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Pure logic, no ESP-IDF headers, so it also builds on the host */
+
+using namespace std;
+
+enum class DoorState : uint8_t
+{
+    Locked,
+    Unlocked,
+    Lockdown,
+    PasswordChange,         /* Waiting for the new password */
+    PasswordConfirm,        /* Waiting for the new password again */
+    Enrolling,
+    Count,
+};
+
+enum class DoorInput : uint8_t
+{
+    DoorButton,
+    EnrollButton,
+    CloseKey,
+    PasswordOk,
+    PasswordMismatch,
+    PasswordMismatchLimit,  /* Derived by step() from PasswordMismatch */
+    ChangeRequested,
+    NewPasswordEntered,
+    PasswordConfirmed,
+    FingerprintOk,
+    FingerprintMismatch,
+    FingerprintMismatchLimit, /* Derived by step() from FingerprintMismatch */
+    EnrollOk,
+    EnrollFailed,
+    AutoCloseDue,
+    LockdownExpired,
+    RemoteUnlock,
+    RemoteLock,
+    Count,
+};
+
+/* Side effects, executed by the caller outside of any lock */
+enum class FsmCommand : uint8_t
+{
+    None,
+    OpenDoor,
+    CloseDoor,
+    PlayBeep,
+    PlayBeep2,
+    PlayBeep3,
+    PlayRepeatAgain,
+    PlaySiren,
+    PlayEnrolled,
+    PlayEnrollmentFailed,
+    ResetMismatch,          /* Handled by the FSM itself */
+    StartLockdownTimer,
+    StopLockdownTimer,
+    StoreNewPassword,
+    SavePassword,
+    StartEnrollment,
+    TelPasswordMismatch,
+    TelFingerprintMismatch,
+    TelLockdownPassword,
+    TelLockdownFingerprint,
+    TelPasswordChanged,
+    TelEnrolled,
+    TelEnrollmentFailed,
+};
+
+#define DOOR_FSM_MAX_COMMANDS ( 6 )
+
+typedef struct DoorTransition_s
+{
+    bool valid;
+    DoorState to;
+    FsmCommand commands[DOOR_FSM_MAX_COMMANDS];
+} DoorTransition_t;
+
+typedef struct DoorRule_s
+{
+    DoorState from;
+    DoorInput input;
+    DoorTransition_t transition;
+} DoorRule_t;
+
+namespace door_fsm
+{
+    using S = DoorState;
+    using I = DoorInput;
+    using C = FsmCommand;
+
+    constexpr DoorRule_t RULES[] = {
+        /* Locked */
+        { S::Locked,          I::DoorButton,               { true, S::Unlocked,        { C::OpenDoor, C::ResetMismatch } } },
+        { S::Locked,          I::EnrollButton,             { true, S::Enrolling,       { C::PlayBeep3, C::StartEnrollment } } },
+        { S::Locked,          I::PasswordOk,               { true, S::Unlocked,        { C::OpenDoor, C::ResetMismatch } } },
+        { S::Locked,          I::PasswordMismatch,         { true, S::Locked,          { C::PlayRepeatAgain, C::TelPasswordMismatch } } },
+        { S::Locked,          I::PasswordMismatchLimit,    { true, S::Lockdown,        { C::PlaySiren, C::StartLockdownTimer, C::ResetMismatch, C::TelLockdownPassword } } },
+        { S::Locked,          I::ChangeRequested,          { true, S::PasswordChange,  { C::PlayBeep2, C::ResetMismatch } } },
+        { S::Locked,          I::FingerprintOk,            { true, S::Unlocked,        { C::OpenDoor, C::ResetMismatch } } },
+        { S::Locked,          I::FingerprintMismatch,      { true, S::Locked,          { C::PlayRepeatAgain, C::TelFingerprintMismatch } } },
+        { S::Locked,          I::FingerprintMismatchLimit, { true, S::Lockdown,        { C::PlaySiren, C::StartLockdownTimer, C::ResetMismatch, C::TelFingerprintMismatch, C::TelLockdownFingerprint } } },
+        { S::Locked,          I::RemoteUnlock,             { true, S::Unlocked,        { C::OpenDoor, C::ResetMismatch } } },
+
+        /* Unlocked */
+        { S::Unlocked,        I::DoorButton,               { true, S::Locked,          { C::CloseDoor, C::ResetMismatch } } },
+        { S::Unlocked,        I::EnrollButton,             { true, S::Enrolling,       { C::CloseDoor, C::PlayBeep3, C::StartEnrollment } } },
+        { S::Unlocked,        I::CloseKey,                 { true, S::Locked,          { C::CloseDoor } } },
+        { S::Unlocked,        I::AutoCloseDue,             { true, S::Locked,          { C::CloseDoor } } },
+        { S::Unlocked,        I::RemoteLock,               { true, S::Locked,          { C::CloseDoor } } },
+
+        /* Lockdown, keypad and fingerprint are ignored until the timer expires */
+        { S::Lockdown,        I::DoorButton,               { true, S::Unlocked,        { C::OpenDoor, C::StopLockdownTimer, C::ResetMismatch } } },
+        { S::Lockdown,        I::EnrollButton,             { true, S::Enrolling,       { C::StopLockdownTimer, C::PlayBeep3, C::StartEnrollment } } },
+        { S::Lockdown,        I::LockdownExpired,          { true, S::Locked,          { } } },
+        { S::Lockdown,        I::RemoteUnlock,             { true, S::Unlocked,        { C::OpenDoor, C::StopLockdownTimer, C::ResetMismatch } } },
+
+        /* Password change */
+        { S::PasswordChange,  I::DoorButton,               { true, S::Unlocked,        { C::OpenDoor } } },
+        { S::PasswordChange,  I::EnrollButton,             { true, S::Enrolling,       { C::PlayBeep3, C::StartEnrollment } } },
+        { S::PasswordChange,  I::NewPasswordEntered,       { true, S::PasswordConfirm, { C::StoreNewPassword, C::PlayBeep3 } } },
+        { S::PasswordConfirm, I::DoorButton,               { true, S::Unlocked,        { C::OpenDoor } } },
+        { S::PasswordConfirm, I::EnrollButton,             { true, S::Enrolling,       { C::PlayBeep3, C::StartEnrollment } } },
+        { S::PasswordConfirm, I::PasswordConfirmed,        { true, S::Locked,          { C::SavePassword, C::PlayEnrolled, C::TelPasswordChanged } } },
+        { S::PasswordConfirm, I::PasswordMismatch,         { true, S::PasswordConfirm, { C::PlayRepeatAgain, C::TelPasswordMismatch } } },
+
+        /* Enrollment, the door button still lets people out */
+        { S::Enrolling,       I::DoorButton,               { true, S::Enrolling,       { C::OpenDoor } } },
+        { S::Enrolling,       I::AutoCloseDue,             { true, S::Enrolling,       { C::CloseDoor } } },
+        { S::Enrolling,       I::EnrollOk,                 { true, S::Locked,          { C::CloseDoor, C::PlayEnrolled, C::TelEnrolled } } },
+        { S::Enrolling,       I::EnrollFailed,             { true, S::Locked,          { C::CloseDoor, C::PlayEnrollmentFailed, C::TelEnrollmentFailed } } },
+    };
+
+    constexpr size_t NUM_STATES = static_cast<size_t>(S::Count);
+    constexpr size_t NUM_INPUTS = static_cast<size_t>(I::Count);
+
+    using Table = array<array<DoorTransition_t, NUM_INPUTS>, NUM_STATES>;
+
+    constexpr Table build_table()
+    {
+        Table table = { };
+
+        for (const auto& rule: RULES)
+            table[static_cast<size_t>(rule.from)][static_cast<size_t>(rule.input)] = rule.transition;
+
+        return table;
+    }
+
+    /* Dense state x input table, a step is one indexed load */
+    constexpr Table TABLE = build_table();
+
+    constexpr const DoorTransition_t& lookup(S state, I input)
+    {
+        return TABLE[static_cast<size_t>(state)][static_cast<size_t>(input)];
+    }
+
+    static_assert(lookup(S::Locked, I::PasswordOk).to == S::Unlocked, "password unlocks");
+    static_assert(lookup(S::Lockdown, I::PasswordOk).valid == false, "lockdown ignores the keypad");
+    static_assert(lookup(S::Unlocked, I::AutoCloseDue).commands[0] == C::CloseDoor, "auto close closes the door");
+}
+
+class DoorFsm
+{
+public:
+    DoorFsm(uint8_t max_mismatch) : _max_mismatch(max_mismatch) { }
+
+    DoorState get_state() const { return _state; }
+    uint8_t get_pwd_mismatch_cnt() const { return _pwd_mismatch_cnt; }
+    uint8_t get_fingerprint_mismatch_cnt() const { return _fingerprint_mismatch_cnt; }
+
+    bool is_busy() const;
+    bool is_accepting_keys() const;
+    bool is_accepting_fingerprint() const { return _state == DoorState::Locked; }
+    bool is_lockdown() const { return _state == DoorState::Lockdown; }
+
+    /* What a finished key entry ('*' or '#') means in the current state, Count when it means nothing */
+    DoorInput classify_entry(char terminator, bool password_matches, bool confirmation_matches) const;
+
+    /* Returns nullptr when the input has no effect in the current state */
+    const DoorTransition_t* step(DoorInput input);
+
+    /* Warm start only, interactive states cannot be resumed and fall back to Locked */
+    void restore(DoorState state, uint8_t pwd_mismatch_cnt, uint8_t fingerprint_mismatch_cnt);
+
+private:
+    DoorState _state = DoorState::Locked;
+    uint8_t _max_mismatch;
+    uint8_t _pwd_mismatch_cnt = 0;
+    uint8_t _fingerprint_mismatch_cnt = 0;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef _H_DOOR_TIMING_H_
+#define _H_DOOR_TIMING_H_
+
+/* Limits and timings of the door logic. No ESP-IDF headers, config.h and host_sim both build against these */
+
+#define MAX_PWD_LEN                     ( 64 )
+#define MAX_ALLOWED_PWD_MISMATCH_CNT    ( 3 )
+#define DEFAULT_AUTO_CLOSE_TIME_S       ( 5 )
+#define DEFAULT_LOCKDOWN_TIME_S         ( 30 )
+#define BTN_DEBOUNCE_MS                 ( 200 )
+#define KEY_DEBOUNCE_MS                 ( 150 )
+#define DOOR_MOTOR_RUN_MS               ( 1000 )
+
+#endif
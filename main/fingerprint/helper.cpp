@@ -7,6 +7,8 @@
 
 #include "cancellationtoken.h"
 #include "task.h"
+#include "helper/deferred_log.h"
+#include "helper/trace.h"
 #include "helper/uart.h"
 #include "helper.h"
 
@@ -31,6 +33,16 @@ FingerprintReaderHelper::FingerprintReaderHelper(FingerprintReader* reader)
 
 FingerprintReaderHelper::~FingerprintReaderHelper() { }
 
+/* Returns early, false, once the token is canceled */
+bool FingerprintReaderHelper::_delay(uint32_t ms)
+{
+    if (cancellation_token)
+        return cancellation_token->delay(pdMS_TO_TICKS(ms));
+
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    return true;
+}
+
 void FingerprintReaderHelper::_get_image(bool wait_to_removed, bool* owner_task_running)
 {
     auto task_type = FingerprintReaderHelper::TaskType::GetImage;
@@ -55,7 +67,7 @@ void FingerprintReaderHelper::_get_image(bool wait_to_removed, bool* owner_task_
         if ((!wait_to_removed && get_reader()->get_last_error() == FINGERPRINT_OK) || (wait_to_removed && get_reader()->get_last_error() == FINGERPRINT_NO_FINGER))
             break;
 
-        vTaskDelay(pdMS_TO_TICKS(1));
+        _delay(1);
     }
 
     if (task_status != EVENT_BITS_TASK_NONE)
@@ -84,7 +96,6 @@ void FingerprintReaderHelper::get_image()
 
     execute_task(   task_get_image, 
                     TASK_NAMES.at(TaskType::GetImage),
-                    DEFAULT_TASK_STACK_SIZE, tskIDLE_PRIORITY,
                     EVENT_BITS_TASK_EXECUTED, pdFALSE, pdTRUE,
                     pdMS_TO_TICKS(DEFAULT_TASK_TIMEOUT),
                     &status_event_handler,
@@ -110,7 +121,7 @@ void FingerprintReaderHelper::enroll(uint16_t id)
 
         while (is_task_running)
         {
-            vTaskDelay(pdMS_TO_TICKS(1));
+            instance->_delay(1);
 
             is_task_running = get_task_status(task_name) == EVENT_BITS_TASK_RUNNING;
 
@@ -121,31 +132,31 @@ void FingerprintReaderHelper::enroll(uint16_t id)
             
             while (i <= 2 && is_task_running)
             {
-                ESP_LOGI(TAG, "(%d) Place finger on sensor", i);
+                DLOGD(FP, TAG, "(%d) Place finger on sensor", i);
                 instance->_get_image(false, &is_task_running);
-                ESP_LOGI(TAG, "(%d) Captured", i);
+                DLOGD(FP, TAG, "(%d) Captured", i);
 
                 EXEC_AND_CONTINUE(reader->image_to_template(i), reader->get_last_error() != FINGERPRINT_OK);
-                ESP_LOGI(TAG, "(%d) Templatized", i);
+                DLOGD(FP, TAG, "(%d) Templatized", i);
 
                 if (reader->get_last_error() != FINGERPRINT_OK)
                     continue;
                 
                 if (i == 1)
                 {
-                    ESP_LOGI(TAG, "(%d) Remove finger from sensor", i);
+                    DLOGD(FP, TAG, "(%d) Remove finger from sensor", i);
                     instance->_get_image(true, &is_task_running);
-                    ESP_LOGI(TAG, "(%d) Removed", i);
+                    DLOGD(FP, TAG, "(%d) Removed", i);
                 }
 
                 ++i;
             }
 
             EXEC_AND_CONTINUE(reader->create_model(), reader->get_last_error() != FINGERPRINT_OK);
-            ESP_LOGI(TAG, "(%d) Modeled", id);
+            DLOGI(FP, TAG, "(%d) Modeled", id);
 
             EXEC_AND_CONTINUE(reader->store_model(id), reader->get_last_error() != FINGERPRINT_OK);
-            ESP_LOGI(TAG, "(%d) Stored", id);
+            DLOGI(FP, TAG, "(%d) Stored", id);
 
             set_task_result(task_name, FingerprintReaderHelper::EVENT_BITS_ENROLLED);
             break;
@@ -162,26 +173,25 @@ void FingerprintReaderHelper::enroll(uint16_t id)
 
         if (get_task_result(task_name) & FingerprintReaderHelper::EVENT_BITS_ENROLLED)
         {
-            ESP_LOGI(TAG, "Successful enrollment");
+            DLOGI(FP, TAG, "Successful enrollment");
              _last_enrollment_status = EVENT_BITS_ENROLLED;
         }
         else
         {
-            ESP_LOGI(TAG, "Failed enrollment");
+            DLOGI(FP, TAG, "Failed enrollment");
              _last_enrollment_status = EVENT_BITS_ENROLLMENT_FAILED;
         }
 
         remove_task(TASK_NAMES.at(TaskType::Enroll));
-        ESP_LOGI(TAG, "Removed task");
+        DLOGD(FP, TAG, "Removed task");
 
         get_reader()->flush();
-        ESP_LOGI(TAG, "Flushed uart buffers");
+        DLOGD(FP, TAG, "Flushed uart buffers");
     };
 
      _last_enrollment_status = EVENT_BITS_ENROLLING;
     execute_task(   task_enroll, 
                     TASK_NAMES.at(TaskType::Enroll),
-                    DEFAULT_TASK_STACK_SIZE, tskIDLE_PRIORITY, 
                     EVENT_BITS_TASK_EXECUTED, pdFALSE, pdTRUE,
                     pdMS_TO_TICKS(DEFAULT_TASK_TIMEOUT),
                     &status_event_handler,
@@ -208,21 +218,24 @@ pair<uint16_t, uint16_t> FingerprintReaderHelper::search(bool fast_search, uint8
 
         while (is_task_running)
         {
-            vTaskDelay(pdMS_TO_TICKS(1));
+            instance->_delay(1);
 
             is_task_running = get_task_status(task_name) == EVENT_BITS_TASK_RUNNING;
             
             if (instance->cancellation_token)
                 is_task_running &= !instance->cancellation_token->is_cancellation_requested();
 
-            ESP_LOGI(TAG, "Place finger on sensor");
+            DLOGD(FP, TAG, "Place finger on sensor");
             instance->_get_image(false, &is_task_running);
-            ESP_LOGI(TAG, "Captured");
+            DLOGD(FP, TAG, "Captured");
+            TRACE(FpCaptured, 0);
 
             EXEC_AND_CONTINUE(reader->image_to_template(1), reader->get_last_error() != FINGERPRINT_OK);
-            ESP_LOGI(TAG, "Templatized");
+            DLOGD(FP, TAG, "Templatized");
+            TRACE(FpTemplated, 0);
 
             *res = reader->search(fast_search, slot);
+            TRACE(FpSearched, reader->get_last_error() == FINGERPRINT_OK);
 
             if (reader->get_last_error() == FINGERPRINT_OK || reader->get_last_error() == FINGERPRINT_NOT_FOUND)
             {
@@ -242,22 +255,21 @@ pair<uint16_t, uint16_t> FingerprintReaderHelper::search(bool fast_search, uint8
 
         if (get_task_result(task_name) == FingerprintReaderHelper::EVENT_BITS_SEARCHED)
         {
-            ESP_LOGI(TAG, "Successful search");
-            ESP_LOGI(TAG, "Id: %d, Confidence: %d", res.first, res.second);
+            DLOGI(FP, TAG, "Successful search");
+            DLOGI(FP, TAG, "Id: %d, Confidence: %d", res.first, res.second);
         }
         else
-            ESP_LOGI(TAG, "Failed search");
+            DLOGI(FP, TAG, "Failed search");
 
         remove_task(TASK_NAMES.at(TaskType::Search));
-        ESP_LOGI(TAG, "Removed task");
+        DLOGD(FP, TAG, "Removed task");
 
         get_reader()->flush();
-        ESP_LOGI(TAG, "Flushed uart buffers");
+        DLOGD(FP, TAG, "Flushed uart buffers");
     };
 
     execute_task(   task_search, 
                     TASK_NAMES.at(TaskType::Search),
-                    DEFAULT_TASK_STACK_SIZE, tskIDLE_PRIORITY, 
                     EVENT_BITS_TASK_EXECUTED, pdFALSE, pdTRUE,
                     pdMS_TO_TICKS(DEFAULT_TASK_TIMEOUT),
                     &status_event_handler,
@@ -6,13 +6,15 @@
 #include <unordered_map>
 #include <utility>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
 #include "cancellationtoken.h"
 #include "reader.h"
 
 class FingerprintReaderHelper
 {
 public:
-    const static uint32_t DEFAULT_TASK_STACK_SIZE = 3072;
     const static TickType_t DEFAULT_TASK_TIMEOUT = 20000;
     
     const static EventBits_t EVENT_BITS_ENROLLMENT_RESERVED = 0x50;
@@ -50,6 +52,7 @@ public:
 
 private:
     FingerprintReader* _reader;
+    bool _delay(uint32_t ms);
     void _get_image(bool wait_to_removed = false, bool* owner_task_running = nullptr);
     
     EventBits_t _last_enrollment_status = EVENT_BITS_ENROLLMENT_RESERVED;
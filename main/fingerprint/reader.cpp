@@ -1,62 +1,18 @@
 #include <numeric>
 #include <utility>
 
-#include <esp_log.h>
-#include <driver/gpio.h>
-#include <driver/uart.h>
-
-#include "helper/uart.h"
 #include "reader.h"
 #include "defs.h"
 
 using namespace std;
 
-static const char* TAG = "FingerprintReader";
+/* No ESP-IDF dependencies, all I/O goes through the SerialPort so the host simulation runs this file as is */
 
 FingerprintReader::FingerprintReader() { }
 
-FingerprintReader::FingerprintReader(uart_port_t uart_num, gpio_num_t tx_num, gpio_num_t rx_num, uint32_t baud_rate)
-{
-    set_reader(uart_num, tx_num, rx_num, baud_rate);
-}
+FingerprintReader::FingerprintReader(SerialPort* port) : _port(port) { }
 
-FingerprintReader::~FingerprintReader()
-{
-    ESP_ERROR_CHECK(uart_driver_delete(_uart_num));
-}
-
-void FingerprintReader::set_reader(uart_port_t uart_num, gpio_num_t tx_num, gpio_num_t rx_num, uint32_t baud_rate)
-{
-    uart_config_t uart_cfg = {
-        .baud_rate = (int)baud_rate,
-        .data_bits = UART_DATA_8_BITS,
-        .parity = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-    };
-
-#if SOC_UART_SUPPORT_XTAL_CLK
-    uart_cfg.source_clk = UART_SCLK_XTAL;
-#elif SOC_UART_SUPPORT_REF_TICK
-    if (baud_rate <= 250000)
-        uart_cfg.source_clk = UART_SCLK_REF_TICK;
-    else
-        uart_cfg.source_clk = UART_SCLK_APB;
-#else
-    uart_cfg.source_clk = UART_SCLK_DEFAULT;
-#endif
-
-    ESP_ERROR_CHECK(uart_driver_install(uart_num, DEFAULT_RX_BUFFER_SIZE, 0, 0, NULL, 0));
-    ESP_ERROR_CHECK(uart_param_config(uart_num, &uart_cfg));
-    ESP_ERROR_CHECK(uart_set_pin(uart_num, tx_num, rx_num, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-    
-    ESP_LOGI(TAG, "Initialized UART(%d): TX: %d, RX: %d, Baud Rate: %d", uart_num, tx_num, rx_num, (int)baud_rate);
-
-    _uart_num = uart_num;
-    _tx_num = tx_num;
-    _rx_num = rx_num;
-    _baud_rate = baud_rate;
-}
+FingerprintReader::~FingerprintReader() { }
 
 void FingerprintReader::flush() 
 {
@@ -163,20 +119,13 @@ bool FingerprintReader::verify_password(uint32_t password)
 uint8_t FingerprintReader::read_packet(FingerprintReaderPacket_t* packet)
 {
     uint8_t byte;
-    uint16_t idx = 0, timer = 0;
+    uint16_t idx = 0;
 
     while (true)
     {
-        while (!can_read(_uart_num))
-        {
-            vTaskDelay(pdMS_TO_TICKS(1));
-            ++timer;
-
-            if (timer >= _read_timeout_ms)
-                return FINGERPRINT_TIMEOUT;
-        }
-
-        byte = read_byte(_uart_num);
+        /* Bytes of one packet arrive back to back, the timeout is really the sensor's think time */
+        if (!_port->read_byte(&byte, _read_timeout_ms))
+            return FINGERPRINT_TIMEOUT;
 
         switch (idx)
         {
@@ -229,18 +178,31 @@ uint8_t FingerprintReader::read_packet(FingerprintReaderPacket_t* packet)
     return FINGERPRINT_BAD_PACKET;
 }
 
+/* One write per packet instead of one per byte */
 void FingerprintReader::write_packet(const FingerprintReaderPacket_t& packet)
 {
+    uint8_t wire[FINGERPRINT_DEFAULT_PACKET_SIZE + 11];
+    size_t len = 0;
+
     uint16_t wire_len = packet.len + 2;
     uint16_t packet_sum = ((wire_len) >> 8) + ((wire_len) & 0xFF) + packet.type;
     packet_sum += accumulate(packet.data, packet.data + packet.len, 0);
 
-    write_uint16_t(_uart_num, packet.start_code);
-    uart_write_bytes(_uart_num, packet.address, sizeof(packet.address));
+    wire[len++] = static_cast<uint8_t>(packet.start_code >> 8);
+    wire[len++] = static_cast<uint8_t>(packet.start_code & 0xFF);
+
+    memcpy(wire + len, packet.address, sizeof(packet.address));
+    len += sizeof(packet.address);
+
+    wire[len++] = packet.type;
+    wire[len++] = static_cast<uint8_t>(wire_len >> 8);
+    wire[len++] = static_cast<uint8_t>(wire_len & 0xFF);
 
-    write_byte(_uart_num, packet.type);
-    write_uint16_t(_uart_num, wire_len);
+    memcpy(wire + len, packet.data, packet.len);
+    len += packet.len;
 
-    uart_write_bytes(_uart_num, packet.data, packet.len);
-    write_uint16_t(_uart_num, packet_sum);
-}
\ No newline at end of file
+    wire[len++] = static_cast<uint8_t>(packet_sum >> 8);
+    wire[len++] = static_cast<uint8_t>(packet_sum & 0xFF);
+
+    _port->write(wire, len);
+}
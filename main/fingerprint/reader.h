@@ -3,12 +3,11 @@
 
 #include <cstring>
 #include <initializer_list>
+#include <type_traits>
 #include <utility>
 
-#include <driver/gpio.h>
-#include <driver/uart.h>
-
 #include "defs.h"
+#include "hal/hal.h"
 
 using namespace std;
 
@@ -65,21 +64,18 @@ typedef struct FingerprintReaderSysParams_s
 class FingerprintReader
 {
 public:
-    const static size_t DEFAULT_RX_BUFFER_SIZE = 256;
-    const static TickType_t DEFAULT_READ_TIMEOUT_MS = 2000;
-    const static TickType_t DEFAULT_WRITE_TIMEOUT_MS = 2000;
+    const static uint32_t DEFAULT_READ_TIMEOUT_MS = 2000;
+    const static uint32_t DEFAULT_WRITE_TIMEOUT_MS = 2000;
 
     FingerprintReader();
-    FingerprintReader(uart_port_t uart_num, gpio_num_t tx_num, gpio_num_t rx_num, uint32_t baud_rate);
+    FingerprintReader(SerialPort* port);
     ~FingerprintReader();
 
-    void set_reader(uart_port_t uart_num, gpio_num_t tx_num, gpio_num_t rx_num, uint32_t baud_rate);
+    /* The port stays owned by the caller, EspUartPort on the device and a sensor model on the host */
+    void set_port(SerialPort* port) { _port = port; }
+    SerialPort* get_port() const { return _port; }
 
     int get_last_error() const { return _error_code; }
-
-    uart_port_t get_uart_num() const { return _uart_num; }
-    gpio_num_t get_tx_num() const { return _tx_num; }
-    gpio_num_t get_rx_num() const { return _rx_num; }
     
     uint32_t get_read_timeout() const { return _read_timeout_ms; }
     void set_read_timeout(uint32_t timeout_ms) { _write_timeout_ms = timeout_ms; }
@@ -138,11 +134,7 @@ public:
 private:
     int _error_code;
 
-    uart_port_t _uart_num;
-    gpio_num_t _tx_num;
-    gpio_num_t _rx_num;
-
-    uint32_t _baud_rate;
+    SerialPort* _port = nullptr;
 
     uint32_t _read_timeout_ms = DEFAULT_READ_TIMEOUT_MS;
     uint32_t _write_timeout_ms = DEFAULT_WRITE_TIMEOUT_MS;
@@ -0,0 +1,165 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "defs.h"
+#include "esp_hal.h"
+#include "helper/power.h"
+
+static const char* TAG = "EspHal";
+
+/* ---------- Clock ---------- */
+int64_t EspClock::now_us() const
+{
+    return esp_timer_get_time();
+}
+/* --------------------------- */
+
+/* ---------- UART ---------- */
+EspUartPort::~EspUartPort()
+{
+    if (_cancellation_token)
+        _cancellation_token->unregister_callback(_on_canceled, this);
+
+    if (_installed)
+        ESP_ERROR_CHECK_WITHOUT_ABORT(uart_driver_delete(_uart_num));
+}
+
+void EspUartPort::set_uart(uart_port_t uart_num, gpio_num_t tx_num, gpio_num_t rx_num, uint32_t baud_rate)
+{
+    uart_config_t uart_cfg = {
+        .baud_rate = (int)baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+    };
+
+#if SOC_UART_SUPPORT_XTAL_CLK
+    uart_cfg.source_clk = UART_SCLK_XTAL;
+#elif SOC_UART_SUPPORT_REF_TICK
+    if (baud_rate <= 250000)
+        uart_cfg.source_clk = UART_SCLK_REF_TICK;
+    else
+        uart_cfg.source_clk = UART_SCLK_APB;
+#else
+    uart_cfg.source_clk = UART_SCLK_DEFAULT;
+#endif
+
+    /* The driver posts every rx chunk to the event queue, a cancel posts there too */
+    ESP_ERROR_CHECK(uart_driver_install(uart_num, DEFAULT_RX_BUFFER_SIZE, 0, DEFAULT_EVENT_QUEUE_SIZE, &_event_queue, 0));
+    ESP_ERROR_CHECK(uart_param_config(uart_num, &uart_cfg));
+    ESP_ERROR_CHECK(uart_set_pin(uart_num, tx_num, rx_num, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+
+    ESP_LOGI(TAG, "Initialized UART(%d): TX: %d, RX: %d, Baud Rate: %d", uart_num, tx_num, rx_num, (int)baud_rate);
+
+    _uart_num = uart_num;
+    _installed = true;
+}
+
+void EspUartPort::write(const uint8_t* data, size_t len)
+{
+    uart_write_bytes(_uart_num, data, len);
+}
+
+void EspUartPort::set_cancellation_token(CancellationToken* token)
+{
+    if (_cancellation_token)
+        _cancellation_token->unregister_callback(_on_canceled, this);
+
+    _cancellation_token = token;
+
+    if (_cancellation_token && !_cancellation_token->register_callback(_on_canceled, this))
+        ESP_LOGE(TAG, "UART(%d) reads cannot be canceled", _uart_num);
+}
+
+/* Not a driver event type, only ever seen by read_byte() */
+void EspUartPort::_on_canceled(void* arg)
+{
+    uart_event_t wake = { };
+    wake.type = UART_EVENT_MAX;
+
+    xQueueSendToFront(static_cast<EspUartPort*>(arg)->_event_queue, &wake, 0);
+}
+
+/* Blocks on the driver's event queue, so either a byte or a cancel ends the wait */
+bool EspUartPort::read_byte(uint8_t* byte, uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    uart_event_t event;
+
+    while (true)
+    {
+        if (_cancellation_token && _cancellation_token->is_cancellation_requested())
+            return false;
+
+        if (uart_read_bytes(_uart_num, byte, 1, 0) == 1)
+            return true;
+
+        TickType_t elapsed = xTaskGetTickCount() - start;
+
+        /* Events left over from bytes already read, or from an earlier cancel, only cost a loop */
+        if (elapsed >= timeout || xQueueReceive(_event_queue, &event, timeout - elapsed) != pdTRUE)
+            return uart_read_bytes(_uart_num, byte, 1, 0) == 1;
+    }
+}
+/* -------------------------- */
+
+/* ---------- Audio ---------- */
+void EspAudioSink::play(AudioName audio, int play_count)
+{
+    _controller.play(audio, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, play_count);
+}
+/* --------------------------- */
+
+/* ---------- Motor ---------- */
+void EspDoorMotor::init()
+{
+    gpio_config_t gpio_cfg = {
+        .pin_bit_mask = BIT64(_pwr_tr_base) | BIT64(_ena_in1) | BIT64(_ena_in2),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_config(&gpio_cfg));
+
+    _set_driver(false);
+}
+
+void EspDoorMotor::run(bool open, uint32_t duration_ms)
+{
+    TickType_t last_time = xTaskGetTickCount();
+
+    /* Light sleep would stretch the run, the lock keeps the timing exact */
+    acquire_power_lock(PowerLock::Motor);
+    _set_driver(true);
+
+    if (open)
+        _set_direction(GPIO_LEVEL_HIGH, GPIO_LEVEL_LOW);
+    else
+        _set_direction(GPIO_LEVEL_LOW, GPIO_LEVEL_HIGH);
+
+    vTaskDelayUntil(&last_time, pdMS_TO_TICKS(duration_ms));
+
+    _set_direction(GPIO_LEVEL_LOW, GPIO_LEVEL_LOW);
+    _set_driver(false);
+    release_power_lock(PowerLock::Motor);
+}
+
+/* The power transistor is active low */
+void EspDoorMotor::_set_driver(bool enabled)
+{
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(_pwr_tr_base, enabled ? GPIO_LEVEL_LOW : GPIO_LEVEL_HIGH));
+}
+
+void EspDoorMotor::_set_direction(uint32_t in1_level, uint32_t in2_level)
+{
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(_ena_in1, in1_level));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_set_level(_ena_in2, in2_level));
+}
+/* --------------------------- */
@@ -0,0 +1,74 @@
+#ifndef _H_ESP_HAL_H_
+#define _H_ESP_HAL_H_
+
+#include <driver/gpio.h>
+#include <driver/uart.h>
+
+#include "cancellationtoken.h"
+#include "hal.h"
+#include "modules/i2s_controller.h"
+
+/* esp_timer, what the reactor stamps events with */
+class EspClock : public Clock
+{
+public:
+    int64_t now_us() const override;
+};
+
+class EspUartPort : public SerialPort
+{
+public:
+    EspUartPort() { }
+    ~EspUartPort();
+
+    void set_uart(uart_port_t uart_num, gpio_num_t tx_num, gpio_num_t rx_num, uint32_t baud_rate);
+
+    /* A cancel wakes a blocked read_byte() at once, which then reports a timeout */
+    void set_cancellation_token(CancellationToken* token);
+
+    void write(const uint8_t* data, size_t len) override;
+    bool read_byte(uint8_t* byte, uint32_t timeout_ms) override;
+
+private:
+    const static size_t DEFAULT_RX_BUFFER_SIZE = 256;
+    const static int DEFAULT_EVENT_QUEUE_SIZE = 8;
+
+    bool _installed = false;
+    uart_port_t _uart_num = UART_NUM_MAX;
+    QueueHandle_t _event_queue = nullptr;
+    CancellationToken* _cancellation_token = nullptr;
+
+    static void _on_canceled(void* arg);
+};
+
+/* 16-bit mono clips, the controller powers the amplifier around each play */
+class EspAudioSink : public AudioSink
+{
+public:
+    EspAudioSink(I2SController& controller) : _controller(controller) { }
+
+    void play(AudioName audio, int play_count = 1) override;
+
+private:
+    I2SController& _controller;
+};
+
+/* L298N behind a power transistor, one direction per door movement */
+class EspDoorMotor : public DoorMotor
+{
+public:
+    EspDoorMotor(gpio_num_t pwr_tr_base, gpio_num_t ena_in1, gpio_num_t ena_in2) : _pwr_tr_base(pwr_tr_base), _ena_in1(ena_in1), _ena_in2(ena_in2) { }
+
+    void init();
+    void run(bool open, uint32_t duration_ms) override;
+
+private:
+    gpio_num_t _pwr_tr_base;
+    gpio_num_t _ena_in1;
+    gpio_num_t _ena_in2;
+
+    void _set_driver(bool enabled);
+    void _set_direction(uint32_t in1_level, uint32_t in2_level);
+};
+
+#endif
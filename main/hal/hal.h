@@ -0,0 +1,62 @@
+#ifndef _H_HAL_H_
+#define _H_HAL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "audio/data/metadata.h"
+
+/*
+ * Device seams under the control logic. No ESP-IDF headers here: the ESP32 backends
+ * live in hal/esp_hal.h, the scripted fakes for the host simulation in host_sim/.
+ */
+
+/* Monotonic microseconds, the time base the input events are stamped in */
+class Clock
+{
+public:
+    virtual ~Clock() { }
+
+    virtual int64_t now_us() const = 0;
+};
+
+/* Byte stream the EF01 fingerprint protocol runs over */
+class SerialPort
+{
+public:
+    virtual ~SerialPort() { }
+
+    virtual void write(const uint8_t* data, size_t len) = 0;
+
+    /* false when nothing arrived within timeout_ms */
+    virtual bool read_byte(uint8_t* byte, uint32_t timeout_ms) = 0;
+};
+
+class KeypadMatrix
+{
+public:
+    virtual ~KeypadMatrix() { }
+
+    /* '\0' when no key is down */
+    virtual char get_pressed_key() = 0;
+};
+
+class AudioSink
+{
+public:
+    virtual ~AudioSink() { }
+
+    /* Blocks until the clip has played play_count times */
+    virtual void play(AudioName audio, int play_count = 1) = 0;
+};
+
+class DoorMotor
+{
+public:
+    virtual ~DoorMotor() { }
+
+    /* Blocks for duration_ms, then brakes and powers the driver down */
+    virtual void run(bool open, uint32_t duration_ms) = 0;
+};
+
+#endif
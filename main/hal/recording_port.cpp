@@ -0,0 +1,53 @@
+#include "recording_port.h"
+#include "fingerprint/defs.h"
+#include "helper/event_recorder.h"
+
+void RecordingSerialPort::write(const uint8_t* data, size_t len)
+{
+    /* write_packet() sends a whole command packet at once, the command code follows the header */
+    if (len > HEADER_LEN)
+        _last_cmd = data[HEADER_LEN];
+
+    _frame_len = 0;
+    _port.write(data, len);
+}
+
+bool RecordingSerialPort::read_byte(uint8_t* byte, uint32_t timeout_ms)
+{
+    if (!_port.read_byte(byte, timeout_ms))
+    {
+        record_event(RecordedInput::FpTimeout, _last_cmd);
+        _frame_len = 0;
+        return false;
+    }
+
+    _on_byte(*byte);
+    return true;
+}
+
+void RecordingSerialPort::_on_byte(uint8_t byte)
+{
+    /* Resynchronize on the start code like read_packet() does */
+    if ((_frame_len == 0 && byte != (FINGERPRINT_START_CODE >> 8)) || (_frame_len == 1 && byte != (FINGERPRINT_START_CODE & 0xFF)))
+    {
+        _frame_len = byte == (FINGERPRINT_START_CODE >> 8) ? 1 : 0;
+        _frame[0] = byte;
+        return;
+    }
+
+    if (_frame_len < KEEP_LEN)
+        _frame[_frame_len] = byte;
+
+    if (++_frame_len == HEADER_LEN)
+        _frame_total = HEADER_LEN + ((static_cast<uint16_t>(_frame[7]) << 8) | _frame[8]);
+
+    if (_frame_len < HEADER_LEN || _frame_len < _frame_total)
+        return;
+
+    /* Confirmation code, then up to two payload bytes when the reply carries any */
+    uint16_t payload_len = _frame_total > HEADER_LEN + 3 ? _frame_total - HEADER_LEN - 3 : 0;
+    uint16_t aux = payload_len >= 2 ? (static_cast<uint16_t>(_frame[HEADER_LEN + 1]) << 8) | _frame[HEADER_LEN + 2] : 0;
+
+    record_event(RecordedInput::FpFrame, _last_cmd, _frame[HEADER_LEN], aux);
+    _frame_len = 0;
+}
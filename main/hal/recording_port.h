@@ -0,0 +1,31 @@
+#ifndef _H_RECORDING_PORT_H_
+#define _H_RECORDING_PORT_H_
+
+#include "hal.h"
+
+/*
+ * Passes every byte through and records each EF01 reply as an FpFrame (or an FpTimeout),
+ * so host_sim/replay_door.cpp can answer the reader's commands the way the sensor did.
+ */
+class RecordingSerialPort : public SerialPort
+{
+public:
+    RecordingSerialPort(SerialPort& port) : _port(port) { }
+
+    void write(const uint8_t* data, size_t len) override;
+    bool read_byte(uint8_t* byte, uint32_t timeout_ms) override;
+
+private:
+    const static uint8_t HEADER_LEN = 9;    /* Start code, address, type, length */
+    const static uint8_t KEEP_LEN = HEADER_LEN + 3;
+
+    SerialPort& _port;
+    uint8_t _last_cmd = 0;
+    uint8_t _frame[KEEP_LEN] = { 0 };
+    uint16_t _frame_len = 0;
+    uint16_t _frame_total = 0;
+
+    void _on_byte(uint8_t byte);
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <cstdio>
+
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include "deferred_log.h"
+#include "rtos_arena.h"
+#include "task_config.h"
+
+static const char* TAG = "DeferredLog";
+
+/* Indexed by esp_log_level_t */
+static const char LEVEL_LETTERS[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+
+static QueueHandle_t dlog_queue = nullptr;
+static std::atomic<uint32_t> dropped_cnt(0);
+
+void post_deferred_log(esp_log_level_t level, const char* tag, const char* fmt, const uint32_t* args, uint8_t num_args)
+{
+    DeferredLogRecord_t record = { static_cast<uint32_t>(esp_timer_get_time() / 1000), tag, fmt, static_cast<uint8_t>(level), num_args, { 0 } };
+
+    for (uint8_t i = 0; i < num_args; ++i)
+        record.args[i] = args[i];
+
+    /* Never blocks the caller, a full queue costs a line instead of latency */
+    if (dlog_queue == nullptr || xQueueSend(dlog_queue, &record, 0) != pdTRUE)
+        dropped_cnt.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void print_record(const DeferredLogRecord_t& record)
+{
+    char line[DLOG_LINE_LEN] = { 0 };
+    esp_log_level_t level = static_cast<esp_log_level_t>(record.level);
+
+    /* Unused arguments are ignored by the format, all conversions are 32 bits wide on the S3 */
+    snprintf(line, DLOG_LINE_LEN, record.fmt, record.args[0], record.args[1], record.args[2], record.args[3]);
+    esp_log_write(level, record.tag, "%c (%lu) %s: %s\n", LEVEL_LETTERS[level], record.time_ms, record.tag, line);
+}
+
+static void report_dropped()
+{
+    uint32_t dropped = dropped_cnt.exchange(0, std::memory_order_relaxed);
+
+    if (dropped > 0)
+        ESP_LOGW(TAG, "%lu deferred log lines dropped", dropped);
+}
+
+void init_deferred_log()
+{
+    dlog_queue = create_static_queue(Subsystem::Logging, DLOG_QUEUE_SIZE, sizeof(DeferredLogRecord_t));
+
+    auto task = [](void* pvParameters)
+    {
+        DeferredLogRecord_t record;
+
+        while (true)
+        {
+            if (xQueueReceive(dlog_queue, &record, portMAX_DELAY) != pdTRUE)
+                continue;
+
+            print_record(record);
+            report_dropped();
+        }
+
+        vTaskDelete(NULL);
+    };
+
+    create_task(TaskId::DeferredLog, task);
+}
+
+void flush_deferred_log()
+{
+    DeferredLogRecord_t record;
+
+    if (dlog_queue == nullptr)
+        return;
+
+    while (xQueueReceive(dlog_queue, &record, 0) == pdTRUE)
+        print_record(record);
+
+    report_dropped();
+}
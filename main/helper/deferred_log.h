@@ -0,0 +1,62 @@
+#ifndef _H_DEFERRED_LOG_HELPER_H_
+#define _H_DEFERRED_LOG_HELPER_H_
+
+#include <cstdint>
+#include <type_traits>
+
+#include <esp_log.h>
+
+#define DLOG_QUEUE_SIZE     ( 64 )
+#define DLOG_MAX_ARGS       ( 4 )
+#define DLOG_LINE_LEN       ( 128U )
+
+/* Compile-time level per subsystem, anything more verbose is not even recorded */
+#define DLOG_LEVEL_KEYPAD   ( ESP_LOG_INFO )
+#define DLOG_LEVEL_FP       ( ESP_LOG_INFO )
+#define DLOG_LEVEL_TEL      ( ESP_LOG_INFO )
+
+/* Queued by value, rtos_arena sizes the logging budget from it */
+typedef struct DeferredLogRecord_s
+{
+    uint32_t time_ms;
+    const char* tag;
+    const char* fmt;
+    uint8_t level;
+    uint8_t num_args;
+    uint32_t args[DLOG_MAX_ARGS];
+} DeferredLogRecord_t;
+
+/*
+ * The caller only copies the format pointer and up to DLOG_MAX_ARGS 32-bit arguments into a queue,
+ * tsk_dlog formats and prints them later. Format strings must be literals and only take integer conversions.
+ */
+#define DLOG(subsys, level, tag, fmt, ...)                                  \
+    do                                                                      \
+    {                                                                       \
+        if ((level) <= DLOG_LEVEL_##subsys)                                 \
+            deferred_log((level), (tag), (fmt), ##__VA_ARGS__);             \
+    } while (0)
+
+#define DLOGW(subsys, tag, fmt, ...)    DLOG(subsys, ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define DLOGI(subsys, tag, fmt, ...)    DLOG(subsys, ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define DLOGD(subsys, tag, fmt, ...)    DLOG(subsys, ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+void init_deferred_log();
+
+/* Formats whatever is still queued on the calling task, used before deep sleep */
+void flush_deferred_log();
+
+void post_deferred_log(esp_log_level_t level, const char* tag, const char* fmt, const uint32_t* args, uint8_t num_args);
+
+template <typename... Args>
+inline void deferred_log(esp_log_level_t level, const char* tag, const char* fmt, Args... args)
+{
+    static_assert(sizeof...(Args) <= DLOG_MAX_ARGS, "Too many deferred log arguments");
+    static_assert(((std::is_integral<Args>::value || std::is_enum<Args>::value) && ...), "Deferred log arguments must be integers, strings may be gone before they are formatted");
+    static_assert(((sizeof(Args) <= sizeof(uint32_t)) && ...), "Deferred log arguments are stored as 32 bits");
+
+    uint32_t packed[DLOG_MAX_ARGS] = { static_cast<uint32_t>(args)... };
+    post_deferred_log(level, tag, fmt, packed, sizeof...(Args));
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include <cstdio>
+
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "diagnostics.h"
+#include "mem_policy.h"
+#include "system.h"
+#include "task_config.h"
+
+#define DIAG_REPORT_MAGIC   ( 0x44494147U )
+#define DIAG_JSON_TAIL      "]}}"
+
+typedef struct DiagReportState_s
+{
+    uint32_t magic;
+    int64_t last_report_at;     /* get_mono_time_us() */
+} DiagReportState_t;
+
+static const char* TAG = "DiagnosticsHelper";
+
+static RTC_DATA_ATTR DiagReportState_t report_state;
+
+/* Only touched from tsk_az_loop, kept static so the sample does not land on its stack */
+static TaskStatus_t task_stats[DIAG_MAX_TASKS];
+static UBaseType_t prev_task_numbers[DIAG_MAX_TASKS] = { 0 };
+static configRUN_TIME_COUNTER_TYPE prev_run_times[DIAG_MAX_TASKS] = { 0 };
+static UBaseType_t prev_num_tasks = 0;
+static configRUN_TIME_COUNTER_TYPE prev_total_run_time = 0;
+
+bool is_diag_report_due()
+{
+    if (report_state.magic != DIAG_REPORT_MAGIC)
+        return true;
+
+    return get_mono_time_us() - report_state.last_report_at >= static_cast<int64_t>(DIAG_REPORT_INTERVAL_S) * 1000000;
+}
+
+void mark_diag_reported()
+{
+    report_state.magic = DIAG_REPORT_MAGIC;
+    report_state.last_report_at = get_mono_time_us();
+}
+
+static configRUN_TIME_COUNTER_TYPE get_prev_run_time(UBaseType_t task_number)
+{
+    for (UBaseType_t i = 0; i < prev_num_tasks; ++i)
+    {
+        if (prev_task_numbers[i] == task_number)
+            return prev_run_times[i];
+    }
+
+    return 0;
+}
+
+static uint32_t get_recommended_stack_size(uint32_t stack_size, uint32_t free_bytes)
+{
+    uint32_t used = stack_size > free_bytes ? stack_size - free_bytes : 0;
+    uint32_t size = used * (100 + DIAG_STACK_HEADROOM_PCT) / 100;
+
+    return (size + DIAG_STACK_ROUND_BYTES - 1) / DIAG_STACK_ROUND_BYTES * DIAG_STACK_ROUND_BYTES;
+}
+
+bool build_diag_report(char* buf, size_t len)
+{
+    configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+    UBaseType_t num_tasks = uxTaskGetSystemState(task_stats, DIAG_MAX_TASKS, &total_run_time);
+
+    if (num_tasks == 0)
+    {
+        ESP_LOGW(TAG, "More than %d tasks, nothing sampled", DIAG_MAX_TASKS);
+        return false;
+    }
+
+    configRUN_TIME_COUNTER_TYPE total_delta = total_run_time - prev_total_run_time;
+    size_t tail_len = sizeof(DIAG_JSON_TAIL);
+    int pos = snprintf(buf, len, "{\"diag\":{\"up\":%llu,\"heap\":%lu,\"heap_min\":%lu,\"int_min\":%u,\"int_blk\":%u,\"fast_peak\":%u,\"bulk_peak\":%u,\"tasks\":[",
+                       esp_timer_get_time() / 1000000ULL,
+                       esp_get_free_heap_size(),
+                       esp_get_minimum_free_heap_size(),
+                       heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+                       heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+                       get_mem_tier_peak(MemTier::InternalFast),
+                       get_mem_tier_peak(MemTier::PsramBulk));
+
+    log_mem_tiers();
+
+    if (pos < 0 || pos + tail_len > len)
+        return false;
+
+    bool is_first = true;
+
+    for (UBaseType_t i = 0; i < num_tasks; ++i)
+    {
+        const TaskStatus_t& task = task_stats[i];
+        const TaskConfig_t* cfg = find_task_config(task.pcTaskName);
+
+        /* ESP-IDF stacks are byte-addressed, so the high-water mark is already in bytes */
+        uint32_t free_bytes = task.usStackHighWaterMark;
+        uint32_t stack_size = cfg != nullptr ? cfg->stack_size : 0;
+        uint32_t recommended = cfg != nullptr ? get_recommended_stack_size(stack_size, free_bytes) : 0;
+        uint32_t cpu_pct = total_delta > 0 ? static_cast<uint32_t>((task.ulRunTimeCounter - get_prev_run_time(task.xTaskNumber)) * 100 / total_delta) : 0;
+
+        if (free_bytes < DIAG_STACK_MIN_FREE_BYTES)
+            ESP_LOGW(TAG, "%-16s stack nearly exhausted: %lu B free of %lu B, recommended %lu B", task.pcTaskName, free_bytes, stack_size, recommended);
+        else
+            ESP_LOGI(TAG, "%-16s stack %lu B free of %lu B, recommended %lu B, cpu %lu%%", task.pcTaskName, free_bytes, stack_size, recommended, cpu_pct);
+
+        /* Tasks that do not fit are still logged, the JSON just drops them */
+        int written = snprintf(buf + pos, len - pos, "%s[\"%s\",%lu,%lu,%lu,%lu]",
+                               is_first ? "" : ",", task.pcTaskName, free_bytes, stack_size, recommended, cpu_pct);
+
+        if (written > 0 && pos + written + tail_len <= len)
+        {
+            pos += written;
+            is_first = false;
+        }
+        else
+            buf[pos] = '\0';
+    }
+
+    snprintf(buf + pos, len - pos, "%s", DIAG_JSON_TAIL);
+
+    for (UBaseType_t i = 0; i < num_tasks; ++i)
+    {
+        prev_task_numbers[i] = task_stats[i].xTaskNumber;
+        prev_run_times[i] = task_stats[i].ulRunTimeCounter;
+    }
+
+    prev_num_tasks = num_tasks;
+    prev_total_run_time = total_run_time;
+
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef _H_DIAGNOSTICS_HELPER_H_
+#define _H_DIAGNOSTICS_HELPER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define DIAG_MAX_TASKS              ( 24 )
+#define DIAG_REPORT_INTERVAL_S      ( 6 * 60 * 60ULL )
+#define DIAG_TEL_BUF_LEN            ( 768U )
+
+/* Recommended stack = used * (100 + headroom) / 100, rounded up */
+#define DIAG_STACK_HEADROOM_PCT     ( 25 )
+#define DIAG_STACK_ROUND_BYTES      ( 256 )
+#define DIAG_STACK_MIN_FREE_BYTES   ( 512 )
+
+/* Due once per DIAG_REPORT_INTERVAL_S, the last report time survives deep sleep */
+bool is_diag_report_due();
+void mark_diag_reported();
+
+/*
+ * Samples every task's stack high-water mark and run-time counter plus the heap minimums and tier peaks,
+ * logs the stack recommendations and writes a compact JSON summary into buf.
+ * CPU shares are per core and relative to the previous call.
+ */
+bool build_diag_report(char* buf, size_t len);
+
+#endif
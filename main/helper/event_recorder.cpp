@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <atomic>
+
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_partition.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "event_recorder.h"
+#include "settings.h"
+
+#define EVREC_RECORDS_PER_SECTOR    ( EVREC_SECTOR_SIZE / sizeof(EventRecord_t) )
+#define EVREC_WRITE_BATCH           ( 16 )
+
+static_assert((EVREC_STAGE_SIZE & (EVREC_STAGE_SIZE - 1)) == 0, "EVREC_STAGE_SIZE must be a power of two");
+
+static const char* TAG = "EventRecorder";
+
+static const esp_partition_t* evrec_part = nullptr;
+
+/* Staging ring, a slot is valid when its stamp equals its claim index + 1. It has to hold a whole wake */
+EXT_RAM_BSS_ATTR static EventRecord_t stage[EVREC_STAGE_SIZE];
+static std::atomic<uint32_t> stage_stamps[EVREC_STAGE_SIZE];
+static std::atomic<uint32_t> stage_head(0);
+static uint32_t stage_flushed = 0;
+static uint32_t lost_cnt = 0;
+static std::atomic_flag is_flushing = ATOMIC_FLAG_INIT;
+
+/* Flash position, found on the first flush */
+static bool is_located = false;
+static uint32_t num_sectors = 0;
+static uint32_t cur_sector = 0;
+static uint32_t cur_slot = 0;
+static uint32_t cur_sector_seq = 0;
+
+static bool is_erased(const EventRecord_t& record)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    return std::all_of(bytes, bytes + sizeof(EventRecord_t), [](uint8_t byte) { return byte == 0xFF; });
+}
+
+static bool is_sector_header(const EventRecord_t& record)
+{
+    return record.check == event_record_check(record) && record.input == static_cast<uint8_t>(RecordedInput::SectorHeader) && record.time_us == EVREC_SECTOR_MAGIC;
+}
+
+static bool start_sector(uint32_t sector, uint32_t seq)
+{
+    EventRecord_t header = { EVREC_SECTOR_MAGIC, static_cast<uint8_t>(RecordedInput::SectorHeader), 0,
+                             static_cast<uint16_t>(seq & 0xFFFF), static_cast<uint16_t>(seq >> 16), 0, 0 };
+    header.check = event_record_check(header);
+
+    if (esp_partition_erase_range(evrec_part, sector * EVREC_SECTOR_SIZE, EVREC_SECTOR_SIZE) != ESP_OK ||
+        esp_partition_write(evrec_part, sector * EVREC_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK)
+        return false;
+
+    cur_sector = sector;
+    cur_slot = 1;
+    cur_sector_seq = seq;
+    return true;
+}
+
+/* The newest sector has the highest sequence, its first erased slot is the write position */
+static bool locate_write_pos()
+{
+    EventRecord_t batch[EVREC_WRITE_BATCH];
+    bool is_found = false;
+
+    num_sectors = evrec_part->size / EVREC_SECTOR_SIZE;
+
+    for (uint32_t sector = 0; sector < num_sectors; ++sector)
+    {
+        if (esp_partition_read(evrec_part, sector * EVREC_SECTOR_SIZE, batch, sizeof(EventRecord_t)) != ESP_OK || !is_sector_header(batch[0]))
+            continue;
+
+        uint32_t seq = batch[0].arg | static_cast<uint32_t>(batch[0].aux) << 16;
+
+        if (!is_found || static_cast<int32_t>(seq - cur_sector_seq) > 0)
+        {
+            is_found = true;
+            cur_sector = sector;
+            cur_sector_seq = seq;
+        }
+    }
+
+    if (!is_found)
+        return start_sector(0, 1);
+
+    for (cur_slot = 1; cur_slot < EVREC_RECORDS_PER_SECTOR; cur_slot += EVREC_WRITE_BATCH)
+    {
+        if (esp_partition_read(evrec_part, cur_sector * EVREC_SECTOR_SIZE + cur_slot * sizeof(EventRecord_t), batch, sizeof(batch)) != ESP_OK)
+            return false;
+
+        for (uint32_t i = 0; i < EVREC_WRITE_BATCH && cur_slot + i < EVREC_RECORDS_PER_SECTOR; ++i)
+        {
+            if (is_erased(batch[i]))
+            {
+                cur_slot += i;
+                return true;
+            }
+        }
+    }
+
+    return start_sector((cur_sector + 1) % num_sectors, cur_sector_seq + 1);
+}
+
+static bool write_records(const EventRecord_t* records, uint32_t cnt)
+{
+    while (cnt > 0)
+    {
+        if (cur_slot == EVREC_RECORDS_PER_SECTOR && !start_sector((cur_sector + 1) % num_sectors, cur_sector_seq + 1))
+            return false;
+
+        uint32_t n = std::min<uint32_t>(cnt, EVREC_RECORDS_PER_SECTOR - cur_slot);
+
+        if (esp_partition_write(evrec_part, cur_sector * EVREC_SECTOR_SIZE + cur_slot * sizeof(EventRecord_t), records, n * sizeof(EventRecord_t)) != ESP_OK)
+            return false;
+
+        cur_slot += n;
+        records += n;
+        cnt -= n;
+    }
+
+    return true;
+}
+
+void init_event_recorder()
+{
+    evrec_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, EVREC_PARTITION_LABEL);
+
+    if (evrec_part == nullptr)
+        ESP_LOGW(TAG, "No %s partition, event capture disabled", EVREC_PARTITION_LABEL);
+}
+
+void record_event(RecordedInput input, uint8_t sub, uint16_t arg, uint16_t aux, int64_t time_us)
+{
+    if (evrec_part == nullptr || get_setting(Setting::EventCapture) == 0)
+        return;
+
+    uint32_t idx = stage_head.fetch_add(1, std::memory_order_relaxed);
+    uint32_t slot = idx & (EVREC_STAGE_SIZE - 1);
+    EventRecord_t& record = stage[slot];
+
+    /* Seqlock: a flush that races with this write sees the stamp change and counts the slot as lost */
+    stage_stamps[slot].store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.time_us = time_us != 0 ? time_us : esp_timer_get_time();
+    record.input = static_cast<uint8_t>(input);
+    record.sub = sub;
+    record.arg = arg;
+    record.aux = aux;
+    record.seq = static_cast<uint8_t>(idx);
+    record.check = event_record_check(record);
+
+    stage_stamps[slot].store(idx + 1, std::memory_order_release);
+}
+
+void flush_event_record()
+{
+    if (evrec_part == nullptr)
+        return;
+
+    while (is_flushing.test_and_set(std::memory_order_acquire))
+        vTaskDelay(1);
+
+    uint32_t head = stage_head.load(std::memory_order_acquire);
+    EventRecord_t batch[EVREC_WRITE_BATCH];
+    uint32_t batch_len = 0;
+
+    if (!is_located && !(is_located = locate_write_pos()))
+    {
+        ESP_LOGE(TAG, "Event record partition unreadable");
+        is_flushing.clear(std::memory_order_release);
+        return;
+    }
+
+    /* Writers lapped the flush, the oldest records are gone */
+    if (head - stage_flushed > EVREC_STAGE_SIZE)
+    {
+        lost_cnt += head - stage_flushed - EVREC_STAGE_SIZE;
+        stage_flushed = head - EVREC_STAGE_SIZE;
+    }
+
+    if (lost_cnt > 0)
+    {
+        batch[batch_len] = { esp_timer_get_time(), static_cast<uint8_t>(RecordedInput::Overflow), 0, static_cast<uint16_t>(std::min<uint32_t>(lost_cnt, UINT16_MAX)), 0, 0, 0 };
+        batch[batch_len].check = event_record_check(batch[batch_len]);
+        ++batch_len;
+        lost_cnt = 0;
+    }
+
+    for (; stage_flushed != head; ++stage_flushed)
+    {
+        uint32_t slot = stage_flushed & (EVREC_STAGE_SIZE - 1);
+        uint32_t stamp = stage_stamps[slot].load(std::memory_order_acquire);
+
+        /* Claimed but still being written, the rest goes out with the next flush */
+        if (stamp == 0 || static_cast<int32_t>(stamp - (stage_flushed + 1)) < 0)
+            break;
+
+        batch[batch_len] = stage[slot];
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (stamp != stage_flushed + 1 || stage_stamps[slot].load(std::memory_order_relaxed) != stamp)
+        {
+            ++lost_cnt;
+            continue;
+        }
+
+        if (++batch_len == EVREC_WRITE_BATCH)
+        {
+            if (!write_records(batch, batch_len))
+                ESP_LOGE(TAG, "Event record write failed");
+
+            batch_len = 0;
+        }
+    }
+
+    if (batch_len > 0 && !write_records(batch, batch_len))
+        ESP_LOGE(TAG, "Event record write failed");
+
+    is_flushing.clear(std::memory_order_release);
+}
@@ -0,0 +1,71 @@
+#ifndef _H_EVENT_RECORDER_HELPER_H_
+#define _H_EVENT_RECORDER_HELPER_H_
+
+#include <cstdint>
+
+/* No ESP-IDF headers, host_sim/replay_door.cpp reads the same layout */
+
+#define EVREC_PARTITION_LABEL   "evrec"
+#define EVREC_STAGE_SIZE        ( 1024 )    /* Records held in PSRAM until the lock goes idle, power of two */
+#define EVREC_SECTOR_SIZE       ( 4096 )
+#define EVREC_SECTOR_MAGIC      ( 0x45565231U )  /* "EVR1" */
+
+/* Append only, the replayer decodes by value */
+enum class RecordedInput : uint8_t
+{
+    SectorHeader,       /* First slot of every flash sector, time_us: EVREC_SECTOR_MAGIC, arg | aux << 16: sector sequence */
+    Boot,               /* sub: 1 on a warm start, arg: state | pwd cnt << 4 | fp cnt << 8 | door status << 12, aux: lockdown s left */
+    SettingApplied,     /* sub: Setting, arg | aux << 16: value */
+    ButtonEdge,         /* sub: 0 reset, 1 door, 2 enroll, before debouncing */
+    KeyEdge,            /* A keypad row interrupt, before debouncing */
+    KeyScanned,         /* arg: key, digits are stored as '0' */
+    EntryResult,        /* arg: password matches | confirmation matches << 1 */
+    FingerTouched,
+    PresenceDetected,
+    FpFrame,            /* sub: command, arg: confirmation code, aux: first two payload bytes */
+    FpTimeout,          /* sub: command that got no reply */
+    RemoteDoor,         /* arg: DoorCommand */
+    TelemetrySent,      /* sub: TelemetryStatus, arg: publish id */
+    FsmTransition,      /* sub: DoorInput, arg: next DoorState, observed only, not replayed */
+    Overflow,           /* arg: records lost since the last flush */
+    Count,
+};
+
+/* 16 bytes in flash, little endian, an erased slot reads back as all 0xFF */
+typedef struct EventRecord_s
+{
+    int64_t time_us;    /* esp_timer, restarts at every boot */
+    uint8_t input;
+    uint8_t sub;
+    uint16_t arg;
+    uint16_t aux;
+    uint8_t seq;        /* Claim order, low byte */
+    uint8_t check;      /* ~sum of the other 15 bytes, catches slots torn by a power cut */
+} EventRecord_t;
+
+static_assert(sizeof(EventRecord_t) == 16, "Event record layout is shared with host_sim/replay_door.cpp");
+
+inline uint8_t event_record_check(const EventRecord_t& record)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    uint8_t sum = 0;
+
+    for (uint8_t i = 0; i < sizeof(EventRecord_t) - 1; ++i)
+        sum += bytes[i];
+
+    return static_cast<uint8_t>(~sum);
+}
+
+/* Finds the partition, the write position is looked up lazily on the first flush */
+void init_event_recorder();
+
+/* Lock-free, task context only. A no-op unless the eventCapture setting is on */
+void record_event(RecordedInput input, uint8_t sub = 0, uint16_t arg = 0, uint16_t aux = 0, int64_t time_us = 0);
+
+/*
+ * Moves staged records to flash. An erase or write disables the cache on both cores for its whole duration
+ * (CONFIG_SPI_FLASH_AUTO_SUSPEND is off), so only call it once the lock is idle: before deep sleep or a restart.
+ */
+void flush_event_record();
+
+#endif
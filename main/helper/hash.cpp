@@ -0,0 +1,34 @@
+#include <cstring>
+
+#include <mbedtls/constant_time.h>
+#include <mbedtls/sha256.h>
+
+#include "hash.h"
+
+uint32_t fnv1a(const void* data, size_t len, uint32_t hash)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    for (size_t i = 0; i < len; ++i)
+        hash = (hash ^ bytes[i]) * 16777619U;
+
+    return hash;
+}
+
+void hash_pin(const uint8_t* salt, const char* pin, uint8_t* digest)
+{
+    mbedtls_sha256_context ctx;
+
+    /* The SHA peripheral does the work, a key entry costs tens of microseconds */
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, salt, PIN_SALT_LEN);
+    mbedtls_sha256_update(&ctx, reinterpret_cast<const uint8_t*>(pin), strlen(pin));
+    mbedtls_sha256_finish(&ctx, digest);
+    mbedtls_sha256_free(&ctx);
+}
+
+bool is_same_pin_digest(const uint8_t* a, const uint8_t* b)
+{
+    return mbedtls_ct_memcmp(a, b, PIN_DIGEST_LEN) == 0;
+}
@@ -0,0 +1,21 @@
+#ifndef _H_HASH_HELPER_H_
+#define _H_HASH_HELPER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define FNV1A_OFFSET_BASIS  ( 2166136261U )
+
+#define PIN_SALT_LEN        ( 16 )
+#define PIN_DIGEST_LEN      ( 32 )
+
+/* FNV-1a for cache keys only, not for secrets. Pass the previous result to chain several fields */
+uint32_t fnv1a(const void* data, size_t len, uint32_t hash = FNV1A_OFFSET_BASIS);
+
+/* SHA-256 over the per-device salt and the PIN */
+void hash_pin(const uint8_t* salt, const char* pin, uint8_t* digest);
+
+/* Constant time, how long a compare takes says nothing about how many bytes matched */
+bool is_same_pin_digest(const uint8_t* a, const uint8_t* b);
+
+#endif
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cstdint>
+
+#include <esp_log.h>
+#include <esp_random.h>
+#include <esp_timer.h>
+#include <esp_wifi_types.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+extern "C"
+{
+#include <transport_abstraction.h>
+#include <transport_tls_session.h>
+#include <transport_tls_socket.h>
+}
+
+#include "config.h"
+#include "jitter_bench.h"
+#include "reactor.h"
+#include "task_config.h"
+#include "time_sync.h"
+#include "azure/network_helper.h"
+#include "wifi/station.h"
+
+#define NUM_JITTER_PHASES   ( static_cast<size_t>(JitterPhase::Count) )
+
+/* Each compilation unit must define the NetworkContext struct. */
+struct NetworkContext
+{
+    void * pParams;
+};
+
+typedef struct JitterStats_s
+{
+    uint32_t count;
+    int64_t min_us;
+    int64_t max_us;
+    int64_t total_us;
+} JitterStats_t;
+
+static const char* TAG = "JitterBench";
+
+/* Indexed by JitterPhase */
+static const char* PHASE_NAMES[] = { "idle", "full", "resumed" };
+
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == NUM_JITTER_PHASES, "PHASE_NAMES is indexed by JitterPhase");
+
+static esp_timer_handle_t key_timer = nullptr;
+static portMUX_TYPE bench_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Guarded by bench_lock, the actuator records on core 1 while the phases change on core 0 */
+static bool is_running = false;
+static JitterPhase phase = JitterPhase::Idle;
+static int64_t phase_started_us = 0;
+static JitterStats_t phase_stats[NUM_JITTER_PHASES];
+static uint32_t straddled_cnt = 0;
+
+static void set_phase(JitterPhase next, bool running = true)
+{
+    portENTER_CRITICAL(&bench_lock);
+    is_running = running;
+    phase = next;
+    phase_started_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&bench_lock);
+}
+
+/* Runs on the esp_timer task, which outranks everything on the network core like the keypad ISR does */
+static void inject_key(void* arg)
+{
+    post_event(EventType::KeyInjected);
+
+    uint64_t delay_ms = JITTER_BENCH_KEY_PERIOD_MS + esp_random() % JITTER_BENCH_KEY_SPREAD_MS;
+    esp_timer_start_once(key_timer, delay_ms * 1000);
+}
+
+void record_jitter_sample(int64_t latency_us, int64_t event_time_us)
+{
+    portENTER_CRITICAL(&bench_lock);
+
+    if (is_running)
+    {
+        if (event_time_us < phase_started_us)
+            ++straddled_cnt;
+        else
+        {
+            JitterStats_t& stats = phase_stats[static_cast<size_t>(phase)];
+
+            stats.count++;
+            stats.total_us += latency_us;
+            stats.min_us = std::min(stats.min_us, latency_us);
+            stats.max_us = std::max(stats.max_us, latency_us);
+        }
+    }
+
+    portEXIT_CRITICAL(&bench_lock);
+}
+
+static void log_jitter_stats()
+{
+    TlsSessionCacheStats_t cache_stats;
+
+    TLS_Session_GetStats(&cache_stats);
+
+    for (size_t i = 0; i < NUM_JITTER_PHASES; ++i)
+    {
+        const JitterStats_t& stats = phase_stats[i];
+
+        if (stats.count == 0)
+        {
+            ESP_LOGW(TAG, "%-8s no keys", PHASE_NAMES[i]);
+            continue;
+        }
+
+        ESP_LOGI(TAG, "%-8s key to beep: n=%lu min=%lld avg=%lld max=%lld jitter=%lld us", PHASE_NAMES[i],
+                 stats.count, stats.min_us, stats.total_us / stats.count, stats.max_us, stats.max_us - stats.min_us);
+    }
+
+    ESP_LOGI(TAG, "Dropped %lu keys across a phase change, session cache hits %lu misses %lu",
+             straddled_cnt, cache_stats.ulHits, cache_stats.ulMisses);
+}
+
+void start_jitter_bench()
+{
+    esp_timer_create_args_t args = {
+        .callback = inject_key,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "jitter_keys",
+        .skip_unhandled_events = true,
+    };
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_timer_create(&args, &key_timer));
+
+    for (auto& stats: phase_stats)
+        stats = { 0, INT64_MAX, 0, 0 };
+
+    auto task = [](void* pvParameters)
+    {
+        NetworkCredentials_t network_credentials = { 0 };
+        NetworkContext_t network_context = { 0 };
+        TlsTransportParams_t tls_transport_params = { 0 };
+
+        connect(WIFI_AP_SSID, WIFI_AP_PASSWORD, WIFI_AP_AUTH_MODE);
+
+        while (!is_connected())
+            vTaskDelay(pdMS_TO_TICKS(250));
+
+        /* Certificate validity is checked against the wall clock */
+        start_time_sync();
+        wait_time_trusted();
+
+        network_context.pParams = &tls_transport_params;
+
+        if (SetupNetworkCredentials(&network_credentials) != 0)
+        {
+            ESP_LOGE(TAG, "Failed to setup network credentials");
+            vTaskDelete(NULL);
+            return;
+        }
+
+        set_phase(JitterPhase::Idle);
+        inject_key(nullptr);
+
+        for (uint32_t round = 0; round < JITTER_BENCH_ROUNDS; ++round)
+        {
+            JitterPhase handshake = round % 2 == 0 ? JitterPhase::FullHandshake : JitterPhase::ResumedHandshake;
+
+            /* Without a cached session the transport runs the full handshake */
+            if (handshake == JitterPhase::FullHandshake)
+                TLS_Session_Invalidate(AZURE_IOT_DPS_ENDPOINT_HOSTNAME);
+
+            set_phase(handshake);
+
+            int64_t start_us = esp_timer_get_time();
+            /* One attempt per round, a retry would fold its backoff into the handshake time */
+            bool is_done = ConnectToServer(AZURE_IOT_DPS_ENDPOINT_HOSTNAME, AZURE_IOT_DPS_ENDPOINT_PORT,
+                                           &network_credentials, &network_context) == 0;
+            int64_t connect_us = esp_timer_get_time() - start_us;
+
+            if (is_done)
+            {
+                uint8_t byte;
+
+                /* A TLS 1.3 server sends the ticket for the next round after the handshake */
+                TLS_Socket_Recv(&network_context, &byte, sizeof(byte));
+                TLS_Socket_Disconnect(&network_context);
+            }
+
+            set_phase(JitterPhase::Idle);
+
+            ESP_LOGI(TAG, "Round %lu: %s connect %s in %lld ms", round, PHASE_NAMES[static_cast<size_t>(handshake)],
+                     is_done ? "done" : "failed", connect_us / 1000);
+
+            vTaskDelay(pdMS_TO_TICKS(JITTER_BENCH_IDLE_MS));
+        }
+
+        esp_timer_stop(key_timer);
+        set_phase(JitterPhase::Idle, false);
+
+        log_jitter_stats();
+
+        vTaskDelete(NULL);
+    };
+
+    /* The hub loop does not run in a bench build, its slot has the stack a handshake needs */
+    create_task(TaskId::AzureLoop, task, NULL, NULL, "tsk_jitter");
+}
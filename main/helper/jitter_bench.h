@@ -0,0 +1,31 @@
+#ifndef _H_JITTER_BENCH_HELPER_H_
+#define _H_JITTER_BENCH_HELPER_H_
+
+#include <cstdint>
+
+/* Set to 1 for a bench build: the lock stays off the hub and tsk_az_loop runs the handshake loop instead */
+#define JITTER_BENCH_ENABLED        ( 0 )
+#define JITTER_BENCH_ROUNDS         ( 40 )      /* Connects, alternately full and resumed */
+#define JITTER_BENCH_IDLE_MS        ( 3000U )   /* Quiet gap after each connect */
+#define JITTER_BENCH_KEY_PERIOD_MS  ( 300U )    /* Longer than a beep, so keys never queue behind one */
+#define JITTER_BENCH_KEY_SPREAD_MS  ( 100U )    /* Random extra delay, keeps keys from locking onto handshake steps */
+
+enum class JitterPhase : uint8_t
+{
+    Idle,
+    FullHandshake,
+    ResumedHandshake,
+    Count,
+};
+
+/*
+ * Reconnects to the DPS endpoint JITTER_BENCH_ROUNDS times while an esp_timer injects a key every
+ * JITTER_BENCH_KEY_PERIOD_MS, then logs key-to-beep min/avg/max and jitter per phase.
+ * Brings the station up itself, call after init_wifi_sta().
+ */
+void start_jitter_bench();
+
+/* Actuator side, latency of a key beep and when its key was posted. Keys that straddle a phase change are dropped */
+void record_jitter_sample(int64_t latency_us, int64_t event_time_us);
+
+#endif
@@ -16,4 +16,53 @@ void init_nvs()
     }
 
     ESP_LOGI(TAG, "NVS flash initialized: %d", res);
-}
\ No newline at end of file
+}
+
+bool read_nvs_blob(const char* key, void* buf, size_t buf_len)
+{
+    nvs_handle_t handle;
+    size_t read_len = buf_len;
+
+    if (nvs_open(NVS_DEFAULT_PART_NAME, NVS_READONLY, &handle) != ESP_OK)
+        return false;
+
+    esp_err_t res = nvs_get_blob(handle, key, buf, &read_len);
+    nvs_close(handle);
+
+    return res == ESP_OK && read_len == buf_len;
+}
+
+bool write_nvs_blob(const char* key, const void* buf, size_t buf_len)
+{
+    nvs_handle_t handle;
+
+    if (nvs_open(NVS_DEFAULT_PART_NAME, NVS_READWRITE, &handle) != ESP_OK)
+        return false;
+
+    esp_err_t res = nvs_set_blob(handle, key, buf, buf_len);
+
+    if (res == ESP_OK)
+        res = nvs_commit(handle);
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(res);
+    nvs_close(handle);
+
+    return res == ESP_OK;
+}
+
+bool erase_nvs_key(const char* key)
+{
+    nvs_handle_t handle;
+
+    if (nvs_open(NVS_DEFAULT_PART_NAME, NVS_READWRITE, &handle) != ESP_OK)
+        return false;
+
+    esp_err_t res = nvs_erase_key(handle, key);
+
+    if (res == ESP_OK)
+        res = nvs_commit(handle);
+
+    nvs_close(handle);
+
+    return res == ESP_OK || res == ESP_ERR_NVS_NOT_FOUND;
+}
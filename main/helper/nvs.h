@@ -1,6 +1,13 @@
 #ifndef _H_NVS_HELPER_H_
 #define _H_NVS_HELPER_H_
 
+#include <cstddef>
+#include <cstdint>
+
 void init_nvs();
 
-#endif
\ No newline at end of file
+bool read_nvs_blob(const char* key, void* buf, size_t buf_len);
+bool write_nvs_blob(const char* key, const void* buf, size_t buf_len);
+bool erase_nvs_key(const char* key);
+
+#endif
@@ -0,0 +1,61 @@
+#include <esp_log.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+
+#include "config.h"
+#include "power.h"
+
+#define NUM_POWER_LOCKS ( static_cast<size_t>(PowerLock::Count) )
+
+static const char* TAG = "PowerHelper";
+
+/* Indexed by PowerLock */
+static const char* POWER_LOCK_NAMES[NUM_POWER_LOCKS] = { "uart", "i2s", "motor" };
+
+static esp_pm_lock_handle_t power_locks[NUM_POWER_LOCKS] = { nullptr };
+
+void init_power_mgmt()
+{
+    /* DFS between XTAL and the default clock, tickless idle drops into light sleep between events */
+    esp_pm_config_t pm_cfg = {
+        .max_freq_mhz = PM_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = PM_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+
+    esp_err_t res = esp_pm_configure(&pm_cfg);
+
+    if (res != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Auto light sleep unavailable: %s", esp_err_to_name(res));
+        return;
+    }
+
+    for (size_t i = 0; i < NUM_POWER_LOCKS; ++i)
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, POWER_LOCK_NAMES[i], &power_locks[i]));
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_sleep_enable_gpio_wakeup());
+    ESP_LOGI(TAG, "Auto light sleep enabled: %d - %d MHz", PM_MIN_CPU_FREQ_MHZ, PM_MAX_CPU_FREQ_MHZ);
+}
+
+/* esp_pm locks count, so nested acquire/release pairs are fine */
+void acquire_power_lock(PowerLock lock)
+{
+    esp_pm_lock_handle_t handle = power_locks[static_cast<size_t>(lock)];
+
+    if (handle != nullptr)
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_pm_lock_acquire(handle));
+}
+
+void release_power_lock(PowerLock lock)
+{
+    esp_pm_lock_handle_t handle = power_locks[static_cast<size_t>(lock)];
+
+    if (handle != nullptr)
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_pm_lock_release(handle));
+}
+
+void enable_light_sleep_wakeup(gpio_num_t gpio)
+{
+    ESP_ERROR_CHECK_WITHOUT_ABORT(gpio_wakeup_enable(gpio, GPIO_INTR_HIGH_LEVEL));
+}
@@ -0,0 +1,25 @@
+#ifndef _H_POWER_HELPER_H_
+#define _H_POWER_HELPER_H_
+
+#include <cstdint>
+
+#include <driver/gpio.h>
+
+/* Each peripheral holds its own lock while a transfer is running, the chip light-sleeps otherwise */
+enum class PowerLock : uint8_t
+{
+    Uart,       /* Fingerprint reader exchange */
+    I2s,        /* Audio playback */
+    Motor,      /* Door run, keeps the 1 s timing exact */
+    Count,
+};
+
+void init_power_mgmt();
+
+void acquire_power_lock(PowerLock lock);
+void release_power_lock(PowerLock lock);
+
+/* Level-triggered so the pin can also wake the chip from light sleep */
+void enable_light_sleep_wakeup(gpio_num_t gpio);
+
+#endif
@@ -0,0 +1,104 @@
+#include <esp_log.h>
+
+#include "config.h"
+#include "nvs.h"
+#include "settings.h"
+
+#define NUM_SETTINGS ( static_cast<size_t>(Setting::Count) )
+
+typedef struct SettingDesc_s
+{
+    const char* name;
+    uint32_t default_value;
+    uint32_t min_value;
+    uint32_t max_value;
+} SettingDesc_t;
+
+typedef struct SettingsCache_s
+{
+    uint32_t layout_version;
+    uint32_t twin_version;
+    uint32_t values[NUM_SETTINGS];
+} SettingsCache_t;
+
+static const char* TAG = "SettingsHelper";
+
+/* Indexed by Setting, names are the device-twin property names */
+static const SettingDesc_t SETTING_DESCS[NUM_SETTINGS] = {
+    { "activityRemTimeMs",  DEFAULT_ACTIVITY_REM_TIME,  5 * 1000,   10 * 60 * 1000 },
+    { "autoCloseTimeS",     DEFAULT_AUTO_CLOSE_TIME_S,  1,          5 * 60 },
+    { "lockdownTimeS",      DEFAULT_LOCKDOWN_TIME_S,    5,          60 * 60 },
+    { "sendTelDelayMs",     SEND_TEL_DELAY,             100,        60 * 1000 },
+    { "fpScanDelayMs",      FP_SCAN_DELAY,              10,         5 * 1000 },
+    { "eventCapture",       DEFAULT_EVENT_CAPTURE,      0,          1 },
+};
+
+static SettingsCache_t settings = { };
+
+static void load_defaults()
+{
+    settings.layout_version = SETTINGS_LAYOUT_VERSION;
+    settings.twin_version = 0;
+
+    for (size_t i = 0; i < NUM_SETTINGS; ++i)
+        settings.values[i] = SETTING_DESCS[i].default_value;
+}
+
+void init_settings()
+{
+    load_defaults();
+
+    SettingsCache_t cache;
+
+    if (!read_nvs_blob(NVS_KEY_SETTINGS, &cache, sizeof(cache)) || cache.layout_version != SETTINGS_LAYOUT_VERSION)
+    {
+        ESP_LOGI(TAG, "Using default settings");
+        return;
+    }
+
+    /* Re-validate, the ranges may have been tightened by a firmware update */
+    for (size_t i = 0; i < NUM_SETTINGS; ++i)
+        set_setting(static_cast<Setting>(i), cache.values[i]);
+
+    settings.twin_version = cache.twin_version;
+    ESP_LOGI(TAG, "Settings loaded, twin version: %lu", settings.twin_version);
+}
+
+bool save_settings()
+{
+    return write_nvs_blob(NVS_KEY_SETTINGS, &settings, sizeof(settings));
+}
+
+uint32_t get_setting(Setting id)
+{
+    return settings.values[static_cast<size_t>(id)];
+}
+
+bool set_setting(Setting id, uint32_t value)
+{
+    const SettingDesc_t& desc = SETTING_DESCS[static_cast<size_t>(id)];
+
+    if (value < desc.min_value || value > desc.max_value)
+    {
+        ESP_LOGW(TAG, "%s out of range: %lu", desc.name, value);
+        return false;
+    }
+
+    settings.values[static_cast<size_t>(id)] = value;
+    return true;
+}
+
+const char* get_setting_name(Setting id)
+{
+    return SETTING_DESCS[static_cast<size_t>(id)].name;
+}
+
+uint32_t get_settings_version()
+{
+    return settings.twin_version;
+}
+
+void set_settings_version(uint32_t version)
+{
+    settings.twin_version = version;
+}
@@ -0,0 +1,33 @@
+#ifndef _H_SETTINGS_HELPER_H_
+#define _H_SETTINGS_HELPER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define SETTINGS_LAYOUT_VERSION ( 3U )
+
+/* Runtime-tunable timing parameters, seeded from config.h and overridden by the device twin */
+enum class Setting : uint8_t
+{
+    ActivityRemTimeMs,
+    AutoCloseTimeS,
+    LockdownTimeS,
+    SendTelDelayMs,
+    FpScanDelayMs,
+    EventCapture,           /* 1 records inputs to the evrec partition */
+    Count,
+};
+
+void init_settings();
+bool save_settings();
+
+uint32_t get_setting(Setting id);
+bool set_setting(Setting id, uint32_t value);
+
+const char* get_setting_name(Setting id);
+
+/* Desired-properties version the current values were taken from */
+uint32_t get_settings_version();
+void set_settings_version(uint32_t version);
+
+#endif
@@ -2,50 +2,40 @@
 #include <ctime>
 #include <esp_check.h>
 #include <esp_log.h>
+#include <esp_rtc_time.h>
 #include <esp_sleep.h>
-#include <esp_sntp.h>
+#include <esp_timer.h>
 #include <nvs_flash.h>
 #include <driver/gpio.h>
 
 #include "system.h"
+#include "time_sync.h"
 
 using namespace std;
 
-static const char* TAG = "SystemHelper";
-static bool time_synced = false;
+static int64_t mono_offset_us = 0;
 
-static void time_sync_callback(struct timeval* tv)
+void init_clock()
 {
-    ESP_LOGI(TAG, "Time synchronized: %lld", tv->tv_sec);
-    sntp_set_sync_interval(TIME_SYNC_AFT_INTERVAL_MS);
-    time_synced = true;
+    /* The RTC timer runs through deep sleep, esp_timer starts over at every boot */
+    mono_offset_us = static_cast<int64_t>(esp_rtc_get_time_us()) - esp_timer_get_time();
 }
 
-bool is_synced_time()
+int64_t get_mono_time_us()
 {
-    return time_synced;
+    return esp_timer_get_time() + mono_offset_us;
 }
 
-void sync_time()
+uint64_t get_wall_time()
 {
-    int waiting_cnt = 0;
-    time_synced = false;
-
-    esp_sntp_stop();
-    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    sntp_set_sync_interval(TIME_SYNC_BEF_INTERVAL_MS);
-    esp_sntp_setservername(0, SNTP_SERVER_FQDN);
-    sntp_set_time_sync_notification_cb(time_sync_callback);
-    esp_sntp_init();
-
-    while (!time_synced && (++waiting_cnt) < TIME_SYNC_MAX_WAIT_CNT)
-        vTaskDelay(pdMS_TO_TICKS(1000));
-
-    if (!time_synced && waiting_cnt >= TIME_SYNC_MAX_WAIT_CNT)
-        ESP_LOGE(TAG, "Failed to synchronize time");
+    return static_cast<uint64_t>(time(NULL));
 }
 
-uint64_t get_time()
+/* Converted at use, so an SNTP step between the stamp and now is already accounted for */
+uint64_t to_wall_time(int64_t mono_us)
 {
-    return static_cast<uint64_t>(time(NULL));
+    if (!is_time_trusted())
+        return 0;
+
+    return get_wall_time() - static_cast<uint64_t>((get_mono_time_us() - mono_us) / 1000000);
 }
\ No newline at end of file
@@ -3,15 +3,22 @@
 
 #include <cstdint>
 
-#define SNTP_SERVER_FQDN            ( "pool.ntp.org" )
-#define TIME_SYNC_MAX_WAIT_CNT      ( 30 )
-#define TIME_SYNC_BEF_INTERVAL_MS   ( 15000 )
-#define TIME_SYNC_AFT_INTERVAL_MS   ( 60 * 60 * 1000 )
-
 void init_nvs();
 
-bool is_synced_time();
-void sync_time();
-uint64_t get_time();
+/* Call first thing in app_main, before anything reads the monotonic clock */
+void init_clock();
+
+/*
+ * Monotonic microseconds for timeouts and deadlines, never stepped by SNTP.
+ * esp_timer within a boot, carried across deep sleep by the RTC timer, so deadlines kept in RTC memory stay valid.
+ * Differences between two esp_timer stamps of the same boot are the same in both clocks.
+ */
+int64_t get_mono_time_us();
+
+/* Wall clock seconds since the epoch, for telemetry, certificates and anything persisted in NVS. Jumps on SNTP sync, see helper/time_sync.h */
+uint64_t get_wall_time();
+
+/* Wall clock seconds at an earlier get_mono_time_us() stamp, 0 while the wall clock is not trusted */
+uint64_t to_wall_time(int64_t mono_us);
 
 #endif
\ No newline at end of file
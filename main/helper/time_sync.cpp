@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cinttypes>
+#include <sys/time.h>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_sntp.h>
+#include <esp_system.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include "rtos_arena.h"
+#include "system.h"
+#include "time_sync.h"
+
+#define TIME_SYNC_MAGIC             ( 0x544D5331U )  /* "TMS1" */
+#define EVENT_BITS_TIME_TRUSTED     ( BIT0 )
+
+using namespace std;
+
+/* Lives in RTC memory, the wall clock and this only survive deep sleep together */
+typedef struct TimeSyncState_s
+{
+    uint32_t magic;
+    bool is_drift_known;
+    int32_t drift_ppm;          /* Sleep clock runs slow by this much, true time = slept * (1 + drift) */
+    int64_t synced_mono_us;     /* get_mono_time_us() at the last SNTP sync, 0 if never */
+    int64_t synced_wall_us;     /* Wall clock right after that sync */
+    int64_t slept_us;           /* Spent in deep sleep since the sync */
+    int64_t corrected_us;       /* Drift correction applied to the wall clock since the sync */
+    int64_t sleep_entered_us;   /* get_mono_time_us() at the last suspend_time_sync(), 0 while awake */
+} TimeSyncState_t;
+
+static const char* TAG = "TimeSyncHelper";
+static RTC_DATA_ATTR TimeSyncState_t state;
+static portMUX_TYPE state_lock = portMUX_INITIALIZER_UNLOCKED;
+static EventGroupHandle_t time_event_handle = nullptr;
+
+static int64_t get_wall_time_us()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+static void set_wall_time_us(int64_t time_us)
+{
+    struct timeval tv = { static_cast<time_t>(time_us / 1000000), static_cast<suseconds_t>(time_us % 1000000) };
+    settimeofday(&tv, NULL);
+}
+
+/* Worst case error of the wall clock now, caller holds state_lock */
+static int64_t get_error_bound_us(int64_t now)
+{
+    if (state.synced_mono_us == 0)
+        return INT64_MAX;
+
+    int64_t awake_us = max<int64_t>(now - state.synced_mono_us - state.slept_us, 0);
+    int64_t sleep_ppm = state.is_drift_known ? TIME_DRIFT_MARGIN_PPM : TIME_RTC_DRIFT_PPM;
+
+    return (state.slept_us * sleep_ppm + awake_us * TIME_XTAL_DRIFT_PPM) / 1000000;
+}
+
+static bool is_sync_due(int64_t now)
+{
+    portENTER_CRITICAL(&state_lock);
+    bool is_due = get_error_bound_us(now) >= TIME_RESYNC_TOLERANCE_MS * 1000LL ||
+                  now - state.synced_mono_us >= TIME_SYNC_MAX_AGE_S * 1000000LL;
+    portEXIT_CRITICAL(&state_lock);
+
+    return is_due;
+}
+
+/* lwIP task, the wall clock has just been stepped to tv */
+static void time_sync_callback(struct timeval* tv)
+{
+    int64_t now = get_mono_time_us();
+    int64_t synced_wall_us = static_cast<int64_t>(tv->tv_sec) * 1000000 + tv->tv_usec;
+
+    portENTER_CRITICAL(&state_lock);
+
+    /* What the local clock would have read: the same base as the monotonic clock, plus the corrections */
+    if (state.synced_mono_us != 0 && state.slept_us >= TIME_DRIFT_MIN_SLEEP_S * 1000000LL)
+    {
+        int64_t local_wall_us = state.synced_wall_us + (now - state.synced_mono_us) + state.corrected_us;
+        int64_t residual_ppm = (synced_wall_us - local_wall_us) * 1000000 / state.slept_us;
+
+        state.drift_ppm = static_cast<int32_t>(clamp<int64_t>(state.drift_ppm + residual_ppm, -TIME_DRIFT_MAX_PPM, TIME_DRIFT_MAX_PPM));
+        state.is_drift_known = true;
+    }
+
+    state.synced_mono_us = now;
+    state.synced_wall_us = synced_wall_us;
+    state.slept_us = 0;
+    state.corrected_us = 0;
+
+    portEXIT_CRITICAL(&state_lock);
+
+    ESP_LOGI(TAG, "Time synchronized: %lld, sleep drift %" PRId32 " ppm", tv->tv_sec, state.drift_ppm);
+    sntp_set_sync_interval(TIME_SYNC_AFT_INTERVAL_MS);
+    xEventGroupSetBits(time_event_handle, EVENT_BITS_TIME_TRUSTED);
+}
+
+void init_time_sync()
+{
+    int64_t now = get_mono_time_us();
+
+    time_event_handle = create_static_event_group(Subsystem::Network);
+
+    /* The drift is a property of the chip, it is kept even when the wall clock is not */
+    if (state.magic != TIME_SYNC_MAGIC)
+        state = { TIME_SYNC_MAGIC, false, 0, 0, 0, 0, 0, 0 };
+
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP)
+        state.synced_mono_us = 0;
+
+    if (state.synced_mono_us != 0 && state.sleep_entered_us != 0 && now > state.sleep_entered_us)
+    {
+        int64_t slept_us = now - state.sleep_entered_us;
+        int64_t correction_us = slept_us * state.drift_ppm / 1000000;
+
+        set_wall_time_us(get_wall_time_us() + correction_us);
+        state.slept_us += slept_us;
+        state.corrected_us += correction_us;
+    }
+
+    state.sleep_entered_us = 0;
+
+    int64_t error_bound_us = get_error_bound_us(now);
+
+    if (error_bound_us <= TIME_TRUST_TOLERANCE_MS * 1000LL)
+    {
+        ESP_LOGI(TAG, "Wall time trusted, within %lld ms", error_bound_us / 1000);
+        xEventGroupSetBits(time_event_handle, EVENT_BITS_TIME_TRUSTED);
+    }
+}
+
+void start_time_sync()
+{
+    if (!is_sync_due(get_mono_time_us()))
+        return;
+
+    /* Fast retries until the first answer, then the callback backs off */
+    sntp_set_sync_interval(is_time_trusted() ? TIME_SYNC_AFT_INTERVAL_MS : TIME_SYNC_BEF_INTERVAL_MS);
+
+    if (esp_sntp_enabled())
+    {
+        esp_sntp_restart();
+        return;
+    }
+
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, SNTP_SERVER_FQDN);
+    sntp_set_time_sync_notification_cb(time_sync_callback);
+    esp_sntp_init();
+}
+
+void suspend_time_sync()
+{
+    if (esp_sntp_enabled())
+        esp_sntp_stop();
+
+    portENTER_CRITICAL(&state_lock);
+    state.sleep_entered_us = get_mono_time_us();
+    portEXIT_CRITICAL(&state_lock);
+}
+
+bool is_time_trusted()
+{
+    return (xEventGroupGetBits(time_event_handle) & EVENT_BITS_TIME_TRUSTED) != 0;
+}
+
+void wait_time_trusted()
+{
+    xEventGroupWaitBits(time_event_handle, EVENT_BITS_TIME_TRUSTED, pdFALSE, pdTRUE, portMAX_DELAY);
+}
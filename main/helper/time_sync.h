@@ -0,0 +1,35 @@
+#ifndef _H_TIME_SYNC_HELPER_H_
+#define _H_TIME_SYNC_HELPER_H_
+
+#include <cstdint>
+
+#define SNTP_SERVER_FQDN            ( "pool.ntp.org" )
+#define TIME_SYNC_BEF_INTERVAL_MS   ( 15000 )               /* SNTP retry while no answer came back yet */
+#define TIME_SYNC_AFT_INTERVAL_MS   ( 60 * 60 * 1000 )      /* SNTP repoll while awake */
+#define TIME_SYNC_MAX_AGE_S         ( 24 * 60 * 60 )        /* Resync however good the estimate is */
+#define TIME_TRUST_TOLERANCE_MS     ( 5000 )                /* Estimated error up to which wall time is trusted without SNTP */
+#define TIME_RESYNC_TOLERANCE_MS    ( 1000 )                /* Estimated error from which SNTP runs in the background */
+#define TIME_RTC_DRIFT_PPM          ( 500 )                 /* Assumed sleep clock error until a drift has been measured */
+#define TIME_DRIFT_MARGIN_PPM       ( 50 )                  /* Error left after correcting by the measured drift */
+#define TIME_XTAL_DRIFT_PPM         ( 20 )                  /* esp_timer while awake */
+#define TIME_DRIFT_MIN_SLEEP_S      ( 10 * 60 )             /* Shorter sleeps drown in the SNTP round trip */
+#define TIME_DRIFT_MAX_PPM          ( 50000 )
+
+/*
+ * Wall time survives deep sleep in the RTC timer, which runs off the slow clock and drifts.
+ * Every SNTP sync measures that drift over the time slept since the previous one, every wake corrects by it.
+ * Call after init_clock() and before anything reads the wall clock.
+ */
+void init_time_sync();
+
+/* Non-blocking, starts SNTP only when the estimated error or the age of the last sync is over its limit */
+void start_time_sync();
+
+/* Stops SNTP and stamps the sleep, call right before deep sleep */
+void suspend_time_sync();
+
+/* The wall clock is known to be within TIME_TRUST_TOLERANCE_MS */
+bool is_time_trusted();
+void wait_time_trusted();
+
+#endif
@@ -0,0 +1,64 @@
+#include <atomic>
+#include <cstdio>
+
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "trace.h"
+
+#define TRACE_RECORDS_PER_LINE  ( 16 )
+
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE must be a power of two");
+static_assert(sizeof(TraceRecord_t) == 8, "Trace record layout is shared with tools/trace_decode.py");
+
+static const char* TAG = "TraceHelper";
+
+static TraceRecord_t trace_ring[TRACE_RING_SIZE];
+static std::atomic<uint32_t> trace_head(0);
+static uint32_t trace_dumped = 0;
+
+/* Lock-free, writers claim a slot with one atomic add and never wait on each other */
+void trace_record(TracePoint point, uint16_t arg, int64_t time_us)
+{
+    uint32_t slot = trace_head.fetch_add(1, std::memory_order_relaxed) & (TRACE_RING_SIZE - 1);
+    TraceRecord_t& record = trace_ring[slot];
+
+    record.time_us = static_cast<uint32_t>(time_us != 0 ? time_us : esp_timer_get_time());
+    record.point = static_cast<uint8_t>(point);
+    record.core = static_cast<uint8_t>(esp_cpu_get_core_id());
+    record.arg = arg;
+}
+
+/* Runs off the critical path (before deep sleep), a record written during the dump may come out torn */
+void dump_trace()
+{
+    uint32_t head = trace_head.load(std::memory_order_acquire);
+    uint32_t dropped = 0;
+
+    if (head - trace_dumped > TRACE_RING_SIZE)
+    {
+        dropped = head - trace_dumped - TRACE_RING_SIZE;
+        trace_dumped = head - TRACE_RING_SIZE;
+    }
+
+    if (dropped > 0)
+        ESP_LOGW(TAG, "%lu trace records overwritten before dump", dropped);
+
+    while (trace_dumped != head)
+    {
+        printf(TRACE_DUMP_PREFIX);
+
+        for (uint8_t i = 0; i < TRACE_RECORDS_PER_LINE && trace_dumped != head; ++i, ++trace_dumped)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&trace_ring[trace_dumped & (TRACE_RING_SIZE - 1)]);
+
+            for (size_t j = 0; j < sizeof(TraceRecord_t); ++j)
+                printf("%02x", bytes[j]);
+        }
+
+        printf("\n");
+    }
+
+    fflush(stdout);
+}
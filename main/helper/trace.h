@@ -0,0 +1,50 @@
+#ifndef _H_TRACE_HELPER_H_
+#define _H_TRACE_HELPER_H_
+
+#include <cstdint>
+
+/* Set to 0 and every TRACE()/TRACE_AT() compiles away */
+#define TRACE_ENABLED       ( 1 )
+#define TRACE_RING_SIZE     ( 512 )     /* Records, power of two */
+#define TRACE_DUMP_PREFIX   "TRC "
+
+/* Append only, tools/trace_decode.py decodes by value */
+enum class TracePoint : uint8_t
+{
+    FingerTouched,      /* arg: 0 */
+    FpCaptured,         /* arg: 0 */
+    FpTemplated,        /* arg: 0 */
+    FpSearched,         /* arg: 1 when a match was found */
+    KeyPressed,         /* arg: key */
+    FsmTransition,      /* arg: input << 8 | next state */
+    MotorStart,         /* arg: 1 open, 0 close */
+    MotorDone,          /* arg: 1 open, 0 close */
+    AudioStart,         /* arg: AudioName */
+    AudioDone,          /* arg: AudioName */
+    SleepEntered,       /* arg: 0 */
+    Count,
+};
+
+/* 8 bytes on the wire, little endian */
+typedef struct TraceRecord_s
+{
+    uint32_t time_us;   /* esp_timer, wraps after ~71 min */
+    uint8_t point;
+    uint8_t core;
+    uint16_t arg;
+} TraceRecord_t;
+
+void trace_record(TracePoint point, uint16_t arg, int64_t time_us);
+
+/* Hex lines prefixed with TRACE_DUMP_PREFIX on the console, only records added since the last dump */
+void dump_trace();
+
+#if TRACE_ENABLED
+#define TRACE(point, arg)               trace_record(TracePoint::point, (arg), 0)
+#define TRACE_AT(point, arg, time_us)   trace_record(TracePoint::point, (arg), (time_us))
+#else
+#define TRACE(point, arg)               do { } while (0)
+#define TRACE_AT(point, arg, time_us)   do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+
+#include "warm_start.h"
+
+#define WARM_START_MAGIC    ( 0x57524D53U )
+
+typedef struct WarmStartImage_s
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t crc;
+    WarmStart_t snapshot;
+} WarmStartImage_t;
+
+static const char* TAG = "WarmStartHelper";
+static RTC_DATA_ATTR WarmStartImage_t image;
+
+static uint32_t get_snapshot_crc(const WarmStart_t& snapshot)
+{
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&snapshot), sizeof(snapshot));
+}
+
+bool load_warm_start(WarmStart_t* snapshot)
+{
+    bool valid = image.magic == WARM_START_MAGIC &&
+                 image.version == WARM_START_VERSION &&
+                 image.crc == get_snapshot_crc(image.snapshot);
+
+    /* One shot, a crash after waking must not restore the same state again */
+    image.magic = 0;
+
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP)
+        return false;
+
+    if (!valid)
+    {
+        ESP_LOGW(TAG, "Snapshot missing or corrupt, cold start");
+        return false;
+    }
+
+    *snapshot = image.snapshot;
+    snapshot->iot_hub_hostname[AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN - 1] = 0;
+    snapshot->iot_hub_dev_id[AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN - 1] = 0;
+
+    ESP_LOGI(TAG, "Warm start");
+    return true;
+}
+
+void save_warm_start(const WarmStart_t& snapshot)
+{
+    image.snapshot = snapshot;
+    image.version = WARM_START_VERSION;
+    image.crc = get_snapshot_crc(image.snapshot);
+    image.magic = WARM_START_MAGIC;
+}
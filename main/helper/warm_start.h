@@ -0,0 +1,29 @@
+#ifndef _H_WARM_START_HELPER_H_
+#define _H_WARM_START_HELPER_H_
+
+#include <cstdint>
+
+#include "config.h"
+#include "hash.h"
+
+#define WARM_START_VERSION  ( 5U )
+
+/* Fast-path state carried across deep sleep in RTC memory, so a wake does not redo NVS and DPS, the wall clock is kept by helper/time_sync.h */
+typedef struct WarmStart_s
+{
+    uint8_t door_state;                 /* DoorState */
+    uint8_t door_status;                /* DoorStatus */
+    uint8_t pwd_mismatch_cnt;
+    uint8_t fingerprint_mismatch_cnt;
+    int64_t lockdown_deadline;          /* get_mono_time_us(), 0 when not in lockdown */
+    uint8_t pin_salt[PIN_SALT_LEN];
+    uint8_t password_digest[PIN_DIGEST_LEN];
+    char iot_hub_hostname[AZURE_IOT_HUB_HOSTNAME_BUF_MAX_LEN];
+    char iot_hub_dev_id[AZURE_IOT_HUB_DEV_ID_BUF_MAX_LEN];
+} WarmStart_t;
+
+/* Only succeeds on a deep sleep wake with an intact snapshot, the snapshot is consumed either way */
+bool load_warm_start(WarmStart_t* snapshot);
+void save_warm_start(const WarmStart_t& snapshot);
+
+#endif
@@ -0,0 +1,130 @@
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_memory_utils.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <mbedtls/platform.h>
+
+#include "mem_policy.h"
+
+#define NUM_MEM_TIERS   ( static_cast<size_t>(MemTier::Count) )
+
+typedef struct MemTierConfig_s
+{
+    const char* name;
+    uint32_t caps;
+} MemTierConfig_t;
+
+typedef struct MemTierUsage_s
+{
+    size_t used;
+    size_t peak;
+    uint32_t fallback_cnt;      /* Requests served by the other tier */
+} MemTierUsage_t;
+
+static const char* TAG = "MemPolicy";
+
+/* Indexed by MemTier */
+static constexpr MemTierConfig_t MEM_TIER_CONFIGS[NUM_MEM_TIERS] = {
+    { "internal",   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT },
+    { "psram",      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT },
+};
+
+static MemTierUsage_t mem_usages[NUM_MEM_TIERS] = { };
+static portMUX_TYPE mem_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Counted where the block actually is, so a fallback is charged to the tier it took memory from */
+static MemTier get_ptr_tier(const void* ptr)
+{
+    return esp_ptr_external_ram(ptr) ? MemTier::PsramBulk : MemTier::InternalFast;
+}
+
+void* mem_alloc(MemTier tier, size_t size)
+{
+    size_t idx = static_cast<size_t>(tier);
+    void* ptr = heap_caps_calloc(1, size, MEM_TIER_CONFIGS[idx].caps);
+    bool is_fallback = ptr == nullptr;
+
+    if (is_fallback)
+    {
+        MemTier other = tier == MemTier::PsramBulk ? MemTier::InternalFast : MemTier::PsramBulk;
+        ptr = heap_caps_calloc(1, size, MEM_TIER_CONFIGS[static_cast<size_t>(other)].caps);
+    }
+
+    if (ptr == nullptr)
+        return nullptr;
+
+    MemTierUsage_t& usage = mem_usages[static_cast<size_t>(get_ptr_tier(ptr))];
+
+    portENTER_CRITICAL(&mem_lock);
+
+    usage.used += heap_caps_get_allocated_size(ptr);
+
+    if (usage.used > usage.peak)
+        usage.peak = usage.used;
+
+    if (is_fallback)
+        ++mem_usages[idx].fallback_cnt;
+
+    portEXIT_CRITICAL(&mem_lock);
+
+    return ptr;
+}
+
+void mem_free(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    MemTierUsage_t& usage = mem_usages[static_cast<size_t>(get_ptr_tier(ptr))];
+    size_t size = heap_caps_get_allocated_size(ptr);
+
+    portENTER_CRITICAL(&mem_lock);
+    usage.used -= size;
+    portEXIT_CRITICAL(&mem_lock);
+
+    heap_caps_free(ptr);
+}
+
+size_t get_mem_tier_peak(MemTier tier)
+{
+    return mem_usages[static_cast<size_t>(tier)].peak;
+}
+
+void log_mem_tiers()
+{
+    for (size_t i = 0; i < NUM_MEM_TIERS; ++i)
+    {
+        const MemTierUsage_t& usage = mem_usages[i];
+
+        ESP_LOGI(TAG, "%-8s used %6u B, peak %6u B, fallbacks %lu, free %6u B", MEM_TIER_CONFIGS[i].name,
+                 usage.used, usage.peak, usage.fallback_cnt, heap_caps_get_free_size(MEM_TIER_CONFIGS[i].caps));
+    }
+}
+
+/*
+ * The 16 KB input and 4 KB output records and parsed certificates go to PSRAM,
+ * contexts and bignums stay internal since every handshake step walks them.
+ */
+static void* mem_tls_calloc(size_t n, size_t size)
+{
+    size_t total = n * size;
+
+    if (size != 0 && total / size != n)
+        return nullptr;
+
+    return mem_alloc(total >= MEM_TLS_BULK_MIN_SIZE ? MemTier::PsramBulk : MemTier::InternalFast, total);
+}
+
+static void mem_tls_free(void* ptr)
+{
+    mem_free(ptr);
+}
+
+void init_mem_policy()
+{
+    /* CONFIG_MBEDTLS_CUSTOM_MEM_ALLOC leaves mbedTLS on plain calloc until this runs */
+    if (mbedtls_platform_set_calloc_free(mem_tls_calloc, mem_tls_free) != 0)
+        ESP_LOGE(TAG, "Failed to set the mbedTLS allocator");
+}
@@ -0,0 +1,33 @@
+#ifndef _H_MEM_POLICY_H_
+#define _H_MEM_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define MEM_TLS_BULK_MIN_SIZE   ( 1024 )    /* mbedTLS allocations from this size on are records and certificates */
+
+/*
+ * Where a buffer lives. Internal SRAM is kept for DMA, ISRs and data touched on every step of a handshake,
+ * buffers that are large and only walked now and then go to PSRAM.
+ * A tier that is exhausted falls back to the other one, the report counts how often.
+ */
+enum class MemTier : uint8_t
+{
+    InternalFast,
+    PsramBulk,
+    Count,
+};
+
+/* Zeroed, like calloc. Not for anything an ISR reads while the flash cache is off */
+void* mem_alloc(MemTier tier, size_t size);
+void mem_free(void* ptr);
+
+/* Routes mbedTLS through the tiers, call before anything opens a TLS connection */
+void init_mem_policy();
+
+size_t get_mem_tier_peak(MemTier tier);
+
+/* Current and peak bytes per tier, with the fallbacks */
+void log_mem_tiers();
+
+#endif
@@ -12,7 +12,7 @@ using namespace std;
 
 I2SController::I2SController(i2s_std_gpio_config_t gpio_cfg)
 {
-    _ctrl_sem = xSemaphoreCreateMutex();
+    _ctrl_sem = xSemaphoreCreateMutexStatic(&_ctrl_sem_buf);
     _chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
     _gpio_cfg = gpio_cfg;
 
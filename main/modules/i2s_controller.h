@@ -20,6 +20,7 @@ public:
 
 private:
     bool _initialized = false;
+    StaticSemaphore_t _ctrl_sem_buf;
     SemaphoreHandle_t _ctrl_sem;
     i2s_chan_handle_t _tx_handle;
     i2s_chan_config_t _chan_cfg;
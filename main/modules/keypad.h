@@ -3,9 +3,13 @@
 
 #include <functional>
 
+#include <driver/gpio.h>
+
+#include "hal/hal.h"
+
 using namespace std;
 
-class Keypad
+class Keypad : public KeypadMatrix
 {
 public:
     Keypad(size_t num_rows, size_t num_cols, const gpio_num_t* rows, const gpio_num_t* cols, bool is_rtc_gpio);
@@ -14,7 +18,7 @@ public:
     void set_debouncer(function<void(char)> debouncer);
     void set_keymap(const char* keymap);
 
-    char get_pressed_key();
+    char get_pressed_key() override;
 private:
     size_t _num_rows, _num_cols;
     const gpio_num_t* _rows;
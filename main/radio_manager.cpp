@@ -0,0 +1,252 @@
+#include <atomic>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "config.h"
+#include "radio_manager.h"
+#include "task_config.h"
+#include "azure/iot_hub_provisioning.h"
+#include "helper/system.h"
+#include "wifi/station.h"
+
+#define RADIO_SYNC_MAGIC    ( 0x52534E43U )
+#define RADIO_BACKOFF_MAGIC ( 0x52424B46U )
+
+typedef struct RadioSyncState_s
+{
+    uint32_t magic;
+    int64_t last_sync_at;       /* get_mono_time_us() */
+} RadioSyncState_t;
+
+typedef struct RadioBackoffState_s
+{
+    uint32_t magic;
+    uint32_t failed_windows;    /* Windows in a row that ended undrained */
+    int64_t retry_at;           /* get_mono_time_us(), no window starts before it */
+} RadioBackoffState_t;
+
+static const char* TAG = "RadioManager";
+
+static RTC_DATA_ATTR RadioSyncState_t sync_state;
+
+/* An unreachable AP or hub keeps every trigger true, this is what lets the radio rest in between */
+static RTC_DATA_ATTR RadioBackoffState_t backoff_state;
+
+static TaskHandle_t radio_task_handle = nullptr;
+static OutboxLenFn outbox_len = nullptr;
+static volatile uint8_t pending_priority = static_cast<uint8_t>(TelPriority::Low);
+static volatile bool radio_on = false;
+
+static int64_t radio_on_time = 0;
+static int64_t drained_time = 0;
+/* Set by the reactor on core 1, read and cleared by the radio task on core 0, a plain 64-bit access can tear */
+static std::atomic<int64_t> prewarm_deadline(0);
+static bool is_prewarm_only = false;
+
+static bool is_sync_due()
+{
+    if (sync_state.magic != RADIO_SYNC_MAGIC)
+        return true;
+
+    return get_mono_time_us() - sync_state.last_sync_at >= RADIO_SYNC_INTERVAL_S * 1000000LL;
+}
+
+static int64_t get_backoff_left_us()
+{
+    if (backoff_state.magic != RADIO_BACKOFF_MAGIC || backoff_state.failed_windows == 0)
+        return 0;
+
+    int64_t left_us = backoff_state.retry_at - get_mono_time_us();
+    return left_us > 0 ? left_us : 0;
+}
+
+static void on_window_failed()
+{
+    if (backoff_state.magic != RADIO_BACKOFF_MAGIC)
+        backoff_state = { RADIO_BACKOFF_MAGIC, 0, 0 };
+
+    uint32_t shift = backoff_state.failed_windows < 31 ? backoff_state.failed_windows : 31;
+    uint64_t delay_s = static_cast<uint64_t>(RADIO_RETRY_BASE_S) << shift;
+
+    if (delay_s > RADIO_RETRY_MAX_S)
+        delay_s = RADIO_RETRY_MAX_S;
+
+    ++backoff_state.failed_windows;
+    backoff_state.retry_at = get_mono_time_us() + static_cast<int64_t>(delay_s) * 1000000LL;
+
+    ESP_LOGW(TAG, "Window %lu in a row failed, radio rests for %llu s", backoff_state.failed_windows, delay_s);
+}
+
+uint64_t get_radio_sync_due_in_s()
+{
+    int64_t backoff_left_us = get_backoff_left_us();
+
+    if (backoff_left_us > 0)
+        return (backoff_left_us + 999999) / 1000000;
+
+    if (is_sync_due())
+        return 0;
+
+    return (sync_state.last_sync_at + RADIO_SYNC_INTERVAL_S * 1000000LL - get_mono_time_us() + 999999) / 1000000;
+}
+
+static bool has_pending_work()
+{
+    if (pending_priority >= static_cast<uint8_t>(RADIO_WAKE_MIN_PRIORITY))
+        return true;
+
+    return outbox_len() >= RADIO_OUTBOX_WATERMARK || is_sync_due();
+}
+
+static bool is_prewarming()
+{
+    return esp_timer_get_time() < prewarm_deadline.load();
+}
+
+static bool should_start()
+{
+    /* A pre-warm is held back as well, the link it would bring up has just failed */
+    if (get_backoff_left_us() > 0)
+        return false;
+
+    return has_pending_work() || is_prewarming();
+}
+
+static bool should_stop()
+{
+    int64_t now = esp_timer_get_time();
+
+    if (now - radio_on_time >= RADIO_MAX_ON_MS * 1000LL)
+    {
+        ESP_LOGW(TAG, "Radio window timed out, %zu telemetry left", outbox_len());
+        return true;
+    }
+
+    if (is_prewarming())
+        return false;
+
+    if (is_prewarm_only && has_pending_work())
+        is_prewarm_only = false;
+
+    /* Nothing came of the interaction, drop the link instead of lingering for a sync that is not due */
+    if (is_prewarm_only && outbox_len() == 0)
+    {
+        ESP_LOGI(TAG, "Pre-warm unused, cancelled");
+        return true;
+    }
+
+    /* The hub must be up for a drained outbox to mean anything, provisioning also runs in this window */
+    if (!is_iot_hub_connected() || outbox_len() > 0)
+    {
+        drained_time = 0;
+        return false;
+    }
+
+    if (drained_time == 0)
+        drained_time = now;
+
+    return now - drained_time >= RADIO_LINGER_MS * 1000LL;
+}
+
+static void start_radio()
+{
+    ESP_LOGI(TAG, "Radio on, priority: %u, outbox: %zu", pending_priority, outbox_len());
+
+    radio_on_time = esp_timer_get_time();
+    drained_time = 0;
+    is_prewarm_only = !has_pending_work();
+    radio_on = true;
+
+    connect(WIFI_AP_SSID, WIFI_AP_PASSWORD, WIFI_AP_AUTH_MODE);
+}
+
+static void stop_radio()
+{
+    bool is_link_up = is_iot_hub_connected();
+    bool drained = outbox_len() == 0 && is_link_up;
+
+    /* Only a pre-warm that got the hub up is free, one that could not connect backs off like any other window */
+    bool is_unused_prewarm = is_prewarm_only && outbox_len() == 0 && is_link_up;
+
+    disconnect_iot_hub();
+    stop_wifi_sta();
+    radio_on = false;
+    prewarm_deadline.store(0);
+
+    /* A window that could not drain is retried after the backoff instead of waiting a full interval */
+    if (drained)
+    {
+        sync_state.last_sync_at = get_mono_time_us();
+        sync_state.magic = RADIO_SYNC_MAGIC;
+        pending_priority = static_cast<uint8_t>(TelPriority::Low);
+        backoff_state.failed_windows = 0;
+    }
+    else if (!is_unused_prewarm)
+        on_window_failed();
+
+    ESP_LOGI(TAG, "Radio off after %lld ms", (esp_timer_get_time() - radio_on_time) / 1000);
+}
+
+static void radio_loop()
+{
+    auto task = [](void* pvParameters)
+    {
+        while (true)
+        {
+            if (!radio_on)
+            {
+                if (should_start())
+                {
+                    start_radio();
+                    continue;
+                }
+
+                /* Sleeps until telemetry is queued or the sync window comes up */
+                xTaskNotifyWait(0, UINT32_MAX, NULL, pdMS_TO_TICKS(get_radio_sync_due_in_s() * 1000));
+                continue;
+            }
+
+            vTaskDelay(pdMS_TO_TICKS(RADIO_POLL_MS));
+
+            if (should_stop())
+                stop_radio();
+        }
+
+        vTaskDelete(NULL);
+    };
+
+    create_task(TaskId::Radio, task, NULL, &radio_task_handle);
+}
+
+void init_radio_manager(OutboxLenFn get_outbox_len)
+{
+    outbox_len = get_outbox_len;
+    radio_loop();
+}
+
+void notify_outbox(TelPriority priority)
+{
+    if (static_cast<uint8_t>(priority) > pending_priority)
+        pending_priority = static_cast<uint8_t>(priority);
+
+    if (radio_task_handle != nullptr)
+        xTaskNotifyGive(radio_task_handle);
+}
+
+void prewarm_radio()
+{
+    prewarm_deadline.store(esp_timer_get_time() + RADIO_PREWARM_TIMEOUT_MS * 1000LL);
+
+    if (radio_task_handle != nullptr)
+        xTaskNotifyGive(radio_task_handle);
+}
+
+bool is_radio_on()
+{
+    return radio_on;
+}
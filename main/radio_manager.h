@@ -0,0 +1,41 @@
+#ifndef _H_RADIO_MANAGER_H_
+#define _H_RADIO_MANAGER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#define RADIO_WAKE_MIN_PRIORITY     ( TelPriority::Normal )
+#define RADIO_OUTBOX_WATERMARK      ( 8U )
+#define RADIO_SYNC_INTERVAL_S       ( 60 * 60U )
+#define RADIO_LINGER_MS             ( 5 * 1000U )       /* Stay up after draining for twin updates and commands */
+#define RADIO_MAX_ON_MS             ( 60 * 1000U )      /* Give up on an unreachable AP or hub */
+#define RADIO_PREWARM_TIMEOUT_MS    ( 20 * 1000U )      /* A pre-warm nobody used is cancelled after this */
+#define RADIO_POLL_MS               ( 500U )
+#define RADIO_MIN_SLEEP_WAKEUP_S    ( 60U )             /* Floor for the deep sleep timer wakeup */
+#define RADIO_RETRY_BASE_S          ( 60U )             /* Rest after the first window that could not drain, doubled per failure */
+#define RADIO_RETRY_MAX_S           ( RADIO_SYNC_INTERVAL_S )
+
+enum class TelPriority : uint8_t
+{
+    Low,        /* Rides along with the next window */
+    Normal,
+    High,
+};
+
+typedef size_t (*OutboxLenFn)();
+
+/* Wi-Fi only runs while something is due: urgent telemetry, a full outbox or the periodic cloud sync */
+void init_radio_manager(OutboxLenFn get_outbox_len);
+
+/* Called after telemetry is queued */
+void notify_outbox(TelPriority priority);
+
+/* Someone is at the door, bring the link up while they authenticate so the result goes out at once */
+void prewarm_radio();
+
+bool is_radio_on();
+
+/* Deep sleep sets a timer wakeup from this so the next sync window is not missed, a failure backoff pushes it out */
+uint64_t get_radio_sync_due_in_s();
+
+#endif
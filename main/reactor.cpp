@@ -0,0 +1,58 @@
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include "config.h"
+#include "reactor.h"
+#include "rtos_arena.h"
+#include "task_config.h"
+
+static const char* TAG = "Reactor";
+
+static QueueHandle_t event_queue = nullptr;
+static EventHandler event_handler = nullptr;
+
+void init_reactor(EventHandler handler)
+{
+    event_handler = handler;
+    event_queue = create_static_queue(Subsystem::Core, REACTOR_QUEUE_SIZE, sizeof(Event_t));
+
+    auto task = [](void* pvParameters)
+    {
+        Event_t event;
+
+        while (true)
+        {
+            /* Blocks without a timeout, so the idle task and tickless idle get the core between events */
+            if (xQueueReceive(event_queue, &event, portMAX_DELAY) == pdTRUE)
+                event_handler(event);
+        }
+
+        vTaskDelete(NULL);
+    };
+
+    create_task(TaskId::Reactor, task);
+}
+
+bool post_event(EventType type, uint32_t arg)
+{
+    Event_t event = { type, arg, esp_timer_get_time() };
+
+    if (!event_queue || xQueueSend(event_queue, &event, 0) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "Event dropped: %d", static_cast<int>(type));
+        return false;
+    }
+
+    return true;
+}
+
+bool IRAM_ATTR post_event_from_isr(EventType type, uint32_t arg, BaseType_t* higher_prio_task_woken)
+{
+    Event_t event = { type, arg, esp_timer_get_time() };
+
+    return event_queue && xQueueSendFromISR(event_queue, &event, higher_prio_task_woken) == pdTRUE;
+}
@@ -0,0 +1,42 @@
+#ifndef _H_REACTOR_H_
+#define _H_REACTOR_H_
+
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+
+#include "helper/jitter_bench.h"
+
+enum class EventType : uint8_t
+{
+    ButtonPressed,          /* arg: gpio */
+    KeyActivity,            /* A keypad row went high */
+    FingerTouched,
+    PresenceDetected,       /* PIR */
+    FingerprintSearched,    /* arg: 1 when matched */
+    EnrollmentDone,         /* arg: enrollment status bits */
+    ActivityTimeout,
+    LockdownExpired,
+    AutoCloseDue,
+    DoorRequested,          /* arg: DoorCommand */
+#if JITTER_BENCH_ENABLED
+    KeyInjected,            /* A key beep without the keypad scan */
+#endif
+};
+
+typedef struct Event_s
+{
+    EventType type;
+    uint32_t arg;
+    int64_t time_us;        /* Stamped when posted */
+} Event_t;
+
+typedef void (*EventHandler)(const Event_t& event);
+
+/* Every state change runs on the single dispatcher task, producers only post events */
+void init_reactor(EventHandler handler);
+
+bool post_event(EventType type, uint32_t arg = 0);
+bool post_event_from_isr(EventType type, uint32_t arg, BaseType_t* higher_prio_task_woken);
+
+#endif
@@ -0,0 +1,147 @@
+#include <esp_log.h>
+
+#include "config.h"
+#include "mem_policy.h"
+#include "reactor.h"
+#include "rtos_arena.h"
+#include "task.h"
+#include "task_config.h"
+#include "helper/deferred_log.h"
+
+#define NUM_SUBSYSTEMS  ( static_cast<size_t>(Subsystem::Count) )
+#define ARENA_ALIGN     ( 8 )
+#define ARENA_SLACK     ( 8 * ARENA_ALIGN )     /* Alignment padding between objects */
+
+typedef struct ArenaBudget_s
+{
+    const char* name;
+    size_t size;
+} ArenaBudget_t;
+
+static const char* TAG = "RtosArena";
+
+/* Indexed by Subsystem. Queue storage is length x item size */
+static constexpr ArenaBudget_t ARENA_BUDGETS[NUM_SUBSYSTEMS] = {
+    /* Reactor events, actions, fingerprint jobs */
+    { "core",           3 * sizeof(StaticQueue_t) +
+                        REACTOR_QUEUE_SIZE * sizeof(Event_t) + ACTION_QUEUE_SIZE * ARENA_ACTION_SIZE + FP_JOB_QUEUE_SIZE * ARENA_FP_JOB_SIZE + ARENA_SLACK },
+
+    /* Reader mutex, execute_task() status and result groups */
+    { "fingerprint",    (1 + TASK_INFO_POOL_SIZE) * sizeof(StaticSemaphore_t) + 2 * TASK_INFO_POOL_SIZE * sizeof(StaticEventGroup_t) + ARENA_SLACK },
+
+    /* Station and time sync groups */
+    { "network",        2 * sizeof(StaticEventGroup_t) + ARENA_SLACK },
+
+    /* Telemetry queue control block, its storage is in PSRAM. DPS and hub groups, hub client mutex */
+    { "azure",          sizeof(StaticQueue_t) + 2 * sizeof(StaticEventGroup_t) + sizeof(StaticSemaphore_t) + ARENA_SLACK },
+
+    /* Deferred log records */
+    { "logging",        sizeof(StaticQueue_t) + DLOG_QUEUE_SIZE * sizeof(DeferredLogRecord_t) + ARENA_SLACK },
+};
+
+static constexpr size_t align_up(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~static_cast<size_t>(ARENA_ALIGN - 1);
+}
+
+static constexpr size_t get_region_offset(size_t idx)
+{
+    size_t offset = 0;
+
+    for (size_t i = 0; i < idx; ++i)
+        offset += align_up(ARENA_BUDGETS[i].size);
+
+    return offset;
+}
+
+/* One symbol in the linker map, its size is the sum of the budgets */
+alignas(ARENA_ALIGN) static uint8_t rtos_arena[get_region_offset(NUM_SUBSYSTEMS)];
+static size_t arena_used[NUM_SUBSYSTEMS] = { 0 };
+static size_t arena_overflow[NUM_SUBSYSTEMS] = { 0 };
+static portMUX_TYPE arena_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void* arena_alloc(Subsystem subsystem, size_t size)
+{
+    size_t idx = static_cast<size_t>(subsystem);
+    size_t aligned_size = align_up(size);
+    void* ptr = nullptr;
+
+    portENTER_CRITICAL(&arena_lock);
+
+    if (arena_used[idx] + aligned_size <= ARENA_BUDGETS[idx].size)
+    {
+        ptr = &rtos_arena[get_region_offset(idx) + arena_used[idx]];
+        arena_used[idx] += aligned_size;
+    }
+    else
+        arena_overflow[idx] += aligned_size;
+
+    portEXIT_CRITICAL(&arena_lock);
+
+    if (ptr == nullptr)
+        ESP_LOGE(TAG, "%s over budget by %u bytes, falling back to the heap", ARENA_BUDGETS[idx].name, arena_overflow[idx]);
+
+    return ptr;
+}
+
+QueueHandle_t create_static_queue(Subsystem subsystem, UBaseType_t length, UBaseType_t item_size)
+{
+    uint8_t* buf = static_cast<uint8_t*>(arena_alloc(subsystem, align_up(sizeof(StaticQueue_t)) + length * item_size));
+
+    if (buf == nullptr)
+        return xQueueCreate(length, item_size);
+
+    return xQueueCreateStatic(length, item_size, buf + align_up(sizeof(StaticQueue_t)), reinterpret_cast<StaticQueue_t*>(buf));
+}
+
+QueueHandle_t create_bulk_queue(Subsystem subsystem, UBaseType_t length, UBaseType_t item_size)
+{
+    StaticQueue_t* buf = static_cast<StaticQueue_t*>(arena_alloc(subsystem, sizeof(StaticQueue_t)));
+    uint8_t* storage = static_cast<uint8_t*>(mem_alloc(MemTier::PsramBulk, length * item_size));
+
+    if (buf != nullptr && storage != nullptr)
+        return xQueueCreateStatic(length, item_size, storage, buf);
+
+    /* The arena slot, if any, stays unused */
+    mem_free(storage);
+    return xQueueCreate(length, item_size);
+}
+
+SemaphoreHandle_t create_static_mutex(Subsystem subsystem, bool is_recursive)
+{
+    StaticSemaphore_t* buf = static_cast<StaticSemaphore_t*>(arena_alloc(subsystem, sizeof(StaticSemaphore_t)));
+
+    if (buf == nullptr)
+        return is_recursive ? xSemaphoreCreateRecursiveMutex() : xSemaphoreCreateMutex();
+
+    return is_recursive ? xSemaphoreCreateRecursiveMutexStatic(buf) : xSemaphoreCreateMutexStatic(buf);
+}
+
+EventGroupHandle_t create_static_event_group(Subsystem subsystem)
+{
+    StaticEventGroup_t* buf = static_cast<StaticEventGroup_t*>(arena_alloc(subsystem, sizeof(StaticEventGroup_t)));
+
+    if (buf == nullptr)
+        return xEventGroupCreate();
+
+    return xEventGroupCreateStatic(buf);
+}
+
+void log_rtos_budget()
+{
+    size_t total_stacks = 0;
+    size_t total_used = 0;
+
+    ESP_LOGI(TAG, "%-12s %8s %14s %9s", "subsystem", "stacks", "objects/budget", "overflow");
+
+    for (size_t i = 0; i < NUM_SUBSYSTEMS; ++i)
+    {
+        size_t stacks = get_task_stack_total(static_cast<Subsystem>(i));
+
+        ESP_LOGI(TAG, "%-12s %8u %6u/%-7u %9u", ARENA_BUDGETS[i].name, stacks, arena_used[i], ARENA_BUDGETS[i].size, arena_overflow[i]);
+        total_stacks += stacks;
+        total_used += arena_used[i];
+    }
+
+    ESP_LOGI(TAG, "%-12s %8u %6u/%-7u", "total", total_stacks, total_used, sizeof(rtos_arena));
+}
\ No newline at end of file
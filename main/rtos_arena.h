@@ -0,0 +1,44 @@
+#ifndef _H_RTOS_ARENA_H_
+#define _H_RTOS_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+/* Items of the app_main queues, app_main.h needs the audio headers so it checks these against its structs */
+#define ARENA_ACTION_SIZE   ( 24 )
+#define ARENA_FP_JOB_SIZE   ( 4 )
+
+/* Owner of each slice of the arena and of each task stack, see ARENA_BUDGETS and TASK_CONFIGS */
+enum class Subsystem : uint8_t
+{
+    Core,           /* Reactor, actuator */
+    Fingerprint,
+    Network,        /* Wi-Fi, radio, time sync */
+    Azure,          /* Provisioning, hub client, telemetry */
+    Logging,
+    Count,
+};
+
+/*
+ * Kernel objects are carved out of one static arena, each subsystem within its own budget, so nothing
+ * the firmware creates touches the heap. Create them from init code, not from static initializers.
+ * Past its budget a subsystem falls back to the heap and says so, the boot report shows by how much.
+ */
+void* arena_alloc(Subsystem subsystem, size_t size);
+
+QueueHandle_t create_static_queue(Subsystem subsystem, UBaseType_t length, UBaseType_t item_size);
+
+/* Control block from the arena, storage from MemTier::PsramBulk. Only for queues no ISR touches */
+QueueHandle_t create_bulk_queue(Subsystem subsystem, UBaseType_t length, UBaseType_t item_size);
+SemaphoreHandle_t create_static_mutex(Subsystem subsystem, bool is_recursive = false);
+EventGroupHandle_t create_static_event_group(Subsystem subsystem);
+
+/* Task stacks and arena use against budget, per subsystem */
+void log_rtos_budget();
+
+#endif
\ No newline at end of file
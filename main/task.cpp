@@ -1,39 +1,90 @@
 #include <cstdint>
 #include <functional>
 #include <string>
-#include <unordered_map>
 
 #include <FreeRTOS/FreeRTOS.h>
 #include <FreeRTOS/event_groups.h>
 #include <FreeRTOS/task.h>
 
+#include "rtos_arena.h"
 #include "task.h"
+#include "task_config.h"
 
 #include <esp_log.h>
 
+#define EXECUTE_TASK_SLOT_WAIT_CNT  ( 10 )
+#define EVENT_BITS_ALL              ( 0x00FFFFFF )
+
 using namespace std;
 
+static const char* TAG = "Task";
+
 typedef struct TaskInfo_s
 {
+    const char* task_name = nullptr;    /* nullptr while the slot is free */
     TaskHandle_t task_handle = nullptr;
     EventGroupHandle_t result_event_handle = nullptr;
     EventGroupHandle_t status_event_handle = nullptr;
     SemaphoreHandle_t task_sem = nullptr;
 } TaskInfo_t;
 
-static unordered_map<const char*, TaskInfo_t> task_infos(50);
+/* The kernel objects are created on first use of a slot and reused, later operations only clear their bits */
+static TaskInfo_t task_infos[TASK_INFO_POOL_SIZE];
+
+static TaskInfo_t* find_task_info(const char* task_name)
+{
+    if (task_name == nullptr)
+        return nullptr;
+
+    for (auto& info: task_infos)
+    {
+        if (info.task_name == task_name)
+            return &info;
+    }
+
+    return nullptr;
+}
+
+static TaskInfo_t* acquire_task_info(const char* task_name)
+{
+    TaskInfo_t* info = nullptr;
+
+    for (auto& slot: task_infos)
+    {
+        if (slot.task_name == nullptr)
+        {
+            info = &slot;
+            break;
+        }
+    }
+
+    if (info == nullptr)
+        return nullptr;
+
+    if (info->status_event_handle == nullptr)
+    {
+        info->result_event_handle = create_static_event_group(Subsystem::Fingerprint);
+        info->status_event_handle = create_static_event_group(Subsystem::Fingerprint);
+        info->task_sem = create_static_mutex(Subsystem::Fingerprint);
+    }
+
+    xEventGroupClearBits(info->result_event_handle, EVENT_BITS_ALL);
+    xEventGroupClearBits(info->status_event_handle, EVENT_BITS_ALL);
+    info->task_handle = nullptr;
+    info->task_name = task_name;
+
+    return info;
+}
 
 bool is_exist_task(const char* task_name)
 {
-    return task_infos.find(task_name) != task_infos.end();
+    return find_task_info(task_name) != nullptr;
 }
 
 bool execute_task(
     TaskFunction_t pxTaskCode,
     const char* pcName, 
-    uint32_t usStackDepth, 
     void* pvParameters,
-    UBaseType_t uxPriority,
     EventBits_t uxBitsToWaitFor,
     BaseType_t xClearOnExit,
     BaseType_t xWaitForAllBits,
@@ -43,19 +94,26 @@ bool execute_task(
     if (is_exist_task(pcName))
         return false;
 
-    task_infos[pcName] = { nullptr, xEventGroupCreate(), xEventGroupCreate(), xSemaphoreCreateMutex() };
-    xEventGroupSetBits(task_infos[pcName].status_event_handle, EVENT_BITS_TASK_RUNNING);
+    TaskInfo_t* info = acquire_task_info(pcName);
+
+    if (info == nullptr)
+    {
+        ESP_LOGE(TAG, "No free task info for %s, raise TASK_INFO_POOL_SIZE", pcName);
+        return false;
+    }
+
+    xEventGroupSetBits(info->status_event_handle, EVENT_BITS_TASK_RUNNING);
 
-    if (xTaskCreate(pxTaskCode, 
-                    pcName, 
-                    usStackDepth, 
-                    pvParameters, 
-                    uxPriority, 
-                    &task_infos[pcName].task_handle) == pdPASS)
+    /* A worker that deleted itself keeps its stack until the idle task has cleaned up, which happens once this core blocks */
+    for (uint8_t i = 0; i < EXECUTE_TASK_SLOT_WAIT_CNT && !is_task_slot_free(TaskId::FingerprintHelper); ++i)
+        vTaskDelay(1);
+
+    /* Only the fingerprint helper runs work through here, its workers share the FingerprintHelper stack */
+    if (create_task(TaskId::FingerprintHelper, pxTaskCode, pvParameters, &info->task_handle, pcName))
     {
         if (status_event_handler)
         {
-            EventBits_t status = xEventGroupWaitBits(   task_infos[pcName].status_event_handle, 
+            EventBits_t status = xEventGroupWaitBits(   info->status_event_handle, 
                                                     uxBitsToWaitFor, xClearOnExit, xWaitForAllBits,
                                                     xTicksToWait);
 
@@ -65,6 +123,7 @@ bool execute_task(
         return true;
     }
 
+    info->task_name = nullptr;
     return false;
 }
 
@@ -74,19 +133,15 @@ bool remove_task(const char* task_name)
 
     if (is_exist_task(task_name))
     {
-        TaskHandle_t task_handle = task_infos[task_name].task_handle;
+        TaskHandle_t task_handle = find_task_info(task_name)->task_handle;
 
         cancel_task(task_name);
 
         if (task_handle && eTaskGetState(task_handle) != eDeleted)
             vTaskDelete(task_handle);
 
-        xSemaphoreGive(task_infos[task_name].task_sem);
-        vSemaphoreDelete(task_infos[task_name].task_sem);
-
-        vEventGroupDelete(task_infos[task_name].result_event_handle);
-        vEventGroupDelete(task_infos[task_name].status_event_handle);
-        task_infos.erase(task_name);
+        /* The slot keeps its kernel objects for the next operation */
+        find_task_info(task_name)->task_name = nullptr;
     }
 
     return res;
@@ -98,7 +153,7 @@ bool cancel_task(const char* task_name)
 
     if (is_exist_task(task_name))
     {
-        EventGroupHandle_t status_event_handle = task_infos[task_name].status_event_handle;
+        EventGroupHandle_t status_event_handle = find_task_info(task_name)->status_event_handle;
         
         xEventGroupSetBits(status_event_handle, EVENT_BITS_TASK_CANCELED);
         xEventGroupWaitBits(status_event_handle, EVENT_BITS_TASK_EXECUTED, pdFALSE, pdTRUE, pdMS_TO_TICKS(DEFAULT_TASK_TIMEOUT));
@@ -114,7 +169,7 @@ EventGroupHandle_t* get_status_event_handle(const char* task_name)
     if (!is_exist_task(task_name))
         return nullptr;
 
-    return &task_infos[task_name].status_event_handle;
+    return &find_task_info(task_name)->status_event_handle;
 }
 
 TaskHandle_t* get_task_handle(const char* task_name)
@@ -122,7 +177,7 @@ TaskHandle_t* get_task_handle(const char* task_name)
     if (!is_exist_task(task_name))
         return nullptr;
 
-    return &task_infos[task_name].task_handle;
+    return &find_task_info(task_name)->task_handle;
 }
 
 EventBits_t get_task_status(const char* task_name)
@@ -131,10 +186,10 @@ EventBits_t get_task_status(const char* task_name)
     
     if (is_exist_task(task_name))
     {
-        if (xSemaphoreTake(task_infos[task_name].task_sem, portMAX_DELAY) == pdTRUE)
+        if (xSemaphoreTake(find_task_info(task_name)->task_sem, portMAX_DELAY) == pdTRUE)
         {
-            res = xEventGroupGetBits(task_infos[task_name].status_event_handle);
-            xSemaphoreGive(task_infos[task_name].task_sem);
+            res = xEventGroupGetBits(find_task_info(task_name)->status_event_handle);
+            xSemaphoreGive(find_task_info(task_name)->task_sem);
         }
     }
 
@@ -147,11 +202,11 @@ bool set_task_status(const char* task_name, EventBits_t status)
 
     if (is_exist_task(task_name))
     {
-        if (xSemaphoreTake(task_infos[task_name].task_sem, portMAX_DELAY) == pdTRUE)
+        if (xSemaphoreTake(find_task_info(task_name)->task_sem, portMAX_DELAY) == pdTRUE)
         {
-            xEventGroupSetBits(task_infos[task_name].status_event_handle, status);
+            xEventGroupSetBits(find_task_info(task_name)->status_event_handle, status);
             res = true;
-            xSemaphoreGive(task_infos[task_name].task_sem);
+            xSemaphoreGive(find_task_info(task_name)->task_sem);
         }
     }
 
@@ -161,7 +216,7 @@ bool set_task_status(const char* task_name, EventBits_t status)
 EventBits_t get_task_result(const char* task_name)
 {
     if (is_exist_task(task_name))
-        return xEventGroupGetBits(task_infos[task_name].result_event_handle);
+        return xEventGroupGetBits(find_task_info(task_name)->result_event_handle);
 
     return EVENT_BITS_TASK_NONE;
 }
@@ -170,7 +225,7 @@ bool set_task_result(const char* task_name, EventBits_t result)
 {
     if (is_exist_task(task_name))
     {
-        xEventGroupSetBits(task_infos[task_name].result_event_handle, result);
+        xEventGroupSetBits(find_task_info(task_name)->result_event_handle, result);
         return true;
     }
 
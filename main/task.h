@@ -19,14 +19,15 @@
 
 constexpr int DEFAULT_TASK_TIMEOUT = 5000;
 
+#define TASK_INFO_POOL_SIZE         ( 3 )   /* execute_task() operations in flight, one per fprh_* worker name */
+
 using namespace std;
 
+/* Runs on the FingerprintHelper stack and priority from TASK_CONFIGS, pcName only keys the status and result groups */
 bool execute_task(
     TaskFunction_t pxTaskCode,
     const char* pcName, 
-    uint32_t usStackDepth, 
     void* pvParameters,
-    UBaseType_t uxPriority,
     EventBits_t uxBitsToWaitFor,
     BaseType_t xClearOnExit,
     BaseType_t xWaitForAllBits,
@@ -37,8 +38,6 @@ template <typename... Args>
 bool execute_task(
     TaskFunction_t pxTaskCode,
     const char* pcName, 
-    uint32_t usStackDepth, 
-    UBaseType_t uxPriority,
     EventBits_t uxBitsToWaitFor,
     BaseType_t xClearOnExit,
     BaseType_t xWaitForAllBits,
@@ -48,8 +47,7 @@ bool execute_task(
 {
     vector<any> ptrs = { static_cast<any>(args) ... };
 
-    return execute_task(pxTaskCode, pcName, usStackDepth, 
-                        &ptrs, uxPriority, 
+    return execute_task(pxTaskCode, pcName, &ptrs,
                         uxBitsToWaitFor, xClearOnExit, xWaitForAllBits,
                         xTicksToWait, status_event_handler);
 };
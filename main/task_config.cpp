@@ -0,0 +1,152 @@
+#include <atomic>
+#include <cstring>
+
+#include <esp_log.h>
+
+#include "config.h"
+#include "task_config.h"
+
+#define NUM_TASKS           ( static_cast<size_t>(TaskId::Count) )
+#define TASK_STACK_ALIGN    ( 16 )
+
+/* Slot 0 belongs to pthread, see sdkconfig.defaults */
+#define TASK_SLOT_TLS_INDEX ( configNUM_THREAD_LOCAL_STORAGE_POINTERS - 1 )
+
+static_assert(configNUM_THREAD_LOCAL_STORAGE_POINTERS >= 2, "Task slots need a thread local storage pointer of their own");
+
+typedef struct TaskSlot_s
+{
+    StaticTask_t tcb;
+    std::atomic<bool> is_busy;
+    TaskFunction_t task;
+    void* arg;
+} TaskSlot_t;
+
+static const char* TAG = "TaskConfig";
+
+/* Indexed by TaskId. UI work outranks everything on its core, network work never shares it */
+static constexpr TaskConfig_t TASK_CONFIGS[NUM_TASKS] = {
+    { "tsk_reactor",    4096,                           tskIDLE_PRIORITY + 6,   TASK_CORE_UI,   Subsystem::Core },
+    { "tsk_actuator",   FREERTOS_DEFAULT_STACK_SIZE,    tskIDLE_PRIORITY + 5,   TASK_CORE_UI,   Subsystem::Core },
+    { "tsk_scan_fp",    4096,                           tskIDLE_PRIORITY + 4,   TASK_CORE_UI,   Subsystem::Fingerprint },
+    { "fprh",           3072,                           tskIDLE_PRIORITY + 4,   TASK_CORE_UI,   Subsystem::Fingerprint },
+
+    { "tsk_init",       3072,                           tskIDLE_PRIORITY + 1,   TASK_CORE_NET,  Subsystem::Azure },
+    { "tsk_az_loop",    FREERTOS_DEFAULT_STACK_SIZE,    tskIDLE_PRIORITY + 2,   TASK_CORE_NET,  Subsystem::Azure },
+    { "tsk_radio",      4096,                           tskIDLE_PRIORITY + 2,   TASK_CORE_NET,  Subsystem::Network },
+    { "tsk_wifi_arp",   3072,                           tskIDLE_PRIORITY + 3,   TASK_CORE_NET,  Subsystem::Network },
+    { "azure-prv-dev",  FREERTOS_DEFAULT_STACK_SIZE,    tskIDLE_PRIORITY + 1,   TASK_CORE_NET,  Subsystem::Azure },
+    { "azure-prv-hub",  FREERTOS_DEFAULT_STACK_SIZE,    tskIDLE_PRIORITY + 1,   TASK_CORE_NET,  Subsystem::Azure },
+    { "tsk_dlog",       3072,                           tskIDLE_PRIORITY + 1,   TASK_CORE_NET,  Subsystem::Logging },
+};
+
+static constexpr size_t get_stack_offset(size_t idx)
+{
+    size_t offset = 0;
+
+    for (size_t i = 0; i < idx; ++i)
+        offset += TASK_CONFIGS[i].stack_size;
+
+    return offset;
+}
+
+static constexpr bool are_stacks_aligned()
+{
+    for (const auto& cfg: TASK_CONFIGS)
+    {
+        if (cfg.stack_size % TASK_STACK_ALIGN != 0)
+            return false;
+    }
+
+    return true;
+}
+
+static_assert(are_stacks_aligned(), "Stack sizes must keep every stack in task_stacks aligned");
+
+/* ESP-IDF counts stacks in bytes. One symbol in the linker map, the sum of the table */
+alignas(TASK_STACK_ALIGN) static StackType_t task_stacks[get_stack_offset(NUM_TASKS)];
+static TaskSlot_t task_slots[NUM_TASKS];
+
+/* Runs in prvDeleteTCB(), once the kernel is done with the TCB and the stack */
+static void release_task_slot(int index, void* slot)
+{
+    static_cast<TaskSlot_t*>(slot)->is_busy.store(false, std::memory_order_release);
+}
+
+/*
+ * Registers the release before the task body can delete itself. Only the task does this, the creator could touch a TCB
+ * the task on the other core has already deleted. A task deleted from outside before it first runs keeps its slot busy,
+ * nothing here deletes a task it did not wait for.
+ */
+static void run_task(void* arg)
+{
+    TaskSlot_t* slot = static_cast<TaskSlot_t*>(arg);
+
+    vTaskSetThreadLocalStoragePointerAndDelCallback(NULL, TASK_SLOT_TLS_INDEX, slot, release_task_slot);
+    slot->task(slot->arg);
+}
+
+const TaskConfig_t& get_task_config(TaskId id)
+{
+    return TASK_CONFIGS[static_cast<size_t>(id)];
+}
+
+const TaskConfig_t* find_task_config(const char* task_name)
+{
+    for (size_t i = 0; i < NUM_TASKS; ++i)
+    {
+        if (strncmp(task_name, TASK_CONFIGS[i].name, strlen(TASK_CONFIGS[i].name)) == 0)
+            return &TASK_CONFIGS[i];
+    }
+
+    return nullptr;
+}
+
+bool create_task(TaskId id, TaskFunction_t task, void* arg, TaskHandle_t* handle, const char* name)
+{
+    size_t idx = static_cast<size_t>(id);
+    const TaskConfig_t& cfg = TASK_CONFIGS[idx];
+    TaskSlot_t& slot = task_slots[idx];
+
+    if (slot.is_busy.exchange(true, std::memory_order_acquire))
+    {
+        ESP_LOGE(TAG, "Task slot still in use: %s", cfg.name);
+        return false;
+    }
+
+    slot.task = task;
+    slot.arg = arg;
+
+    TaskHandle_t task_handle = xTaskCreateStaticPinnedToCore(run_task, name ? name : cfg.name, cfg.stack_size, &slot, cfg.priority,
+                                                             &task_stacks[get_stack_offset(idx)], &slot.tcb, cfg.core);
+
+    if (task_handle == nullptr)
+    {
+        slot.is_busy.store(false, std::memory_order_release);
+        ESP_LOGE(TAG, "Failed to create task: %s", cfg.name);
+        return false;
+    }
+
+    if (handle)
+        *handle = task_handle;
+
+    return true;
+}
+
+bool is_task_slot_free(TaskId id)
+{
+    return !task_slots[static_cast<size_t>(id)].is_busy.load(std::memory_order_acquire);
+}
+
+size_t get_task_stack_total(Subsystem subsystem)
+{
+    size_t total = 0;
+
+    for (const auto& cfg: TASK_CONFIGS)
+    {
+        if (cfg.subsystem == subsystem)
+            total += cfg.stack_size;
+    }
+
+    return total;
+}
@@ -0,0 +1,58 @@
+#ifndef _H_TASK_CONFIG_H_
+#define _H_TASK_CONFIG_H_
+
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "rtos_arena.h"
+
+/* Wi-Fi, lwIP and esp_timer already live on core 0, so the network stack stays there */
+#define TASK_CORE_NET   ( 0 )
+#define TASK_CORE_UI    ( 1 )
+
+enum class TaskId : uint8_t
+{
+    /* UI core */
+    Reactor,
+    Actuator,
+    ScanFingerprint,
+    FingerprintHelper,      /* execute_task() workers of FingerprintReaderHelper */
+
+    /* Network core */
+    Init,                   /* One-shot: starts time sync, then drives provisioning */
+    AzureLoop,
+    Radio,
+    WifiArp,
+    DevProvisioning,
+    IotHubProvisioning,
+    DeferredLog,
+    Count,
+};
+
+typedef struct TaskConfig_s
+{
+    const char* name;
+    uint32_t stack_size;
+    UBaseType_t priority;
+    BaseType_t core;
+    Subsystem subsystem;    /* Whose budget the stack counts against */
+} TaskConfig_t;
+
+const TaskConfig_t& get_task_config(TaskId id);
+
+/* Matched by name prefix, so the fprh_* workers resolve to FingerprintHelper. nullptr for IDF tasks */
+const TaskConfig_t* find_task_config(const char* task_name);
+
+/*
+ * Every task is created through here, pinned and prioritized from the table, on a static stack of its own.
+ * A TaskId runs one instance at a time: fails while the previous one runs or awaits cleanup by the idle task.
+ * name overrides the table name, for the fprh_* workers.
+ */
+bool create_task(TaskId id, TaskFunction_t task, void* arg = NULL, TaskHandle_t* handle = NULL, const char* name = nullptr);
+
+bool is_task_slot_free(TaskId id);
+size_t get_task_stack_total(Subsystem subsystem);
+
+#endif
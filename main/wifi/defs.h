@@ -10,4 +10,10 @@
 constexpr size_t WIFI_SSID_MAX_LEN = 32;
 constexpr size_t WIFI_PASS_MAX_LEN = 64;
 
+/* Fast connect */
+#define WIFI_FAST_CONNECT_MAX_FAILS         ( 2 )
+#define WIFI_LEASE_REUSE_PCT                ( 50 )      /* Of the granted lease, a DHCP client renews at T1 = 50 % */
+#define WIFI_ARP_PROBE_CNT                  ( 5 )
+#define WIFI_ARP_PROBE_INTERVAL_MS          ( 20 )
+
 #endif
\ No newline at end of file
@@ -1,17 +1,27 @@
 #include <algorithm>
 #include <cstring>
 
+#include <esp_attr.h>
 #include <esp_log.h>
 #include <esp_event.h>
+#include <esp_netif.h>
 #include <esp_system.h>
 #include <esp_wifi.h>
 
+#include <lwip/dhcp.h>
+#include <lwip/etharp.h>
+#include <lwip/netif.h>
+
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 
 #include "defs.h"
 #include "station.h"
+#include "rtos_arena.h"
+#include "task_config.h"
+#include "helper/hash.h"
+#include "helper/system.h"
 
 using namespace std;
 
@@ -42,10 +52,221 @@ static const char* TAG = "WiFiStation";
 #define EXAMPLE_H2E_IDENTIFIER CONFIG_ESP_WIFI_PW_ID
 #endif
 
+#define FAST_CONNECT_MAGIC ( 0x46434E54U )
+
+/* Last association and DHCP lease, kept in RTC memory so a wake can skip the scan and DHCP */
+typedef struct FastConnectCache_s
+{
+    uint32_t magic;
+    uint32_t ssid_hash;
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool has_lease;
+    esp_netif_ip_info_t ip_info;
+    esp_ip4_addr_t dns;
+    int64_t leased_at;          /* get_mono_time_us() */
+    uint32_t lease_s;           /* Granted by the DHCP server */
+} FastConnectCache_t;
+
+typedef struct ArpProbe_s
+{
+    struct netif* netif;
+    ip4_addr_t gw;
+    ip4_addr_t ip;
+    bool found;
+    bool is_conflict;
+} ArpProbe_t;
+
+typedef struct LeaseQuery_s
+{
+    struct netif* netif;
+    uint32_t lease_s;
+} LeaseQuery_t;
+
 static esp_netif_t* esp_netif = nullptr;
 static EventGroupHandle_t wifi_event_group;
 static esp_event_handler_instance_t wifi_event_any_id, wifi_event_got_ip;       
 
+static RTC_DATA_ATTR FastConnectCache_t fast_cache;
+static wifi_config_t wifi_cfg;
+static bool is_wifi_initialized = false;
+static bool is_stopping = false;
+static bool is_fast_connecting = false;
+static bool is_lease_reused = false;
+static uint8_t fast_connect_fails = 0;
+
+static uint32_t hash_ssid(const uint8_t* ssid)
+{
+    return fnv1a(ssid, strnlen(reinterpret_cast<const char*>(ssid), WIFI_SSID_MAX_LEN));
+}
+
+static bool is_fast_cache_valid()
+{
+    return fast_cache.magic == FAST_CONNECT_MAGIC && fast_cache.ssid_hash == hash_ssid(wifi_cfg.sta.ssid) && fast_cache.channel != 0;
+}
+
+/* The DHCP client state belongs to the lwIP thread */
+static uint32_t get_lease_time_s()
+{
+    LeaseQuery_t query = { static_cast<struct netif*>(esp_netif_get_netif_impl(esp_netif)), 0 };
+
+    if (query.netif == nullptr)
+        return 0;
+
+    esp_netif_tcpip_exec([](void* ctx) -> esp_err_t
+    {
+        LeaseQuery_t* query = static_cast<LeaseQuery_t*>(ctx);
+        struct dhcp* dhcp = netif_dhcp_data(query->netif);
+
+        query->lease_s = dhcp != nullptr ? dhcp->offered_t0_lease : 0;
+        return ESP_OK;
+    }, &query);
+
+    return query.lease_s;
+}
+
+static void save_fast_cache(const esp_netif_ip_info_t& ip_info)
+{
+    wifi_ap_record_t ap_info;
+    esp_netif_dns_info_t dns_info;
+
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK)
+        return;
+
+    fast_cache.ssid_hash = hash_ssid(wifi_cfg.sta.ssid);
+    memcpy(fast_cache.bssid, ap_info.bssid, sizeof(fast_cache.bssid));
+    fast_cache.channel = ap_info.primary;
+
+    fast_cache.has_lease = esp_netif_get_dns_info(esp_netif, ESP_NETIF_DNS_MAIN, &dns_info) == ESP_OK;
+    fast_cache.ip_info = ip_info;
+    fast_cache.dns = dns_info.ip.u_addr.ip4;
+    fast_cache.leased_at = get_mono_time_us();
+    fast_cache.lease_s = get_lease_time_s();
+
+    fast_cache.magic = FAST_CONNECT_MAGIC;
+}
+
+/* Full scan and DHCP from here on, the cached AP or lease did not work */
+static void fall_back_to_full_connect()
+{
+    ESP_LOGW(TAG, "Fast connect failed, falling back to full scan");
+
+    fast_cache.magic = 0;
+    is_fast_connecting = false;
+    fast_connect_fails = 0;
+
+    wifi_cfg.sta.bssid_set = false;
+    wifi_cfg.sta.channel = 0;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg));
+
+    if (is_lease_reused)
+    {
+        is_lease_reused = false;
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_netif_dhcpc_start(esp_netif));
+    }
+}
+
+/*
+ * A reused lease is only trusted once the gateway answers ARP from it and nobody answers for our own address.
+ * An entry for our address can only come from another host that took it after the lease ran out on the server.
+ */
+static bool probe_lease()
+{
+    esp_netif_ip_info_t ip_info;
+    ArpProbe_t probe = { static_cast<struct netif*>(esp_netif_get_netif_impl(esp_netif)) };
+
+    if (probe.netif == nullptr || esp_netif_get_ip_info(esp_netif, &ip_info) != ESP_OK)
+        return false;
+
+    probe.gw.addr = ip_info.gw.addr;
+    probe.ip.addr = ip_info.ip.addr;
+
+    for (int i = 0; i < WIFI_ARP_PROBE_CNT && !probe.found && !probe.is_conflict; ++i)
+    {
+        esp_netif_tcpip_exec([](void* ctx) -> esp_err_t
+        {
+            ArpProbe_t* probe = static_cast<ArpProbe_t*>(ctx);
+            etharp_request(probe->netif, &probe->gw);
+            etharp_request(probe->netif, &probe->ip);
+            return ESP_OK;
+        }, &probe);
+
+        vTaskDelay(pdMS_TO_TICKS(WIFI_ARP_PROBE_INTERVAL_MS));
+
+        esp_netif_tcpip_exec([](void* ctx) -> esp_err_t
+        {
+            ArpProbe_t* probe = static_cast<ArpProbe_t*>(ctx);
+            struct eth_addr* eth_ret = nullptr;
+            const ip4_addr_t* ip_ret = nullptr;
+
+            probe->found = etharp_find_addr(probe->netif, &probe->gw, &eth_ret, &ip_ret) >= 0;
+            probe->is_conflict = etharp_find_addr(probe->netif, &probe->ip, &eth_ret, &ip_ret) >= 0;
+            return ESP_OK;
+        }, &probe);
+    }
+
+    if (probe.is_conflict)
+        ESP_LOGW(TAG, "Reused address " IPSTR " is taken", IP2STR(&ip_info.ip));
+
+    return probe.found && !probe.is_conflict;
+}
+
+static void validate_reused_lease()
+{
+    auto task = [](void* pvParameters)
+    {
+        if (probe_lease())
+        {
+            ESP_LOGI(TAG, "Reused lease validated");
+            xEventGroupSetBits(wifi_event_group, WIFI_EVENT_BITS_CONNECTED);
+        }
+        else
+            fall_back_to_full_connect();
+
+        vTaskDelete(NULL);
+    };
+
+    create_task(TaskId::WifiArp, task);
+}
+
+/* Pins the cached AP and, when still fresh, the previous lease instead of scanning and running DHCP */
+static void apply_fast_cache()
+{
+    if (!is_fast_cache_valid())
+        return;
+
+    wifi_cfg.sta.bssid_set = true;
+    memcpy(wifi_cfg.sta.bssid, fast_cache.bssid, sizeof(wifi_cfg.sta.bssid));
+    wifi_cfg.sta.channel = fast_cache.channel;
+    is_fast_connecting = true;
+
+    int64_t lease_age_us = get_mono_time_us() - fast_cache.leased_at;
+    int64_t reuse_max_age_us = static_cast<int64_t>(fast_cache.lease_s) * WIFI_LEASE_REUSE_PCT / 100 * 1000000LL;
+
+    if (!fast_cache.has_lease || lease_age_us >= reuse_max_age_us)
+        return;
+
+    esp_netif_dns_info_t dns_info = { };
+    dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+    dns_info.ip.u_addr.ip4 = fast_cache.dns;
+
+    esp_err_t res = esp_netif_dhcpc_stop(esp_netif);
+
+    if (res != ESP_OK && res != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED)
+        return;
+
+    if (esp_netif_set_ip_info(esp_netif, &fast_cache.ip_info) != ESP_OK)
+    {
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_netif_dhcpc_start(esp_netif));
+        return;
+    }
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_netif_set_dns_info(esp_netif, ESP_NETIF_DNS_MAIN, &dns_info));
+    is_lease_reused = true;
+
+    ESP_LOGI(TAG, "Fast connect: ch %u, reusing " IPSTR, fast_cache.channel, IP2STR(&fast_cache.ip_info.ip));
+}
+
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT)
@@ -54,7 +275,15 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
             ESP_ERROR_CHECK_WITHOUT_ABORT(esp_wifi_connect());
         else if(event_id == WIFI_EVENT_STA_DISCONNECTED)
         {
+            xEventGroupClearBits(wifi_event_group, WIFI_EVENT_BITS_CONNECTED);
             xEventGroupSetBits(wifi_event_group, WIFI_EVENT_BITS_DISCONNECTED);
+
+            if (is_stopping)
+                return;
+
+            if (is_fast_connecting && ++fast_connect_fails >= WIFI_FAST_CONNECT_MAX_FAILS)
+                fall_back_to_full_connect();
+
             ESP_ERROR_CHECK_WITHOUT_ABORT(esp_wifi_connect());
         }
     }
@@ -64,6 +293,16 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
         {
             ip_event_got_ip_t* event = static_cast<ip_event_got_ip_t*>(event_data);
             ESP_LOGI(TAG, "IP: " IPSTR, IP2STR(&event->ip_info.ip));
+            fast_connect_fails = 0;
+
+            /* A static lease raises GOT_IP on association alone, it is only connected after the ARP check */
+            if (is_lease_reused)
+            {
+                validate_reused_lease();
+                return;
+            }
+
+            save_fast_cache(event->ip_info);
             xEventGroupSetBits(wifi_event_group, WIFI_EVENT_BITS_CONNECTED);
         }
     }
@@ -73,7 +312,7 @@ bool init_wifi_sta()
 {
     esp_err_t res = ESP_OK;
 
-    wifi_event_group = xEventGroupCreate();
+    wifi_event_group = create_static_event_group(Subsystem::Network);
     ESP_ERROR_CHECK_WITH_BOOL_RETN(esp_netif_init());
     ESP_ERROR_CHECK_WITH_BOOL_RETN(esp_event_loop_create_default());
     esp_netif = esp_netif_create_default_wifi_sta();
@@ -116,10 +355,17 @@ void connect(const char* ssid, const char* password, wifi_auth_mode_t auth_mode)
 {
     esp_err_t res = ESP_OK;
 
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK_WITH_RETN(esp_wifi_init(&cfg));
+    /* The driver stays initialized between radio windows, only start/stop cycle */
+    if (!is_wifi_initialized)
+    {
+        wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+        ESP_ERROR_CHECK_WITH_RETN(esp_wifi_init(&cfg));
+        is_wifi_initialized = true;
+    }
+
+    is_stopping = false;
     
-    wifi_config_t wifi_cfg = {
+    wifi_cfg = {
         .sta = {
             .threshold = {
                 .authmode = auth_mode,
@@ -134,10 +380,30 @@ void connect(const char* ssid, const char* password, wifi_auth_mode_t auth_mode)
 
     copy(ssid, ssid + strnlen((const char*)ssid, WIFI_SSID_MAX_LEN), wifi_cfg.sta.ssid);
     copy(password, password + strnlen((const char*)password, WIFI_PASS_MAX_LEN), wifi_cfg.sta.password);
+    apply_fast_cache();
 
     ESP_ERROR_CHECK_WITH_RETN(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK_WITH_RETN(esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg));
     ESP_ERROR_CHECK_WITH_RETN(esp_wifi_start());
+
+    /* Modem sleep between DTIM beacons, the driver holds its own PM lock while a frame is in flight */
+    ESP_ERROR_CHECK_WITH_RETN(esp_wifi_set_ps(WIFI_PS_MIN_MODEM));
+}
+
+void stop_wifi_sta()
+{
+    is_stopping = true;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(esp_wifi_stop());
+    xEventGroupClearBits(wifi_event_group, WIFI_EVENT_BITS_CONNECTED);
+
+    /* The next window may not reuse the lease, leave DHCP armed for it */
+    if (is_lease_reused)
+    {
+        is_lease_reused = false;
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_netif_dhcpc_start(esp_netif));
+    }
+
+    fast_connect_fails = 0;
 }
 
 bool disconnect()
@@ -6,6 +6,7 @@ void deinit_wifi_sta();
 
 bool is_connected();
 void connect(const char* ssid, const char* password, wifi_auth_mode_t auth_mode);
+void stop_wifi_sta();
 bool disconnect();
 bool reconnect();
 
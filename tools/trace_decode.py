@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Decode the binary trace ring dumped by main/helper/trace.cpp into per-stage latency histograms.
+
+    idf.py monitor | tee door.log
+    python3 tools/trace_decode.py door.log [--raw]
+
+Lines starting with "TRC " hold 8-byte little-endian records: u32 time_us, u8 point, u8 core, u16 arg.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Mirrors enum class TracePoint in main/helper/trace.h
+POINTS = [
+    "FingerTouched",
+    "FpCaptured",
+    "FpTemplated",
+    "FpSearched",
+    "KeyPressed",
+    "FsmTransition",
+    "MotorStart",
+    "MotorDone",
+    "AudioStart",
+    "AudioDone",
+    "SleepEntered",
+]
+
+# (name, start point, end point); an end is paired with the latest start that precedes it
+STAGES = [
+    ("touch -> capture", "FingerTouched", "FpCaptured"),
+    ("capture -> template", "FpCaptured", "FpTemplated"),
+    ("template -> search", "FpTemplated", "FpSearched"),
+    ("search -> motor", "FpSearched", "MotorStart"),
+    ("motor run", "MotorStart", "MotorDone"),
+    ("touch -> door moved", "FingerTouched", "MotorDone"),
+    ("key -> beep", "KeyPressed", "AudioStart"),
+]
+
+RECORD = struct.Struct("<IBBH")
+LINE = re.compile(r"TRC ([0-9a-fA-F]+)")
+WRAP_US = 1 << 32
+REBOOT_STEP_US = 1000000
+
+
+def read_records(lines):
+    """Yields (time_us, point, core, arg), unwrapping the 32-bit clock and splitting boots."""
+    epoch = 0
+    last = None
+
+    for line in lines:
+        match = LINE.search(line)
+
+        if match is None:
+            continue
+
+        data = bytes.fromhex(match.group(1))
+
+        for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+            time_us, point, core, arg = RECORD.unpack_from(data, offset)
+
+            # A wrap keeps going forward and a reboot restarts near zero. Small steps back are
+            # records stamped with their event's post time, those stay in the same epoch
+            if last is not None and last - time_us > WRAP_US // 2:
+                epoch += WRAP_US
+            elif last is not None and last - time_us > REBOOT_STEP_US:
+                epoch += last + 1
+
+            if last is None or time_us > last or last - time_us > REBOOT_STEP_US:
+                last = time_us
+            yield epoch + time_us, point, core, arg
+
+
+def point_name(point):
+    return POINTS[point] if point < len(POINTS) else "Unknown(%d)" % point
+
+
+def collect(records):
+    samples = {name: [] for name, _, _ in STAGES}
+    started = {}
+
+    for time_us, point, _, _ in records:
+        name = point_name(point)
+
+        # Each start is consumed by its first end, so an auto-close does not pair with the touch that opened
+        for stage, start, end in STAGES:
+            if name == end and stage in started:
+                samples[stage].append(time_us - started.pop(stage))
+
+            if name == start:
+                started[stage] = time_us
+
+        # A new session invalidates everything started before it
+        if name == "SleepEntered":
+            started.clear()
+
+    return samples
+
+
+def percentile(values, pct):
+    return values[min(len(values) - 1, int(len(values) * pct / 100))]
+
+
+def print_histogram(stage, values):
+    if not values:
+        print("%-22s no samples" % stage)
+        return
+
+    values = sorted(values)
+    print("%-22s n=%d min=%.1f p50=%.1f p90=%.1f p99=%.1f max=%.1f ms" % (
+        stage, len(values), values[0] / 1000, percentile(values, 50) / 1000,
+        percentile(values, 90) / 1000, percentile(values, 99) / 1000, values[-1] / 1000))
+
+    # Power-of-two millisecond buckets
+    buckets = {}
+
+    for value in values:
+        bucket = 1
+
+        while bucket * 1000 <= value:
+            bucket *= 2
+
+        buckets[bucket] = buckets.get(bucket, 0) + 1
+
+    peak = max(buckets.values())
+
+    for bucket in sorted(buckets):
+        count = buckets[bucket]
+        print("    < %6d ms %6d %s" % (bucket, count, "#" * max(1, count * 40 // peak)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="console log, stdin when omitted")
+    parser.add_argument("--raw", action="store_true", help="print every decoded record")
+    args = parser.parse_args()
+
+    with (open(args.log, errors="replace") if args.log else sys.stdin) as stream:
+        records = list(read_records(stream))
+
+    if args.raw:
+        for time_us, point, core, arg in records:
+            print("%12d us  cpu%d  %-14s %d" % (time_us, core, point_name(point), arg))
+
+    samples = collect(records)
+
+    for stage, _, _ in STAGES:
+        print_histogram(stage, samples[stage])
+
+
+if __name__ == "__main__":
+    main()